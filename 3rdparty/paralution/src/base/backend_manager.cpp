@@ -309,6 +309,27 @@ void info_paralution(const struct Paralution_Backend_Descriptor backend_descript
 }
 
 
+int _paralution_begin_nested(void) {
+
+#ifdef _OPENMP
+  const int nested = omp_get_nested();
+  omp_set_nested(1);
+
+  return nested;
+#else
+  return 0;
+#endif
+
+}
+
+void _paralution_end_nested(const int nested) {
+
+#ifdef _OPENMP
+  omp_set_nested(nested);
+#endif
+
+}
+
 bool _paralution_available_accelerator(void) {
 
   return _Backend_Descriptor.accelerator;
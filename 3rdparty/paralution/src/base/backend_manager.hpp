@@ -120,6 +120,13 @@ void info_paralution(const struct Paralution_Backend_Descriptor backend_descript
 /// Return true if any accelerator is available
 bool _paralution_available_accelerator(void);
 
+/// Enable nested OpenMP parallelism for the thread groups of the subdomains
+/// of the global objects, return the previous setting
+int _paralution_begin_nested(void);
+
+/// Restore the setting returned by _paralution_begin_nested
+void _paralution_end_nested(const int nested);
+
 /// Return backend descriptor
 void _get_backend_descriptor(struct Paralution_Backend_Descriptor *backend_descriptor);
 
@@ -209,6 +209,11 @@ bool BaseMatrix<ValueType>::ExtractInverseDiagonal(BaseVector<ValueType> *vec_in
   return false;
 }
 
+template <typename ValueType>
+bool BaseMatrix<ValueType>::ExtractInverseBlockDiagonal(BaseMatrix<ValueType> *mat_inv_diag) const {
+  return false;
+}
+
 template <typename ValueType>
 bool BaseMatrix<ValueType>::ExtractSubMatrix(const int row_offset,
                                              const int col_offset,
@@ -632,6 +637,12 @@ bool BaseMatrix<ValueType>::MatMatMult(const BaseMatrix<ValueType> &A, const Bas
   return false;
 }
 
+template <typename ValueType>
+bool BaseMatrix<ValueType>::TripleMatrixProduct(const BaseMatrix<ValueType> &R, const BaseMatrix<ValueType> &A,
+                                                const BaseMatrix<ValueType> &P) {
+  return false;
+}
+
 
 template <typename ValueType>
 bool BaseMatrix<ValueType>::ConvertFrom(const BaseMatrix<ValueType> &mat) {
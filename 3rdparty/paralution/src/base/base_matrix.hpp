@@ -193,6 +193,8 @@ public:
   virtual bool ExtractDiagonal(BaseVector<ValueType> *vec_diag) const;
   /// Extract the inverse (reciprocal) diagonal values of the matrix into a LocalVector
   virtual bool ExtractInverseDiagonal(BaseVector<ValueType> *vec_inv_diag) const;
+  /// Extract the inverses of the diagonal blocks of the matrix into a block diagonal matrix
+  virtual bool ExtractInverseBlockDiagonal(BaseMatrix<ValueType> *mat_inv_diag) const;
   /// Extract the upper triangular matrix
   virtual bool ExtractU(BaseMatrix<ValueType> *U) const;
   /// Extract the upper triangular matrix including diagonal
@@ -265,6 +267,9 @@ public:
   virtual void SymbolicMatMatMult(const BaseMatrix<ValueType> &src);
   /// Multiply two matrices, this = A * B
   virtual bool MatMatMult(const BaseMatrix<ValueType> &A, const BaseMatrix<ValueType> &B);
+  /// Multiply three matrices, this = R * A * P
+  virtual bool TripleMatrixProduct(const BaseMatrix<ValueType> &R, const BaseMatrix<ValueType> &A,
+                                   const BaseMatrix<ValueType> &P);
   /// Perform symbolic matrix-matrix multiplication (i.e. determine the structure), 
   /// this = A*B
   virtual void SymbolicMatMatMult(const BaseMatrix<ValueType> &A, const BaseMatrix<ValueType> &B);
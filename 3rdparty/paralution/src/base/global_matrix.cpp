@@ -23,30 +23,412 @@
 #include "global_vector.hpp"
 #include "local_matrix.hpp"
 #include "local_vector.hpp"
+#include "matrix_formats.hpp"
+#include "backend_manager.hpp"
 
+#include "../utils/allocate_free.hpp"
 #include "../utils/log.hpp"
 
 #include <assert.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace paralution {
 
 template <typename ValueType>
 GlobalMatrix<ValueType>::GlobalMatrix() {
+
   this->object_name_ = "";
 
-  FATAL_ERROR(__FILE__, __LINE__);    
+  this->ndomains_ = 0;
+  this->domain_offset_ = NULL;
+
+  this->global_nrow_ = 0;
+  this->global_ncol_ = 0;
+  this->global_nnz_  = 0;
+
+  this->matrix_interior_ = NULL;
+  this->matrix_ghost_ = NULL;
+  this->ghost_values_ = NULL;
+
+  this->nghost_ = NULL;
+  this->ghost_domain_ = NULL;
+  this->ghost_index_ = NULL;
 
 }
 
 template <typename ValueType>
 GlobalMatrix<ValueType>::~GlobalMatrix() {
+
+  this->Clear();
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::Clear(void) {
+
+  if (this->ndomains_ > 0) {
+
+    for (int d=0; d<this->ndomains_; ++d)
+      if (this->nghost_[d] > 0) {
+        free_host(&this->ghost_domain_[d]);
+        free_host(&this->ghost_index_[d]);
+      }
+
+    delete[] this->ghost_domain_;
+    delete[] this->ghost_index_;
+    free_host(&this->nghost_);
+
+    delete[] this->matrix_interior_;
+    delete[] this->matrix_ghost_;
+    delete[] this->ghost_values_;
+
+    this->matrix_interior_ = NULL;
+    this->matrix_ghost_ = NULL;
+    this->ghost_values_ = NULL;
+    this->ghost_domain_ = NULL;
+    this->ghost_index_ = NULL;
+
+    free_host(&this->domain_offset_);
+    this->ndomains_ = 0;
+
+    this->global_nrow_ = 0;
+    this->global_ncol_ = 0;
+    this->global_nnz_  = 0;
+
+  }
+
+}
+
+template <typename ValueType>
+bool GlobalMatrix<ValueType>::is_host(void) const {
+
+  if (this->ndomains_ == 0)
+    return true;
+
+  return this->matrix_interior_[0].is_host();
+
+}
+
+template <typename ValueType>
+bool GlobalMatrix<ValueType>::is_accel(void) const {
+
+  if (this->ndomains_ == 0)
+    return false;
+
+  return this->matrix_interior_[0].is_accel();
+
+}
+
+template <typename ValueType>
+Paralution_Backend_Descriptor GlobalMatrix<ValueType>::DomainBackend_(void) const {
+
+  Paralution_Backend_Descriptor backend = this->local_backend_;
+  backend.OpenMP_threads = std::max(1, this->local_backend_.OpenMP_threads / this->ndomains_);
+
+  return backend;
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::info(void) const {
+
+  LOG_INFO("GlobalMatrix"
+           << " name=" << this->object_name_ << ";"
+           << " rows=" << this->get_nrow() << ";"
+           << " cols=" << this->get_ncol() << ";"
+           << " nnz=" << this->get_nnz() << ";"
+           << " domains=" << this->ndomains_ << ";"
+           << " prec=" << 8*sizeof(ValueType) << "bit;"
+           << " host backend={" << _paralution_host_name[0] << "};"
+           << " accelerator backend={" << _paralution_backend_name[this->local_backend_.backend] << "};"
+           << " current=" << (this->is_host() ? _paralution_host_name[0] : _paralution_backend_name[this->local_backend_.backend]));
+
+  for (int d=0; d<this->ndomains_; ++d)
+    LOG_INFO("  domain " << d
+             << " rows=" << this->matrix_interior_[d].get_nrow()
+             << " interior nnz=" << this->matrix_interior_[d].get_nnz()
+             << " ghosts=" << this->nghost_[d]
+             << " ghost nnz=" << this->matrix_ghost_[d].get_nnz());
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::MoveToAccelerator(void) {
+
+  for (int d=0; d<this->ndomains_; ++d) {
+    this->matrix_interior_[d].MoveToAccelerator();
+    this->matrix_ghost_[d].MoveToAccelerator();
+    this->ghost_values_[d].MoveToAccelerator();
+  }
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::MoveToHost(void) {
+
+  for (int d=0; d<this->ndomains_; ++d) {
+    this->matrix_interior_[d].MoveToHost();
+    this->matrix_ghost_[d].MoveToHost();
+    this->ghost_values_[d].MoveToHost();
+  }
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::Partition(const LocalMatrix<ValueType> &mat, const int ndomains) {
+
+  assert(mat.get_nrow() == mat.get_ncol());
+  assert(mat.get_nnz() > 0);
+  assert((ndomains > 0) && (ndomains <= mat.get_nrow()));
+
+  this->Clear();
+
+  this->object_name_ = mat.object_name_;
+  this->local_backend_ = mat.local_backend_;
+
+  const int nrow = mat.get_nrow();
+  const int nnz  = mat.get_nnz();
+
+  // host CSR copy of the matrix
+  int *row_offset = NULL;
+  int *col = NULL;
+  ValueType *val = NULL;
+
+  allocate_host(nrow+1, &row_offset);
+  allocate_host(nnz, &col);
+  allocate_host(nnz, &val);
+
+  if (mat.is_host() && (mat.get_format() == CSR)) {
+
+    mat.CopyToCSR(row_offset, col, val);
+
+  } else {
+
+    LocalMatrix<ValueType> tmp;
+    tmp.CloneFrom(mat);
+    tmp.MoveToHost();
+    tmp.ConvertToCSR();
+    tmp.CopyToCSR(row_offset, col, val);
+
+  }
+
+  // contiguous subdomains with a balanced number of nonzero entries
+  this->ndomains_ = ndomains;
+  allocate_host(ndomains+1, &this->domain_offset_);
+
+  this->domain_offset_[0] = 0;
+  this->domain_offset_[ndomains] = nrow;
+
+  for (int d=1; d<ndomains; ++d) {
+
+    int offset = int(std::lower_bound(row_offset, row_offset+nrow+1, int((long(nnz)*d) / ndomains))
+                     - row_offset);
+
+    // no empty subdomain
+    offset = std::max(offset, this->domain_offset_[d-1] + 1);
+    offset = std::min(offset, nrow - (ndomains - d));
+
+    this->domain_offset_[d] = offset;
+
+  }
+
+  this->global_nrow_ = nrow;
+  this->global_ncol_ = nrow;
+  this->global_nnz_  = nnz;
+
+  this->matrix_interior_ = new LocalMatrix<ValueType>[ndomains];
+  this->matrix_ghost_ = new LocalMatrix<ValueType>[ndomains];
+  this->ghost_values_ = new LocalVector<ValueType>[ndomains];
+
+  allocate_host(ndomains, &this->nghost_);
+  this->ghost_domain_ = new int*[ndomains];
+  this->ghost_index_ = new int*[ndomains];
+
+  const Paralution_Backend_Descriptor backend = this->DomainBackend_();
+
+  // thread groups of the subdomains
+  const int nested = _paralution_begin_nested();
+
+  // the subdomains are built (first touched) by the thread working on them
+#pragma omp parallel for num_threads(ndomains) schedule(static, 1)
+  for (int d=0; d<ndomains; ++d) {
+
+    const int first = this->domain_offset_[d];
+    const int last  = this->domain_offset_[d+1];
+    const int n = last - first;
+
+    // ghost unknowns (sorted global indices)
+    std::vector<int> ghost;
+
+    for (int i=row_offset[first]; i<row_offset[last]; ++i)
+      if ((col[i] < first) || (col[i] >= last))
+        ghost.push_back(col[i]);
+
+    std::sort(ghost.begin(), ghost.end());
+    ghost.erase(std::unique(ghost.begin(), ghost.end()), ghost.end());
+
+    const int nghost = int(ghost.size());
+    int nnz_interior = 0;
+    for (int i=row_offset[first]; i<row_offset[last]; ++i)
+      if ((col[i] >= first) && (col[i] < last))
+        ++nnz_interior;
+
+    const int nnz_ghost = row_offset[last] - row_offset[first] - nnz_interior;
+
+    this->nghost_[d] = nghost;
+    this->ghost_domain_[d] = NULL;
+    this->ghost_index_[d] = NULL;
+
+    if (nghost > 0) {
+
+      allocate_host(nghost, &this->ghost_domain_[d]);
+      allocate_host(nghost, &this->ghost_index_[d]);
+
+      for (int k=0; k<nghost; ++k) {
+
+        const int owner = int(std::upper_bound(this->domain_offset_, this->domain_offset_+ndomains+1, ghost[k])
+                              - this->domain_offset_) - 1;
+
+        this->ghost_domain_[d][k] = owner;
+        this->ghost_index_[d][k] = ghost[k] - this->domain_offset_[owner];
+
+      }
+
+    }
+
+    // split the rows
+    std::vector<int> int_row_offset(n+1, 0), int_col(nnz_interior);
+    std::vector<ValueType> int_val(nnz_interior);
+    std::vector<int> gst_row_offset(n+1, 0), gst_col(nnz_ghost);
+    std::vector<ValueType> gst_val(nnz_ghost);
+
+    int ni = 0;
+    int ng = 0;
+
+    for (int ai=0; ai<n; ++ai) {
+
+      for (int aj=row_offset[first+ai]; aj<row_offset[first+ai+1]; ++aj)
+        if ((col[aj] >= first) && (col[aj] < last)) {
+
+          int_col[ni] = col[aj] - first;
+          int_val[ni] = val[aj];
+          ++ni;
+
+        } else {
+
+          gst_col[ng] = int(std::lower_bound(ghost.begin(), ghost.end(), col[aj]) - ghost.begin());
+          gst_val[ng] = val[aj];
+          ++ng;
+
+        }
+
+      int_row_offset[ai+1] = ni;
+      gst_row_offset[ai+1] = ng;
+
+    }
+
+    this->matrix_interior_[d].local_backend_ = backend;
+    this->matrix_ghost_[d].local_backend_ = backend;
+
+    if (nnz_interior > 0) {
+      this->matrix_interior_[d].AllocateCSR(this->object_name_, nnz_interior, n, n);
+      this->matrix_interior_[d].CopyFromCSR(&int_row_offset[0], &int_col[0], &int_val[0]);
+    }
+
+    if (nnz_ghost > 0) {
+      this->matrix_ghost_[d].AllocateCSR(this->object_name_, nnz_ghost, n, nghost);
+      this->matrix_ghost_[d].CopyFromCSR(&gst_row_offset[0], &gst_col[0], &gst_val[0]);
+    }
+
+  }
+
+  _paralution_end_nested(nested);
+
+  free_host(&row_offset);
+  free_host(&col);
+  free_host(&val);
+
+}
+
+template <typename ValueType>
+const LocalMatrix<ValueType>& GlobalMatrix<ValueType>::GetInterior(const int domain) const {
+
+  assert((domain >= 0) && (domain < this->ndomains_));
+
+  return this->matrix_interior_[domain];
+
+}
+
+template <typename ValueType>
+const LocalMatrix<ValueType>& GlobalMatrix<ValueType>::GetGhost(const int domain) const {
+
+  assert((domain >= 0) && (domain < this->ndomains_));
+
+  return this->matrix_ghost_[domain];
+
+}
+
+template <typename ValueType>
+int GlobalMatrix<ValueType>::get_nghost(const int domain) const {
+
+  assert((domain >= 0) && (domain < this->ndomains_));
+
+  return this->nghost_[domain];
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::GetGhostValues(const int domain, const GlobalVector<ValueType> &in,
+                                             LocalVector<ValueType> *ghost) const {
+
+  assert((domain >= 0) && (domain < this->ndomains_));
+  assert(in.ndomains_ == this->ndomains_);
+  assert(ghost != NULL);
+
+  const int nghost = this->nghost_[domain];
+
+  if (ghost->get_size() != nghost) {
+
+    ghost->Clear();
+    ghost->CloneBackend(in.vector_interior_[domain]);
+    ghost->Allocate("ghost", nghost);
+
+  }
+
+  for (int k=0; k<nghost; ++k)
+    (*ghost)[k] = in.vector_interior_[this->ghost_domain_[domain][k]][this->ghost_index_[domain][k]];
+
 }
 
 template <typename ValueType>
 void GlobalMatrix<ValueType>::Apply(const GlobalVector<ValueType> &in, GlobalVector<ValueType> *out) const {
 
+  assert(out != NULL);
+  assert(&in != out);
   assert(in.global_size_   == this->global_ncol_);
   assert(out->global_size_ == this->global_nrow_);
+  assert(in.ndomains_ == this->ndomains_);
+  assert(out->ndomains_ == this->ndomains_);
+
+  const int nested = _paralution_begin_nested();
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d) {
+
+    this->matrix_interior_[d].Apply(in.vector_interior_[d], &out->vector_interior_[d]);
+
+    if (this->matrix_ghost_[d].get_nnz() > 0) {
+
+      this->GetGhostValues(d, in, &this->ghost_values_[d]);
+      this->matrix_ghost_[d].ApplyAdd(this->ghost_values_[d], ValueType(1.0), &out->vector_interior_[d]);
+
+    }
+
+  }
+
+  _paralution_end_nested(nested);
 
 }
 
@@ -54,16 +436,237 @@ template <typename ValueType>
 void GlobalMatrix<ValueType>::ApplyAdd(const GlobalVector<ValueType> &in, const ValueType scalar, 
                                        GlobalVector<ValueType> *out) const {
 
+  assert(out != NULL);
+  assert(&in != out);
   assert(in.global_size_   == this->global_ncol_);
   assert(out->global_size_ == this->global_nrow_);
+  assert(in.ndomains_ == this->ndomains_);
+  assert(out->ndomains_ == this->ndomains_);
+
+  const int nested = _paralution_begin_nested();
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d) {
+
+    this->matrix_interior_[d].ApplyAdd(in.vector_interior_[d], scalar, &out->vector_interior_[d]);
+
+    if (this->matrix_ghost_[d].get_nnz() > 0) {
+
+      this->GetGhostValues(d, in, &this->ghost_values_[d]);
+      this->matrix_ghost_[d].ApplyAdd(this->ghost_values_[d], scalar, &out->vector_interior_[d]);
+
+    }
+
+  }
+
+  _paralution_end_nested(nested);
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::ExtractDiagonal(GlobalVector<ValueType> *vec_diag) const {
+
+  assert(vec_diag != NULL);
+
+  vec_diag->CloneBackend(*this);
+  vec_diag->Allocate("Diagonal elements of " + this->object_name_, this->get_nrow());
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->matrix_interior_[d].ExtractDiagonal(&vec_diag->vector_interior_[d]);
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::ExtractInverseDiagonal(GlobalVector<ValueType> *vec_inv_diag) const {
+
+  assert(vec_inv_diag != NULL);
+
+  vec_inv_diag->CloneBackend(*this);
+  vec_inv_diag->Allocate("Inverse of the diagonal elements of " + this->object_name_, this->get_nrow());
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->matrix_interior_[d].ExtractInverseDiagonal(&vec_inv_diag->vector_interior_[d]);
+
+}
+
+template <typename ValueType>
+void GlobalMatrix<ValueType>::ExtractOverlapMatrices(LocalMatrix<ValueType> *mats) const {
+
+  assert(mats != NULL);
+  assert(this->is_host());
+
+  const int nd = this->ndomains_;
+
+  // host CSR copies of the subdomains, the rows of the neighbours are needed
+  std::vector<std::vector<int> > int_row_offset(nd), int_col(nd), gst_row_offset(nd), gst_col(nd);
+  std::vector<std::vector<ValueType> > int_val(nd), gst_val(nd);
+  // global indices of the ghost unknowns
+  std::vector<std::vector<int> > ghost(nd);
+
+#pragma omp parallel for num_threads(nd) schedule(static, 1)
+  for (int d=0; d<nd; ++d) {
+
+    const int n = this->matrix_interior_[d].get_nrow();
+
+    int_row_offset[d].assign(n+1, 0);
+    gst_row_offset[d].assign(n+1, 0);
+
+    if (this->matrix_interior_[d].get_nnz() > 0) {
+      int_col[d].resize(this->matrix_interior_[d].get_nnz());
+      int_val[d].resize(this->matrix_interior_[d].get_nnz());
+      this->matrix_interior_[d].CopyToCSR(&int_row_offset[d][0], &int_col[d][0], &int_val[d][0]);
+    }
+
+    if (this->matrix_ghost_[d].get_nnz() > 0) {
+      gst_col[d].resize(this->matrix_ghost_[d].get_nnz());
+      gst_val[d].resize(this->matrix_ghost_[d].get_nnz());
+      this->matrix_ghost_[d].CopyToCSR(&gst_row_offset[d][0], &gst_col[d][0], &gst_val[d][0]);
+    }
+
+    ghost[d].resize(this->nghost_[d]);
+    for (int k=0; k<this->nghost_[d]; ++k)
+      ghost[d][k] = this->domain_offset_[this->ghost_domain_[d][k]] + this->ghost_index_[d][k];
+
+  }
+
+  const Paralution_Backend_Descriptor backend = this->DomainBackend_();
+
+#pragma omp parallel for num_threads(nd) schedule(static, 1)
+  for (int d=0; d<nd; ++d) {
+
+    const int first = this->domain_offset_[d];
+    const int last  = this->domain_offset_[d+1];
+    const int n = last - first;
+    const int m = n + this->nghost_[d];
+
+    std::vector<int> row_offset(m+1, 0), col;
+    std::vector<ValueType> val;
+    std::vector<std::pair<int, ValueType> > row;
+
+    // interior rows
+    for (int ai=0; ai<n; ++ai) {
+
+      for (int aj=int_row_offset[d][ai]; aj<int_row_offset[d][ai+1]; ++aj) {
+        col.push_back(int_col[d][aj]);
+        val.push_back(int_val[d][aj]);
+      }
+
+      for (int aj=gst_row_offset[d][ai]; aj<gst_row_offset[d][ai+1]; ++aj) {
+        col.push_back(n + gst_col[d][aj]);
+        val.push_back(gst_val[d][aj]);
+      }
+
+      row_offset[ai+1] = int(col.size());
+
+    }
+
+    // ghost rows restricted to the extended subdomain
+    for (int k=0; k<this->nghost_[d]; ++k) {
+
+      const int owner = this->ghost_domain_[d][k];
+      const int ai = this->ghost_index_[d][k];
+
+      row.clear();
+
+      for (int aj=int_row_offset[owner][ai]; aj<int_row_offset[owner][ai+1]; ++aj)
+        row.push_back(std::make_pair(this->domain_offset_[owner] + int_col[owner][aj], int_val[owner][aj]));
+
+      for (int aj=gst_row_offset[owner][ai]; aj<gst_row_offset[owner][ai+1]; ++aj)
+        row.push_back(std::make_pair(ghost[owner][gst_col[owner][aj]], gst_val[owner][aj]));
+
+      for (unsigned int j=0; j<row.size(); ++j) {
+
+        const int c = row[j].first;
+
+        if ((c >= first) && (c < last)) {
+
+          row[j].first = c - first;
+
+        } else {
+
+          std::vector<int>::const_iterator it = std::lower_bound(ghost[d].begin(), ghost[d].end(), c);
+          row[j].first = ((it != ghost[d].end()) && (*it == c)) ? n + int(it - ghost[d].begin()) : -1;
+
+        }
+
+      }
+
+      std::sort(row.begin(), row.end());
+
+      for (unsigned int j=0; j<row.size(); ++j)
+        if (row[j].first >= 0) {
+          col.push_back(row[j].first);
+          val.push_back(row[j].second);
+        }
+
+      row_offset[n+k+1] = int(col.size());
+
+    }
+
+    mats[d].Clear();
+    mats[d].local_backend_ = backend;
+
+    mats[d].AllocateCSR(this->object_name_, int(col.size()), m, m);
+    mats[d].CopyFromCSR(&row_offset[0], &col[0], &val[0]);
+
+  }
 
 }
 
 template <typename ValueType>
 void GlobalMatrix<ValueType>::CopyFrom(const GlobalMatrix<ValueType> &src) {
 
-  assert( src.global_nnz_ != 0 );
-  assert( src.local_nnz_  != 0 );
+  assert(this != &src);
+  assert(src.ndomains_ > 0);
+
+  this->Clear();
+
+  this->object_name_ = src.object_name_;
+  this->local_backend_ = src.local_backend_;
+
+  this->ndomains_ = src.ndomains_;
+  allocate_host(this->ndomains_+1, &this->domain_offset_);
+
+  for (int d=0; d<=this->ndomains_; ++d)
+    this->domain_offset_[d] = src.domain_offset_[d];
+
+  this->global_nrow_ = src.global_nrow_;
+  this->global_ncol_ = src.global_ncol_;
+  this->global_nnz_  = src.global_nnz_;
+
+  this->matrix_interior_ = new LocalMatrix<ValueType>[this->ndomains_];
+  this->matrix_ghost_ = new LocalMatrix<ValueType>[this->ndomains_];
+  this->ghost_values_ = new LocalVector<ValueType>[this->ndomains_];
+
+  allocate_host(this->ndomains_, &this->nghost_);
+  this->ghost_domain_ = new int*[this->ndomains_];
+  this->ghost_index_ = new int*[this->ndomains_];
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d) {
+
+    this->matrix_interior_[d].CloneFrom(src.matrix_interior_[d]);
+    this->matrix_ghost_[d].CloneFrom(src.matrix_ghost_[d]);
+
+    this->nghost_[d] = src.nghost_[d];
+    this->ghost_domain_[d] = NULL;
+    this->ghost_index_[d] = NULL;
+
+    if (this->nghost_[d] > 0) {
+
+      allocate_host(this->nghost_[d], &this->ghost_domain_[d]);
+      allocate_host(this->nghost_[d], &this->ghost_index_[d]);
+
+      for (int k=0; k<this->nghost_[d]; ++k) {
+        this->ghost_domain_[d][k] = src.ghost_domain_[d][k];
+        this->ghost_index_[d][k] = src.ghost_index_[d][k];
+      }
+
+    }
+
+  }
 
 }
 
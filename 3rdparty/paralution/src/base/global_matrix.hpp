@@ -37,7 +37,11 @@ template <typename ValueType>
 class LocalMatrix;
 
 
-// Global Matrix
+// Global Matrix - shared memory domain decomposition of a square sparse matrix,
+// the rows are split into contiguous subdomains; each subdomain keeps the
+// coupling to its own unknowns (interior) and to the unknowns of the other
+// subdomains (ghost) in local matrices, the subdomains are processed in
+// parallel by separate groups of OpenMP threads
 template <typename ValueType>
 class GlobalMatrix : public Operator<ValueType> {
   
@@ -46,26 +50,75 @@ public:
   GlobalMatrix();
   virtual ~GlobalMatrix();
 
-  virtual int get_nrow(void) const { return 0;};
-  virtual int get_ncol(void) const { return 0;};
+  virtual int get_nrow(void) const { return this->global_nrow_; }
+  virtual int get_ncol(void) const { return this->global_ncol_; }
+  virtual int get_nnz(void) const { return this->global_nnz_; }
 
+  /// Return the number of subdomains
+  int get_ndomains(void) const { return this->ndomains_; }
+
+  virtual void info(void) const;
+
+  virtual void MoveToAccelerator(void);
+  virtual void MoveToHost(void);
+
+  virtual void Clear(void);
+
+  /// Split a local (CSR) matrix into subdomains with a balanced number of
+  /// nonzero entries, ndomains should not exceed the number of OpenMP threads
+  void Partition(const LocalMatrix<ValueType> &mat, const int ndomains);
 
   virtual void CopyFrom(const GlobalMatrix<ValueType>&);
-  
+
+  /// Return the coupling of a subdomain to its own unknowns
+  const LocalMatrix<ValueType>& GetInterior(const int domain) const;
+  /// Return the coupling of a subdomain to its ghost unknowns
+  const LocalMatrix<ValueType>& GetGhost(const int domain) const;
+  /// Return the number of ghost unknowns of a subdomain
+  int get_nghost(const int domain) const;
+
+  /// Gather the values of the ghost unknowns of a subdomain
+  void GetGhostValues(const int domain, const GlobalVector<ValueType> &in,
+                      LocalVector<ValueType> *ghost) const;
+
+  /// Build the matrices of the subdomains extended by their ghost unknowns
+  /// (interior unknowns first, then the ghost unknowns in the order of GetGhostValues)
+  void ExtractOverlapMatrices(LocalMatrix<ValueType> *mats) const;
+
+  void ExtractDiagonal(GlobalVector<ValueType> *vec_diag) const;
+  void ExtractInverseDiagonal(GlobalVector<ValueType> *vec_inv_diag) const;
+
   virtual void Apply(const GlobalVector<ValueType> &in, GlobalVector<ValueType> *out) const; 
   virtual void ApplyAdd(const GlobalVector<ValueType> &in, const ValueType scalar, 
                         GlobalVector<ValueType> *out) const; 
 
 protected:
 
-  virtual bool is_host(void) const {return true;};
-  virtual bool is_accel(void) const {return true;};
+  virtual bool is_host(void) const;
+  virtual bool is_accel(void) const;
 
 private:
 
-  int local_nrow_, local_ncol_, local_nnz_;
+  /// Backend of the subdomain objects - their share of the OpenMP threads
+  Paralution_Backend_Descriptor DomainBackend_(void) const;
+
+  int ndomains_;
+  int *domain_offset_;
+
   int global_nrow_, global_ncol_, global_nnz_;
 
+  LocalMatrix<ValueType> *matrix_interior_;
+  LocalMatrix<ValueType> *matrix_ghost_;
+
+  /// Scratch for the ghost values gathered by Apply/ApplyAdd
+  LocalVector<ValueType> *ghost_values_;
+
+  /// Number of ghost unknowns, their subdomain and index in the subdomain
+  /// (sorted by the global index)
+  int *nghost_;
+  int **ghost_domain_;
+  int **ghost_index_;
+
   friend class GlobalVector<ValueType>;  
   friend class LocalMatrix<ValueType>;  
   friend class LocalVector<ValueType>;  
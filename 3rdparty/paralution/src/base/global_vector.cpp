@@ -20,11 +20,15 @@
 // *************************************************************************
 
 #include "global_vector.hpp"
+#include "global_matrix.hpp"
 #include "local_vector.hpp"
 
+#include "../utils/allocate_free.hpp"
 #include "../utils/log.hpp"
 
 #include <assert.h>
+#include <math.h>
+#include <algorithm>
 
 namespace paralution {
 
@@ -32,7 +36,13 @@ template <typename ValueType>
 GlobalVector<ValueType>::GlobalVector() {
 
   this->object_name_ = "";
-  FATAL_ERROR(__FILE__, __LINE__);    
+
+  this->ndomains_ = 0;
+  this->domain_offset_ = NULL;
+
+  this->global_size_ = 0;
+
+  this->vector_interior_ = NULL;
   
 }
 
@@ -41,121 +51,556 @@ GlobalVector<ValueType>::~GlobalVector() {
 
   this->Clear();
 
+  if (this->ndomains_ > 0)
+    free_host(&this->domain_offset_);
+
 }
 
 template <typename ValueType>
 int GlobalVector<ValueType>::get_size(void) const { 
-  return 0;
+  return this->global_size_;
+}
+
+template <typename ValueType>
+bool GlobalVector<ValueType>::is_host(void) const {
+
+  if (this->vector_interior_ == NULL)
+    return true;
+
+  return this->vector_interior_[0].is_host();
+
+}
+
+template <typename ValueType>
+bool GlobalVector<ValueType>::is_accel(void) const {
+
+  if (this->vector_interior_ == NULL)
+    return false;
+
+  return this->vector_interior_[0].is_accel();
+
+}
+
+template <typename ValueType>
+void GlobalVector<ValueType>::SetDomains_(const int ndomains, const int *domain_offset) {
+
+  assert(ndomains > 0);
+  assert(domain_offset != NULL);
+
+  if (this->ndomains_ > 0)
+    free_host(&this->domain_offset_);
+
+  this->ndomains_ = ndomains;
+  allocate_host(ndomains+1, &this->domain_offset_);
+
+  for (int d=0; d<=ndomains; ++d)
+    this->domain_offset_[d] = domain_offset[d];
+
+}
+
+template <typename ValueType>
+int GlobalVector<ValueType>::Domain_(const int i) const {
+
+  assert((i >= 0) && (i < this->global_size_));
+
+  return int(std::upper_bound(this->domain_offset_, this->domain_offset_ + this->ndomains_ + 1, i)
+             - this->domain_offset_) - 1;
+
 }
 
+template <typename ValueType>
+bool GlobalVector<ValueType>::SameDomains_(const GlobalVector<ValueType> &x) const {
+
+  if ((this->ndomains_ != x.ndomains_) || (this->global_size_ != x.global_size_))
+    return false;
+
+  for (int d=0; d<=this->ndomains_; ++d)
+    if (this->domain_offset_[d] != x.domain_offset_[d])
+      return false;
+
+  return true;
+
+}
+
+template <typename ValueType>
+void GlobalVector<ValueType>::CloneBackend(const GlobalMatrix<ValueType> &mat) {
+
+  assert(mat.get_ndomains() > 0);
+
+  this->local_backend_ = mat.local_backend_;
+
+  GlobalVector<ValueType> domains;
+  domains.SetDomains_(mat.ndomains_, mat.domain_offset_);
+  domains.global_size_ = mat.get_nrow();
+
+  if ((this->get_size() == mat.get_nrow()) && !this->SameDomains_(domains)) {
+
+    // move the values to the new subdomains
+    LocalVector<ValueType> values;
+    this->CopyTo(&values);
+
+    std::string name = this->object_name_;
+
+    this->SetDomains_(mat.ndomains_, mat.domain_offset_);
+    this->Allocate(name, values.get_size());
+    this->CopyFrom(values);
+
+  } else if (this->get_size() != mat.get_nrow()) {
+
+    this->Clear();
+    this->SetDomains_(mat.ndomains_, mat.domain_offset_);
+
+  }
+
+  if (mat.is_host())
+    this->MoveToHost();
+  else
+    this->MoveToAccelerator();
+
+}
+
+template <typename ValueType>
+void GlobalVector<ValueType>::CloneBackend(const GlobalVector<ValueType> &vec) {
+
+  assert(this != &vec);
+
+  this->local_backend_ = vec.local_backend_;
+
+  if (vec.ndomains_ > 0) {
+
+    if (this->get_size() > 0) {
+
+      assert(this->SameDomains_(vec));
+
+    } else {
+
+      this->SetDomains_(vec.ndomains_, vec.domain_offset_);
+
+    }
+
+  }
+
+  if (vec.is_host())
+    this->MoveToHost();
+  else
+    this->MoveToAccelerator();
+
+}
 
 template <typename ValueType>
 void GlobalVector<ValueType>::Allocate(std::string name, const unsigned int size) {
+
+  this->Clear();
+  this->object_name_ = name;
+
+  if (size > 0) {
+
+    if ((this->ndomains_ == 0) || (this->domain_offset_[this->ndomains_] != int(size))) {
+
+      int offset[2] = { 0, int(size) };
+      this->SetDomains_(1, offset);
+
+    }
+
+    this->global_size_ = size;
+
+    this->vector_interior_ = new LocalVector<ValueType>[this->ndomains_];
+
+    // each subdomain gets its share of the threads
+    Paralution_Backend_Descriptor backend = this->local_backend_;
+    backend.OpenMP_threads = std::max(1, this->local_backend_.OpenMP_threads / this->ndomains_);
+
+    // allocated (first touched) by the thread working on the subdomain
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+    for (int d=0; d<this->ndomains_; ++d) {
+
+      this->vector_interior_[d].local_backend_ = backend;
+
+      this->vector_interior_[d].Allocate(name, this->domain_offset_[d+1] - this->domain_offset_[d]);
+
+    }
+
+  }
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::Clear(void) {
+
+  if (this->vector_interior_ != NULL) {
+
+    delete[] this->vector_interior_;
+
+    this->vector_interior_ = NULL;
+
+    this->global_size_ = 0;
+
+  }
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::Zeros(void) {
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    if (this->vector_interior_ != NULL)
+      this->vector_interior_[d].Zeros();
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::Ones(void) {
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    if (this->vector_interior_ != NULL)
+      this->vector_interior_[d].Ones();
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::SetValues(const ValueType val) {
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    if (this->vector_interior_ != NULL)
+      this->vector_interior_[d].SetValues(val);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::SetRandom(const ValueType a, const ValueType b, const int seed) {
+
+  // sequential, rand() is not reentrant
+  for (int d=0; d<this->ndomains_; ++d)
+    if (this->vector_interior_ != NULL)
+      this->vector_interior_[d].SetRandom(a, b, seed + d);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::CopyFrom(const GlobalVector<ValueType> &src) {
+
+  assert(this != &src);
+  assert(this->SameDomains_(src));
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].CopyFrom(src.vector_interior_[d]);
+
+}
+
+template <typename ValueType>
+void GlobalVector<ValueType>::CopyFrom(const LocalVector<ValueType> &src) {
+
+  assert(src.get_size() == this->get_size());
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].CopyFrom(src,
+                                       this->domain_offset_[d], 0,
+                                       this->vector_interior_[d].get_size());
+
+}
+
+template <typename ValueType>
+void GlobalVector<ValueType>::CopyTo(LocalVector<ValueType> *dst) const {
+
+  assert(dst != NULL);
+
+  if (dst->get_size() != this->get_size()) {
+
+    dst->CloneBackend(*this);
+    dst->Allocate(this->object_name_, this->get_size());
+
+  }
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    dst->CopyFrom(this->vector_interior_[d],
+                  0, this->domain_offset_[d],
+                  this->vector_interior_[d].get_size());
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::CloneFrom(const GlobalVector<ValueType> &src) {
+
+  assert(this != &src);
+
+  this->Clear();
+  this->CloneBackend(src);
+  this->Allocate(src.object_name_, src.get_size());
+  this->CopyFrom(src);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::MoveToAccelerator(void) {
+
+  for (int d=0; d<this->ndomains_; ++d)
+    if (this->vector_interior_ != NULL)
+      this->vector_interior_[d].MoveToAccelerator();
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::MoveToHost(void) {
+
+  for (int d=0; d<this->ndomains_; ++d)
+    if (this->vector_interior_ != NULL)
+      this->vector_interior_[d].MoveToHost();
+
 }
 
 template <typename ValueType>
 ValueType&  GlobalVector<ValueType>::operator[](const unsigned int i) { 
-  // not correct
-  return this->vector_interior_[i];
+
+  const int d = this->Domain_(i);
+  return this->vector_interior_[d][i - this->domain_offset_[d]];
+
 }
 
 template <typename ValueType>
 const ValueType&  GlobalVector<ValueType>::operator[](const unsigned int i) const { 
-  // not correct
-  return this->vector_interior_[i];
+
+  const int d = this->Domain_(i);
+  return this->vector_interior_[d][i - this->domain_offset_[d]];
+
+}
+
+template <typename ValueType>
+LocalVector<ValueType>& GlobalVector<ValueType>::GetInterior(const int domain) {
+
+  assert((domain >= 0) && (domain < this->ndomains_));
+  assert(this->vector_interior_ != NULL);
+
+  return this->vector_interior_[domain];
+
+}
+
+template <typename ValueType>
+const LocalVector<ValueType>& GlobalVector<ValueType>::GetInterior(const int domain) const {
+
+  assert((domain >= 0) && (domain < this->ndomains_));
+  assert(this->vector_interior_ != NULL);
+
+  return this->vector_interior_[domain];
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::info(void) const {
+
+  LOG_INFO("GlobalVector"
+           << " name=" << this->object_name_ << ";"
+           << " size=" << this->get_size() << ";"
+           << " domains=" << this->ndomains_ << ";"
+           << " prec=" << 8*sizeof(ValueType) << "bit;"
+           << " host backend={" << _paralution_host_name[0] << "};"
+           << " accelerator backend={" << _paralution_backend_name[this->local_backend_.backend] << "};"
+           << " current=" << (this->is_host() ? _paralution_host_name[0] : _paralution_backend_name[this->local_backend_.backend]));
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::ReadFileASCII(const std::string name) {
+
+  LocalVector<ValueType> values;
+  values.ReadFileASCII(name);
+
+  this->Allocate(name, values.get_size());
+  this->CopyFrom(values);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::WriteFileASCII(const std::string name) const {
+
+  LocalVector<ValueType> values;
+  this->CopyTo(&values);
+
+  values.WriteFileASCII(name);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::AddScale(const GlobalVector<ValueType> &x, const ValueType alpha) {          
+
+  assert(this->SameDomains_(x));
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].AddScale(x.vector_interior_[d], alpha);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::ScaleAdd(const ValueType alpha, const GlobalVector<ValueType> &x) {
+
+  assert(this->SameDomains_(x));
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].ScaleAdd(alpha, x.vector_interior_[d]);
+
+}
+
+template <typename ValueType>
+void GlobalVector<ValueType>::ScaleAddScale(const ValueType alpha, const GlobalVector<ValueType> &x, const ValueType beta) {
+
+  assert(this->SameDomains_(x));
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].ScaleAddScale(alpha, x.vector_interior_[d], beta);
+
+}
+
+template <typename ValueType>
+void GlobalVector<ValueType>::ScaleAdd2(const ValueType alpha, const GlobalVector<ValueType> &x,
+                                        const ValueType beta, const GlobalVector<ValueType> &y, const ValueType gamma) {
+
+  assert(this->SameDomains_(x));
+  assert(this->SameDomains_(y));
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].ScaleAdd2(alpha, x.vector_interior_[d], beta, y.vector_interior_[d], gamma);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::Scale(const ValueType alpha) {
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    if (this->vector_interior_ != NULL)
+      this->vector_interior_[d].Scale(alpha);
+
 }
 
+// the partial results of the subdomains are summed up in a fixed order,
+// the result does not depend on the thread scheduling
 template <typename ValueType>
 ValueType GlobalVector<ValueType>::Dot(const GlobalVector<ValueType> &x) const {
-  return ValueType(0.0);
+
+  assert(this->SameDomains_(x));
+
+  ValueType *partial = NULL;
+  allocate_host(this->ndomains_, &partial);
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    partial[d] = this->vector_interior_[d].Dot(x.vector_interior_[d]);
+
+  ValueType dot = ValueType(0.0);
+  for (int d=0; d<this->ndomains_; ++d)
+    dot += partial[d];
+
+  free_host(&partial);
+
+  return dot;
+
 }
 
 template <typename ValueType>
 ValueType GlobalVector<ValueType>::Norm(void) const {
-  return ValueType(0.0);
+
+  return sqrt(this->Dot(*this));
+
 }
 
 template <typename ValueType>
 ValueType GlobalVector<ValueType>::Reduce(void) const {
-  return ValueType(0.0);
+
+  ValueType *partial = NULL;
+  allocate_host(this->ndomains_, &partial);
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    partial[d] = this->vector_interior_[d].Reduce();
+
+  ValueType sum = ValueType(0.0);
+  for (int d=0; d<this->ndomains_; ++d)
+    sum += partial[d];
+
+  free_host(&partial);
+
+  return sum;
+
 }
 
 template <typename ValueType>
 ValueType GlobalVector<ValueType>::Asum(void) const {
-  return ValueType(0.0);
+
+  ValueType *partial = NULL;
+  allocate_host(this->ndomains_, &partial);
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    partial[d] = this->vector_interior_[d].Asum();
+
+  ValueType sum = ValueType(0.0);
+  for (int d=0; d<this->ndomains_; ++d)
+    sum += partial[d];
+
+  free_host(&partial);
+
+  return sum;
+
 }
 
 template <typename ValueType>
 int GlobalVector<ValueType>::Amax(ValueType &value) const {
-  return 0;
+
+  ValueType *partial = NULL;
+  int *index = NULL;
+  allocate_host(this->ndomains_, &partial);
+  allocate_host(this->ndomains_, &index);
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    index[d] = this->vector_interior_[d].Amax(partial[d]);
+
+  int amax = 0;
+  value = ValueType(0.0);
+
+  for (int d=0; d<this->ndomains_; ++d)
+    if (partial[d] > value) {
+      value = partial[d];
+      amax = this->domain_offset_[d] + index[d];
+    }
+
+  free_host(&partial);
+  free_host(&index);
+
+  return amax;
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::PointWiseMult(const GlobalVector<ValueType> &x) {
+
+  assert(this->SameDomains_(x));
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].PointWiseMult(x.vector_interior_[d]);
+
 }
 
 template <typename ValueType>
 void GlobalVector<ValueType>::PointWiseMult(const GlobalVector<ValueType> &x, const GlobalVector<ValueType> &y) {
+
+  assert(this->SameDomains_(x));
+  assert(this->SameDomains_(y));
+
+#pragma omp parallel for num_threads(this->ndomains_) schedule(static, 1)
+  for (int d=0; d<this->ndomains_; ++d)
+    this->vector_interior_[d].PointWiseMult(x.vector_interior_[d], y.vector_interior_[d]);
+
 }
 
 
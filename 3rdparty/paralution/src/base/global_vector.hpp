@@ -36,7 +36,9 @@ template <typename ValueType>
 class GlobalStencil;
 
 
-// Global vector
+// Global vector - split into the subdomains of a GlobalMatrix (shared memory
+// domain decomposition), each part is kept in a local vector and the
+// subdomains are processed in parallel by separate groups of OpenMP threads
 template <typename ValueType>
 class GlobalVector : public Vector<ValueType> {
   
@@ -51,6 +53,17 @@ public:
   virtual void info(void) const ;   
   virtual int get_size(void) const;
 
+  /// Return the number of subdomains
+  int get_ndomains(void) const { return this->ndomains_; }
+
+  using BaseParalution<ValueType>::CloneBackend;
+  /// Clone the backend and the subdomains of a global matrix
+  void CloneBackend(const GlobalMatrix<ValueType> &mat);
+  /// Clone the backend and the subdomains of a global vector
+  void CloneBackend(const GlobalVector<ValueType> &vec);
+
+  /// Allocate the vector, the subdomains are taken from CloneBackend()
+  /// (one subdomain if there are none or if they do not match the size)
   virtual void Allocate(std::string name, const unsigned int size);
   virtual void Clear(void);
   virtual void Zeros(void);
@@ -63,7 +76,16 @@ public:
   ValueType& operator[](const unsigned int i);
   const ValueType& operator[](const unsigned int i) const;
 
+  /// Return the part of the vector in a subdomain
+  LocalVector<ValueType>& GetInterior(const int domain);
+  const LocalVector<ValueType>& GetInterior(const int domain) const;
+
   virtual void CopyFrom(const GlobalVector<ValueType> &src);
+  /// Copy the values from a local vector (global numbering)
+  virtual void CopyFrom(const LocalVector<ValueType> &src);
+  /// Copy the values to a local vector (global numbering)
+  void CopyTo(LocalVector<ValueType> *dst) const;
+
   virtual void ReadFileASCII(const std::string filename);
   virtual void WriteFileASCII(const std::string filename) const;
 
@@ -72,6 +94,11 @@ public:
   virtual void AddScale(const GlobalVector<ValueType> &x, const ValueType alpha);
   // this = alpha*this + x
   virtual void ScaleAdd(const ValueType alpha, const GlobalVector<ValueType> &x);
+  // this = alpha*this + x*beta
+  virtual void ScaleAddScale(const ValueType alpha, const GlobalVector<ValueType> &x, const ValueType beta);
+  // this = alpha*this + x*beta + y*gamma
+  virtual void ScaleAdd2(const ValueType alpha, const GlobalVector<ValueType> &x,
+                         const ValueType beta, const GlobalVector<ValueType> &y, const ValueType gamma);
   // this = alpha*this
   virtual void Scale(const ValueType alpha);
   // this^T x
@@ -90,16 +117,25 @@ public:
 
 protected:
 
-  virtual bool is_host(void) const {return true;};
-  virtual bool is_accel(void) const {return true;};
+  virtual bool is_host(void) const;
+  virtual bool is_accel(void) const;
 
 private:
 
-  int local_size_;
+  /// Set the subdomains (offsets of the subdomains in the global numbering)
+  void SetDomains_(const int ndomains, const int *domain_offset);
+  /// Return the subdomain of a global index
+  int Domain_(const int i) const;
+  /// Check that both vectors are split in the same way
+  bool SameDomains_(const GlobalVector<ValueType> &x) const;
+
+  int ndomains_;
+  int *domain_offset_;
+
   int global_size_;
 
-  LocalVector<ValueType> vector_interior_;
-  LocalVector<ValueType> vector_ghost_;
+  /// Values of the subdomains
+  LocalVector<ValueType> *vector_interior_;
 
   friend class LocalMatrix<ValueType>;  
   friend class GlobalMatrix<ValueType>;  
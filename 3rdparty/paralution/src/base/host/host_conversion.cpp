@@ -25,6 +25,7 @@
 #include "../../utils/allocate_free.hpp"
 #include <assert.h>
 #include <stdlib.h>
+#include <algorithm>
 
 #include "../../utils/log.hpp"
 
@@ -493,6 +494,234 @@ void hyb_to_csr(const int omp_threads,
 
 }
 
+// number of nonzero blocks in each block row, returns the total number of blocks
+template <typename ValueType, typename IndexType>
+IndexType csr_bcsr_count(const IndexType nrow, const IndexType ncol,
+                         const MatrixCSR<ValueType, IndexType> &src,
+                         const IndexType blockdim, IndexType *row_nnzb) {
+
+  const IndexType nrowb = nrow / blockdim;
+  const IndexType ncolb = ncol / blockdim;
+  IndexType nnzb = 0;
+
+#pragma omp parallel reduction(+:nnzb)
+  {
+    IndexType *stamp = NULL;
+    allocate_host(ncolb, &stamp);
+
+    for (IndexType bj=0; bj<ncolb; ++bj)
+      stamp[bj] = -1;
+
+#pragma omp for
+    for (IndexType bi=0; bi<nrowb; ++bi) {
+
+      IndexType count = 0;
+
+      for (IndexType r=0; r<blockdim; ++r)
+        for (IndexType j=src.row_offset[bi*blockdim+r]; j<src.row_offset[bi*blockdim+r+1]; ++j) {
+
+          IndexType bj = src.col[j] / blockdim;
+
+          if (stamp[bj] != bi) {
+            stamp[bj] = bi;
+            ++count;
+          }
+
+        }
+
+      if (row_nnzb != NULL)
+        row_nnzb[bi] = count;
+
+      nnzb += count;
+    }
+
+    free_host(&stamp);
+  }
+
+  return nnzb;
+
+}
+
+template <typename ValueType, typename IndexType>
+IndexType csr_bcsr_blockdim(const int omp_threads,
+                            const IndexType nnz, const IndexType nrow, const IndexType ncol,
+                            const MatrixCSR<ValueType, IndexType> &src) {
+
+  assert(nnz  > 0);
+  assert(nrow > 0);
+  assert(ncol > 0);
+
+  omp_set_num_threads(omp_threads);
+
+  for (IndexType blockdim=4; blockdim>1; --blockdim) {
+
+    if ((nrow % blockdim != 0) || (ncol % blockdim != 0))
+      continue;
+
+    IndexType nnzb = csr_bcsr_count(nrow, ncol, src, blockdim, (IndexType *) NULL);
+
+    // accept at most 1/3 of explicit zeros in the blocks
+    if (3*nnzb*blockdim*blockdim <= 4*nnz)
+      return blockdim;
+
+  }
+
+  return 1;
+
+}
+
+template <typename ValueType, typename IndexType>
+void csr_to_bcsr(const int omp_threads,
+                 const IndexType nnz, const IndexType nrow, const IndexType ncol,
+                 const MatrixCSR<ValueType, IndexType> &src,
+                 const IndexType blockdim,
+                 MatrixBCSR<ValueType, IndexType> *dst, IndexType *nnz_bcsr ) {
+
+  assert(nnz  > 0);
+  assert(nrow > 0);
+  assert(ncol > 0);
+  assert(blockdim > 0);
+  assert(nrow % blockdim == 0);
+  assert(ncol % blockdim == 0);
+
+  omp_set_num_threads(omp_threads);
+
+  const IndexType nrowb = nrow / blockdim;
+  const IndexType ncolb = ncol / blockdim;
+
+  allocate_host(nrowb+1, &dst->row_offset);
+  set_to_zero_host(nrowb+1, dst->row_offset);
+
+  csr_bcsr_count(nrow, ncol, src, blockdim, dst->row_offset);
+
+  IndexType nnzb = 0;
+  for (IndexType bi=0; bi<nrowb; ++bi) {
+    IndexType tmp = dst->row_offset[bi];
+    dst->row_offset[bi] = nnzb;
+    nnzb += tmp;
+  }
+
+  dst->row_offset[nrowb] = nnzb;
+
+  allocate_host(nnzb, &dst->col);
+  allocate_host(nnzb*blockdim*blockdim, &dst->val);
+
+  set_to_zero_host(nnzb, dst->col);
+  set_to_zero_host(nnzb*blockdim*blockdim, dst->val);
+
+  dst->blockdim = blockdim;
+
+#pragma omp parallel
+  {
+    IndexType *stamp = NULL;
+    IndexType *pos = NULL;
+    allocate_host(ncolb, &stamp);
+    allocate_host(ncolb, &pos);
+
+    for (IndexType bj=0; bj<ncolb; ++bj)
+      stamp[bj] = -1;
+
+#pragma omp for
+    for (IndexType bi=0; bi<nrowb; ++bi) {
+
+      IndexType ind = dst->row_offset[bi];
+
+      // block columns of the block row
+      for (IndexType r=0; r<blockdim; ++r)
+        for (IndexType j=src.row_offset[bi*blockdim+r]; j<src.row_offset[bi*blockdim+r+1]; ++j) {
+
+          IndexType bj = src.col[j] / blockdim;
+
+          if (stamp[bj] != bi) {
+            stamp[bj] = bi;
+            dst->col[ind] = bj;
+            ++ind;
+          }
+
+        }
+
+      std::sort(dst->col + dst->row_offset[bi], dst->col + dst->row_offset[bi+1]);
+
+      for (IndexType k=dst->row_offset[bi]; k<dst->row_offset[bi+1]; ++k)
+        pos[dst->col[k]] = k;
+
+      // values
+      for (IndexType r=0; r<blockdim; ++r)
+        for (IndexType j=src.row_offset[bi*blockdim+r]; j<src.row_offset[bi*blockdim+r+1]; ++j)
+          dst->val[BCSR_IND(pos[src.col[j] / blockdim], r, src.col[j] % blockdim, blockdim)] = src.val[j];
+
+    }
+
+    free_host(&stamp);
+    free_host(&pos);
+  }
+
+  *nnz_bcsr = nnzb;
+
+}
+
+template <typename ValueType, typename IndexType>
+void bcsr_to_csr(const int omp_threads,
+                 const IndexType nnz, const IndexType nrow, const IndexType ncol,
+                 const MatrixBCSR<ValueType, IndexType> &src,
+                 MatrixCSR<ValueType, IndexType> *dst, IndexType *nnz_csr ) {
+
+  assert(nnz  > 0);
+  assert(nrow > 0);
+  assert(ncol > 0);
+
+  omp_set_num_threads(omp_threads);
+
+  const IndexType blockdim = src.blockdim;
+  const IndexType nrowb = nrow / blockdim;
+
+  allocate_host(nrow+1, &dst->row_offset);
+  set_to_zero_host(nrow+1, dst->row_offset);
+
+  // the zero fill-in of the blocks is dropped, the diagonal is kept
+#pragma omp parallel for
+  for (IndexType bi=0; bi<nrowb; ++bi)
+    for (IndexType k=src.row_offset[bi]; k<src.row_offset[bi+1]; ++k)
+      for (IndexType r=0; r<blockdim; ++r)
+        for (IndexType c=0; c<blockdim; ++c)
+          if ((src.val[BCSR_IND(k, r, c, blockdim)] != ValueType(0.0)) ||
+              (bi*blockdim+r == src.col[k]*blockdim+c))
+            dst->row_offset[bi*blockdim+r] += 1;
+
+  *nnz_csr = 0;
+  for (IndexType i = 0; i < nrow; ++i) {
+    IndexType tmp = dst->row_offset[i];
+    dst->row_offset[i] = *nnz_csr;
+    *nnz_csr += tmp;
+  }
+
+  dst->row_offset[nrow] = *nnz_csr;
+
+  allocate_host(*nnz_csr, &dst->col);
+  allocate_host(*nnz_csr, &dst->val);
+
+  set_to_zero_host(*nnz_csr, dst->col);
+  set_to_zero_host(*nnz_csr, dst->val);
+
+#pragma omp parallel for
+  for (IndexType bi=0; bi<nrowb; ++bi)
+    for (IndexType r=0; r<blockdim; ++r) {
+
+      IndexType ind = dst->row_offset[bi*blockdim+r];
+
+      for (IndexType k=src.row_offset[bi]; k<src.row_offset[bi+1]; ++k)
+        for (IndexType c=0; c<blockdim; ++c)
+          if ((src.val[BCSR_IND(k, r, c, blockdim)] != ValueType(0.0)) ||
+              (bi*blockdim+r == src.col[k]*blockdim+c)) {
+            dst->col[ind] = src.col[k]*blockdim+c;
+            dst->val[ind] = src.val[BCSR_IND(k, r, c, blockdim)];
+            ++ind;
+          }
+
+    }
+
+}
+
 // ----------------------------------------------------------
 // function coo_to_csr(...)
 // ----------------------------------------------------------
@@ -1067,5 +1296,50 @@ template void hyb_to_csr(const int omp_threads,
                          const MatrixHYB<int, int> &src,
                          MatrixCSR<int, int> *dst, int *nnz_csr );
 
+template int csr_bcsr_blockdim(const int omp_threads,
+                                const int nnz, const int nrow, const int ncol,
+                                const MatrixCSR<double, int> &src);
+
+template int csr_bcsr_blockdim(const int omp_threads,
+                                const int nnz, const int nrow, const int ncol,
+                                const MatrixCSR<float, int> &src);
+
+template int csr_bcsr_blockdim(const int omp_threads,
+                                const int nnz, const int nrow, const int ncol,
+                                const MatrixCSR<int, int> &src);
+
+template void csr_to_bcsr(const int omp_threads,
+                          const int nnz, const int nrow, const int ncol,
+                          const MatrixCSR<double, int> &src,
+                          const int blockdim,
+                          MatrixBCSR<double, int> *dst, int *nnz_bcsr );
+
+template void csr_to_bcsr(const int omp_threads,
+                          const int nnz, const int nrow, const int ncol,
+                          const MatrixCSR<float, int> &src,
+                          const int blockdim,
+                          MatrixBCSR<float, int> *dst, int *nnz_bcsr );
+
+template void csr_to_bcsr(const int omp_threads,
+                          const int nnz, const int nrow, const int ncol,
+                          const MatrixCSR<int, int> &src,
+                          const int blockdim,
+                          MatrixBCSR<int, int> *dst, int *nnz_bcsr );
+
+template void bcsr_to_csr(const int omp_threads,
+                          const int nnz, const int nrow, const int ncol,
+                          const MatrixBCSR<double, int> &src,
+                          MatrixCSR<double, int> *dst, int *nnz_csr );
+
+template void bcsr_to_csr(const int omp_threads,
+                          const int nnz, const int nrow, const int ncol,
+                          const MatrixBCSR<float, int> &src,
+                          MatrixCSR<float, int> *dst, int *nnz_csr );
+
+template void bcsr_to_csr(const int omp_threads,
+                          const int nnz, const int nrow, const int ncol,
+                          const MatrixBCSR<int, int> &src,
+                          MatrixCSR<int, int> *dst, int *nnz_csr );
+
 }
 
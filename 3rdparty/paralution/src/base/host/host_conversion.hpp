@@ -64,6 +64,20 @@ void csr_to_hyb(const int omp_threads,
                 MatrixHYB<ValueType, IndexType> *dst, 
                 IndexType *nnz_hyb, IndexType *nnz_ell, IndexType *nnz_coo);
 
+// largest block dimension (4, 3, 2) which does not store much more than
+// the nonzero entries of the CSR matrix, 1 if there is no block structure
+template <typename ValueType, typename IndexType>
+IndexType csr_bcsr_blockdim(const int omp_threads,
+                            const IndexType nnz, const IndexType nrow, const IndexType ncol,
+                            const MatrixCSR<ValueType, IndexType> &src);
+
+template <typename ValueType, typename IndexType>
+void csr_to_bcsr(const int omp_threads,
+                 const IndexType nnz, const IndexType nrow, const IndexType ncol,
+                 const MatrixCSR<ValueType, IndexType> &src,
+                 const IndexType blockdim,
+                 MatrixBCSR<ValueType, IndexType> *dst, IndexType *nnz_bcsr );
+
 template <typename ValueType, typename IndexType>
 void dense_to_csr(const int omp_threads,
                   const IndexType nrow, const IndexType ncol,
@@ -83,6 +97,12 @@ void ell_to_csr(const int omp_threads,
                 const MatrixELL<ValueType, IndexType> &src,
                 MatrixCSR<ValueType, IndexType> *dst, IndexType *nnz_csr );
 
+template <typename ValueType, typename IndexType>
+void bcsr_to_csr(const int omp_threads,
+                 const IndexType nnz, const IndexType nrow, const IndexType ncol,
+                 const MatrixBCSR<ValueType, IndexType> &src,
+                 MatrixCSR<ValueType, IndexType> *dst, IndexType *nnz_csr );
+
 template <typename ValueType, typename IndexType>
 void coo_to_csr(const int omp_threads,
                 const IndexType nnz, const IndexType nrow, const IndexType ncol,
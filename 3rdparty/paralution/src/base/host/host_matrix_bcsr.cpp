@@ -31,6 +31,7 @@
 #include "../backend_manager.hpp"
 #include "../../utils/log.hpp"
 #include "../../utils/allocate_free.hpp"
+#include "../../utils/math_functions.hpp"
 #include "../matrix_formats_ind.hpp"
 
 extern "C" {
@@ -49,12 +50,6 @@ extern "C" {
 #define omp_set_num_threads(num) ;
 #endif
 
-#ifdef SUPPORT_MKL
-#include <mkl.h>
-#include <mkl_spblas.h>
-#endif
-
-
 namespace paralution {
 
 template <typename ValueType>
@@ -68,10 +63,13 @@ HostMatrixBCSR<ValueType>::HostMatrixBCSR() {
 template <typename ValueType>
 HostMatrixBCSR<ValueType>::HostMatrixBCSR(const Paralution_Backend_Descriptor local_backend) {
 
+  this->mat_.row_offset = NULL;
+  this->mat_.col = NULL;
+  this->mat_.val = NULL;
+  this->mat_.blockdim = 0;
+
   this->set_backend(local_backend); 
 
-  // not implemented yet
-  FATAL_ERROR(__FILE__, __LINE__);
 }
 
 template <typename ValueType>
@@ -84,8 +82,7 @@ HostMatrixBCSR<ValueType>::~HostMatrixBCSR() {
 template <typename ValueType>
 void HostMatrixBCSR<ValueType>::info(void) const {
 
-  //TODO 
-  LOG_INFO("HostMatrixBCSR<ValueType>");
+  LOG_INFO("HostMatrixBCSR<ValueType>, block dimension " << this->get_blockdim());
 
 }
 
@@ -95,6 +92,12 @@ void HostMatrixBCSR<ValueType>::Clear() {
 
   if (this->get_nnz() > 0) {
 
+    free_host(&this->mat_.row_offset);
+    free_host(&this->mat_.col);
+    free_host(&this->mat_.val);
+
+    this->mat_.blockdim = 0;
+
     this->nrow_ = 0;
     this->ncol_ = 0;
     this->nnz_  = 0;
@@ -104,17 +107,35 @@ void HostMatrixBCSR<ValueType>::Clear() {
 }
 
 template <typename ValueType>
-void HostMatrixBCSR<ValueType>::AllocateBCSR(const int nnz, const int nrow, const int ncol) {
+void HostMatrixBCSR<ValueType>::AllocateBCSR(const int nnz, const int nrow, const int ncol, const int blockdim) {
 
   assert( nnz   >= 0);
   assert( ncol  >= 0);
   assert( nrow  >= 0);
+  assert( blockdim > 0);
 
   if (this->get_nnz() > 0)
     this->Clear();
 
   if (nnz > 0) {
 
+    // nnz counts all values of the dense blocks
+    assert(nnz  % (blockdim*blockdim) == 0);
+    assert(nrow % blockdim == 0);
+    assert(ncol % blockdim == 0);
+
+    const int nnzb  = nnz  / (blockdim*blockdim);
+    const int nrowb = nrow / blockdim;
+
+    allocate_host(nrowb+1, &this->mat_.row_offset);
+    allocate_host(nnzb, &this->mat_.col);
+    allocate_host(nnz, &this->mat_.val);
+
+    set_to_zero_host(nrowb+1, this->mat_.row_offset);
+    set_to_zero_host(nnzb, this->mat_.col);
+    set_to_zero_host(nnz, this->mat_.val);
+
+    this->mat_.blockdim = blockdim;
     this->nrow_ = nrow;
     this->ncol_ = ncol;
     this->nnz_  = nnz;
@@ -131,7 +152,7 @@ void HostMatrixBCSR<ValueType>::CopyFrom(const BaseMatrix<ValueType> &mat) {
 
   if (const HostMatrixBCSR<ValueType> *cast_mat = dynamic_cast<const HostMatrixBCSR<ValueType>*> (&mat)) {
     
-    this->AllocateBCSR(cast_mat->get_nnz(), cast_mat->get_nrow(), cast_mat->get_ncol());
+    this->AllocateBCSR(cast_mat->get_nnz(), cast_mat->get_nrow(), cast_mat->get_ncol(), cast_mat->get_blockdim());
 
     assert((this->get_nnz()  == mat.get_nnz())  &&
 	   (this->get_nrow() == mat.get_nrow()) &&
@@ -139,11 +160,24 @@ void HostMatrixBCSR<ValueType>::CopyFrom(const BaseMatrix<ValueType> &mat) {
     
     if (this->get_nnz() > 0) {
 
+      const int blockdim = this->get_blockdim();
+      const int nnzb  = this->get_nnz()  / (blockdim*blockdim);
+      const int nrowb = this->get_nrow() / blockdim;
+
       omp_set_num_threads(this->local_backend_.OpenMP_threads);  
 
-      // TODO
-    
-      FATAL_ERROR(__FILE__, __LINE__);
+#pragma omp parallel for
+      for (int i=0; i<nrowb+1; ++i)
+        this->mat_.row_offset[i] = cast_mat->mat_.row_offset[i];
+
+#pragma omp parallel for
+      for (int i=0; i<nnzb; ++i)
+        this->mat_.col[i] = cast_mat->mat_.col[i];
+
+#pragma omp parallel for
+      for (int i=0; i<this->get_nnz(); ++i)
+        this->mat_.val[i] = cast_mat->mat_.val[i];
+
     }
     
     
@@ -173,30 +207,30 @@ bool HostMatrixBCSR<ValueType>::ConvertFrom(const BaseMatrix<ValueType> &mat) {
   if (mat.get_nnz() == 0)
     return true;
 
-    if (const HostMatrixBCSR<ValueType> *cast_mat = dynamic_cast<const HostMatrixBCSR<ValueType>*> (&mat)) {
+  if (const HostMatrixBCSR<ValueType> *cast_mat = dynamic_cast<const HostMatrixBCSR<ValueType>*> (&mat)) {
 
-      this->CopyFrom(*cast_mat);
-      return true;
+    this->CopyFrom(*cast_mat);
+    return true;
 
   }
 
 
-    if (const HostMatrixCSR<ValueType> *cast_mat = dynamic_cast<const HostMatrixCSR<ValueType>*> (&mat)) {
+  if (const HostMatrixCSR<ValueType> *cast_mat = dynamic_cast<const HostMatrixCSR<ValueType>*> (&mat)) {
 
-      this->Clear();
-      int nnz = 0;
-
-      // TODO
-     
+    this->Clear();
+    int nnzb = 0;
 
-      //      csr_to_bcsr(cast_mat->get_nnz(), cast_mat->get_nrow(), cast_mat->get_ncol(),
-      //                 cast_mat->mat_, &this->mat_, &nnz);
+    int blockdim = csr_bcsr_blockdim(this->local_backend_.OpenMP_threads,
+                                     cast_mat->get_nnz(), cast_mat->get_nrow(), cast_mat->get_ncol(),
+                                     cast_mat->mat_);
 
-      FATAL_ERROR(__FILE__, __LINE__);
+    csr_to_bcsr(this->local_backend_.OpenMP_threads,
+                cast_mat->get_nnz(), cast_mat->get_nrow(), cast_mat->get_ncol(),
+                cast_mat->mat_, blockdim, &this->mat_, &nnzb);
 
-      this->nrow_ = cast_mat->get_nrow();
-      this->ncol_ = cast_mat->get_ncol();
-      this->nnz_ = nnz;
+    this->nrow_ = cast_mat->get_nrow();
+    this->ncol_ = cast_mat->get_ncol();
+    this->nnz_ = nnzb*blockdim*blockdim;
 
     return true;
 
@@ -207,69 +241,90 @@ bool HostMatrixBCSR<ValueType>::ConvertFrom(const BaseMatrix<ValueType> &mat) {
 
 }
 
-#ifdef SUPPORT_MKL
+// block row times vector with the block dimension known at compile time,
+// the block loops are unrolled and the partial sums stay in registers
+template <typename ValueType, int BLOCKDIM>
+static void bcsr_spmv(const MatrixBCSR<ValueType, int> &mat, const int nrowb,
+                      const ValueType *in, ValueType *out,
+                      const ValueType scalar, const bool add) {
 
-template <>
-void HostMatrixBCSR<double>::Apply(const BaseVector<double> &in, BaseVector<double> *out) const {
+#pragma omp parallel for
+  for (int bi=0; bi<nrowb; ++bi) {
 
-  assert(in.  get_size() >= 0);
-  assert(out->get_size() >= 0);
-  assert(in.  get_size() == this->get_ncol());
-  assert(out->get_size() == this->get_nrow());
+    ValueType sum[BLOCKDIM];
 
-  const HostVector<double> *cast_in = dynamic_cast<const HostVector<double>*> (&in) ; 
-  HostVector<double> *cast_out      = dynamic_cast<      HostVector<double>*> (out) ; 
+    for (int r=0; r<BLOCKDIM; ++r)
+      sum[r] = ValueType(0.0);
 
-  assert(cast_in != NULL);
-  assert(cast_out!= NULL);
- 
-  char transp='N'; 
-  int nrow = this->get_nrow() ;
-  int nnz = this->get_nnz();
+    for (int k=mat.row_offset[bi]; k<mat.row_offset[bi+1]; ++k) {
 
-  // TODO
+      const ValueType *blk = mat.val + k*BLOCKDIM*BLOCKDIM;
+      const ValueType *x = in + mat.col[k]*BLOCKDIM;
 
-  FATAL_ERROR(__FILE__, __LINE__);
+      for (int r=0; r<BLOCKDIM; ++r)
+        for (int c=0; c<BLOCKDIM; ++c)
+          sum[r] += blk[r*BLOCKDIM+c] * x[c];
+
+    }
+
+    if (add) {
+      for (int r=0; r<BLOCKDIM; ++r)
+        out[bi*BLOCKDIM+r] += scalar*sum[r];
+    } else {
+      for (int r=0; r<BLOCKDIM; ++r)
+        out[bi*BLOCKDIM+r] = sum[r];
+    }
+
+  }
 
-  /*
-  mkl_cspblas_ddiagemv(&transp, &nrow, 
-		       this->mat_.val, this->mat_.row, this->mat_.col,
-		       &nnz,
-		       cast_in->vec_, cast_out->vec_);
-  */
 }
 
-template <>
-void HostMatrixBCSR<float>::Apply(const BaseVector<float> &in, BaseVector<float> *out) const {
-  assert(in.  get_size() >= 0);
-  assert(out->get_size() >= 0);
-  assert(in.  get_size() == this->get_ncol());
-  assert(out->get_size() == this->get_nrow());
+template <typename ValueType>
+static void bcsr_spmv_generic(const MatrixBCSR<ValueType, int> &mat, const int nrowb,
+                              const ValueType *in, ValueType *out,
+                              const ValueType scalar, const bool add) {
 
-  const HostVector<float> *cast_in = dynamic_cast<const HostVector<float>*> (&in) ; 
-  HostVector<float> *cast_out      = dynamic_cast<      HostVector<float>*> (out) ; 
+  const int blockdim = mat.blockdim;
 
-  assert(cast_in != NULL);
-  assert(cast_out!= NULL);
+#pragma omp parallel for
+  for (int bi=0; bi<nrowb; ++bi)
+    for (int r=0; r<blockdim; ++r) {
 
-  char transp='N'; 
-  int nrow = this->get_nrow() ;
-  int nnz = this->get_nnz();
+      ValueType sum = ValueType(0.0);
 
-  // TODO
-  
-  FATAL_ERROR(__FILE__, __LINE__);
+      for (int k=mat.row_offset[bi]; k<mat.row_offset[bi+1]; ++k)
+        for (int c=0; c<blockdim; ++c)
+          sum += mat.val[BCSR_IND(k, r, c, blockdim)] * in[mat.col[k]*blockdim+c];
 
-  /*
-  mkl_cspblas_scoogemv(&transp, &nrow,
-		       this->mat_.val, this->mat_.row, this->mat_.col,
-		       &nnz,
-		       cast_in->vec_, cast_out->vec_);
-  */
+      if (add)
+        out[bi*blockdim+r] += scalar*sum;
+      else
+        out[bi*blockdim+r] = sum;
+
+    }
 
 }
 
-#else
+template <typename ValueType>
+static void bcsr_spmv_dispatch(const MatrixBCSR<ValueType, int> &mat, const int nrowb,
+                               const ValueType *in, ValueType *out,
+                               const ValueType scalar, const bool add) {
+
+  switch (mat.blockdim) {
+  case 2:
+    bcsr_spmv<ValueType, 2>(mat, nrowb, in, out, scalar, add);
+    break;
+  case 3:
+    bcsr_spmv<ValueType, 3>(mat, nrowb, in, out, scalar, add);
+    break;
+  case 4:
+    bcsr_spmv<ValueType, 4>(mat, nrowb, in, out, scalar, add);
+    break;
+  default:
+    bcsr_spmv_generic(mat, nrowb, in, out, scalar, add);
+  }
+
+}
 
 template <typename ValueType>
 void HostMatrixBCSR<ValueType>::Apply(const BaseVector<ValueType> &in, BaseVector<ValueType> *out) const {
@@ -281,24 +336,21 @@ void HostMatrixBCSR<ValueType>::Apply(const BaseVector<ValueType> &in, BaseVecto
     assert(in.  get_size() == this->get_ncol());
     assert(out->get_size() == this->get_nrow());
     
-//    const HostVector<ValueType> *cast_in = dynamic_cast<const HostVector<ValueType>*> (&in) ; 
-//    HostVector<ValueType> *cast_out      = dynamic_cast<      HostVector<ValueType>*> (out) ; 
+    const HostVector<ValueType> *cast_in = dynamic_cast<const HostVector<ValueType>*> (&in) ; 
+    HostVector<ValueType> *cast_out      = dynamic_cast<      HostVector<ValueType>*> (out) ; 
     
-//    assert(cast_in != NULL);
-//    assert(cast_out!= NULL);
+    assert(cast_in != NULL);
+    assert(cast_out!= NULL);
     
     omp_set_num_threads(this->local_backend_.OpenMP_threads);  
   
-      // TODO
-
-    FATAL_ERROR(__FILE__, __LINE__);
+    bcsr_spmv_dispatch(this->mat_, this->get_nrow() / this->get_blockdim(),
+                       cast_in->vec_, cast_out->vec_, ValueType(1.0), false);
 
   }
 
 }
 
-#endif
-
 template <typename ValueType>
 void HostMatrixBCSR<ValueType>::ApplyAdd(const BaseVector<ValueType> &in, const ValueType scalar,
                                         BaseVector<ValueType> *out) const {
@@ -310,20 +362,404 @@ void HostMatrixBCSR<ValueType>::ApplyAdd(const BaseVector<ValueType> &in, const
     assert(in.  get_size() == this->get_ncol());
     assert(out->get_size() == this->get_nrow());
 
-//    const HostVector<ValueType> *cast_in = dynamic_cast<const HostVector<ValueType>*> (&in) ; 
-//    HostVector<ValueType> *cast_out      = dynamic_cast<      HostVector<ValueType>*> (out) ; 
+    const HostVector<ValueType> *cast_in = dynamic_cast<const HostVector<ValueType>*> (&in) ; 
+    HostVector<ValueType> *cast_out      = dynamic_cast<      HostVector<ValueType>*> (out) ; 
     
-//    assert(cast_in != NULL);
-//    assert(cast_out!= NULL);
+    assert(cast_in != NULL);
+    assert(cast_out!= NULL);
 
     omp_set_num_threads(this->local_backend_.OpenMP_threads);  
 
-    // TODO
+    bcsr_spmv_dispatch(this->mat_, this->get_nrow() / this->get_blockdim(),
+                       cast_in->vec_, cast_out->vec_, scalar, true);
 
-    FATAL_ERROR(__FILE__, __LINE__);
+  }
+
+}
+
+template <typename ValueType>
+bool HostMatrixBCSR<ValueType>::ExtractDiagonal(BaseVector<ValueType> *vec_diag) const {
+
+  assert(vec_diag != NULL);
+  assert(vec_diag->get_size() == this->get_nrow());
+
+  HostVector<ValueType> *cast_vec_diag  = dynamic_cast<HostVector<ValueType>*> (vec_diag) ; 
+
+  const int blockdim = this->get_blockdim();
+
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);  
+
+#pragma omp parallel for
+  for (int bi=0; bi<this->get_nrow() / blockdim; ++bi)
+    for (int k=this->mat_.row_offset[bi]; k<this->mat_.row_offset[bi+1]; ++k) {
+
+      if (bi == this->mat_.col[k]) {
+
+        for (int r=0; r<blockdim; ++r)
+          cast_vec_diag->vec_[bi*blockdim+r] = this->mat_.val[BCSR_IND(k, r, r, blockdim)];
+        break;
+
+      }
+
+    }
+
+  return true;
+}
+
+template <typename ValueType>
+bool HostMatrixBCSR<ValueType>::ExtractInverseDiagonal(BaseVector<ValueType> *vec_inv_diag) const {
+
+  assert(vec_inv_diag != NULL);
+  assert(vec_inv_diag->get_size() == this->get_nrow());
+
+  HostVector<ValueType> *cast_vec_inv_diag  = dynamic_cast<HostVector<ValueType>*> (vec_inv_diag) ; 
+
+  const int blockdim = this->get_blockdim();
+
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);  
+
+#pragma omp parallel for
+  for (int bi=0; bi<this->get_nrow() / blockdim; ++bi)
+    for (int k=this->mat_.row_offset[bi]; k<this->mat_.row_offset[bi+1]; ++k) {
+
+      if (bi == this->mat_.col[k]) {
+
+        for (int r=0; r<blockdim; ++r)
+          cast_vec_inv_diag->vec_[bi*blockdim+r] = ValueType(1.0) / this->mat_.val[BCSR_IND(k, r, r, blockdim)];
+        break;
+
+      }
+
+    }
+
+  return true;
+}
+
+// invert a dense row-major block in place (Gauss-Jordan with partial pivoting),
+// work holds blockdim*blockdim values
+template <typename ValueType>
+static bool bcsr_block_invert(ValueType *blk, ValueType *work, const int blockdim) {
+
+  for (int i=0; i<blockdim*blockdim; ++i) {
+    work[i] = blk[i];
+    blk[i] = ValueType(0.0);
+  }
+
+  for (int i=0; i<blockdim; ++i)
+    blk[i*blockdim+i] = ValueType(1.0);
+
+  for (int c=0; c<blockdim; ++c) {
+
+    int p = c;
+    for (int r=c+1; r<blockdim; ++r)
+      if (paralution_abs(work[r*blockdim+c]) > paralution_abs(work[p*blockdim+c]))
+        p = r;
+
+    if (work[p*blockdim+c] == ValueType(0.0))
+      return false;
+
+    if (p != c)
+      for (int k=0; k<blockdim; ++k) {
+        ValueType tmp = work[c*blockdim+k]; work[c*blockdim+k] = work[p*blockdim+k]; work[p*blockdim+k] = tmp;
+        tmp = blk[c*blockdim+k]; blk[c*blockdim+k] = blk[p*blockdim+k]; blk[p*blockdim+k] = tmp;
+      }
+
+    const ValueType inv_pivot = ValueType(1.0) / work[c*blockdim+c];
+    for (int k=0; k<blockdim; ++k) {
+      work[c*blockdim+k] *= inv_pivot;
+      blk[c*blockdim+k]  *= inv_pivot;
+    }
+
+    for (int r=0; r<blockdim; ++r)
+      if ((r != c) && (work[r*blockdim+c] != ValueType(0.0))) {
+        const ValueType factor = work[r*blockdim+c];
+        for (int k=0; k<blockdim; ++k) {
+          work[r*blockdim+k] -= factor*work[c*blockdim+k];
+          blk[r*blockdim+k]  -= factor*blk[c*blockdim+k];
+        }
+      }
 
   }
 
+  return true;
+}
+
+// C = A*B for dense row-major blocks
+template <typename ValueType>
+static void bcsr_block_mult(const ValueType *A, const ValueType *B, ValueType *C, const int blockdim) {
+
+  for (int r=0; r<blockdim; ++r)
+    for (int c=0; c<blockdim; ++c) {
+      ValueType sum = ValueType(0.0);
+      for (int k=0; k<blockdim; ++k)
+        sum += A[r*blockdim+k]*B[k*blockdim+c];
+      C[r*blockdim+c] = sum;
+    }
+
+}
+
+// C = C - A*B for dense row-major blocks
+template <typename ValueType>
+static void bcsr_block_mult_sub(const ValueType *A, const ValueType *B, ValueType *C, const int blockdim) {
+
+  for (int r=0; r<blockdim; ++r)
+    for (int c=0; c<blockdim; ++c) {
+      ValueType sum = ValueType(0.0);
+      for (int k=0; k<blockdim; ++k)
+        sum += A[r*blockdim+k]*B[k*blockdim+c];
+      C[r*blockdim+c] -= sum;
+    }
+
+}
+
+template <typename ValueType>
+bool HostMatrixBCSR<ValueType>::ExtractInverseBlockDiagonal(BaseMatrix<ValueType> *mat_inv_diag) const {
+
+  assert(mat_inv_diag != NULL);
+  assert(this->get_nrow() == this->get_ncol());
+
+  HostMatrixBCSR<ValueType> *cast_mat = dynamic_cast<HostMatrixBCSR<ValueType>*> (mat_inv_diag);
+
+  if (cast_mat == NULL)
+    return false;
+
+  const int blockdim = this->get_blockdim();
+  const int nrowb = this->get_nrow() / blockdim;
+
+  cast_mat->AllocateBCSR(nrowb*blockdim*blockdim, this->get_nrow(), this->get_ncol(), blockdim);
+
+  for (int bi=0; bi<nrowb+1; ++bi)
+    cast_mat->mat_.row_offset[bi] = bi;
+
+  bool singular = false;
+
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
+#pragma omp parallel
+  {
+
+    ValueType *work = NULL;
+    allocate_host(blockdim*blockdim, &work);
+
+#pragma omp for reduction(||:singular)
+    for (int bi=0; bi<nrowb; ++bi) {
+
+      bool found = false;
+      cast_mat->mat_.col[bi] = bi;
+
+      for (int k=this->mat_.row_offset[bi]; k<this->mat_.row_offset[bi+1]; ++k)
+        if (bi == this->mat_.col[k]) {
+
+          for (int i=0; i<blockdim*blockdim; ++i)
+            cast_mat->mat_.val[BCSR_IND(bi, 0, i, blockdim)] = this->mat_.val[BCSR_IND(k, 0, i, blockdim)];
+
+          found = bcsr_block_invert(&cast_mat->mat_.val[BCSR_IND(bi, 0, 0, blockdim)], work, blockdim);
+          break;
+
+        }
+
+      if (found == false)
+        singular = true;
+
+    }
+
+    free_host(&work);
+
+  }
+
+  return (singular == false);
+}
+
+// Block ILU(0), the same IKJ variant as the CSR factorization (Y. Saad,
+// Iterative methods for sparse linear systems, 2nd edition, SIAM) with
+// dense blocks as entries. The strictly lower blocks hold L (unit block
+// diagonal), the upper blocks U and the diagonal blocks the inverse of
+// the U diagonal, so LUSolve needs no divisions.
+template <typename ValueType>
+bool HostMatrixBCSR<ValueType>::ILU0Factorize(void) {
+
+  assert(this->get_nrow() == this->get_ncol());
+  assert(this->get_nnz() > 0);
+
+  const int blockdim = this->get_blockdim();
+  const int bsize = blockdim*blockdim;
+  const int nrowb = this->get_nrow() / blockdim;
+
+  // position of the diagonal block of each block row
+  int *diag_offset = NULL;
+  int *nnz_entries = NULL;
+  ValueType *work = NULL;
+  ValueType *factor = NULL;
+
+  allocate_host(nrowb, &diag_offset);
+  allocate_host(nrowb, &nnz_entries);
+  allocate_host(bsize, &work);
+  allocate_host(bsize, &factor);
+
+  for (int i=0; i<nrowb; ++i)
+    nnz_entries[i] = -1;
+
+  bool singular = false;
+
+  for (int bi=0; bi<nrowb; ++bi) {
+
+    const int row_start = this->mat_.row_offset[bi];
+    const int row_end   = this->mat_.row_offset[bi+1];
+
+    for (int j=row_start; j<row_end; ++j)
+      nnz_entries[this->mat_.col[j]] = j;
+
+    diag_offset[bi] = -1;
+
+    // block columns are sorted, the lower blocks come first
+    for (int j=row_start; j<row_end; ++j) {
+
+      const int bk = this->mat_.col[j];
+
+      if (bk < bi) {
+
+        // L_ik = A_ik * inv(U_kk)
+        bcsr_block_mult(&this->mat_.val[j*bsize], &this->mat_.val[diag_offset[bk]*bsize], factor, blockdim);
+
+        for (int i=0; i<bsize; ++i)
+          this->mat_.val[j*bsize+i] = factor[i];
+
+        // A_ij = A_ij - L_ik * U_kj for the blocks present in the pattern
+        for (int k=diag_offset[bk]+1; k<this->mat_.row_offset[bk+1]; ++k)
+          if (nnz_entries[this->mat_.col[k]] != -1)
+            bcsr_block_mult_sub(factor, &this->mat_.val[k*bsize],
+                                &this->mat_.val[nnz_entries[this->mat_.col[k]]*bsize], blockdim);
+
+      } else {
+
+        if (bk == bi)
+          diag_offset[bi] = j;
+
+        break;
+
+      }
+
+    }
+
+    if ((diag_offset[bi] == -1) ||
+        (bcsr_block_invert(&this->mat_.val[diag_offset[bi]*bsize], work, blockdim) == false))
+      singular = true;
+
+    for (int j=row_start; j<row_end; ++j)
+      nnz_entries[this->mat_.col[j]] = -1;
+
+    if (singular == true)
+      break;
+
+  }
+
+  free_host(&diag_offset);
+  free_host(&nnz_entries);
+  free_host(&work);
+  free_host(&factor);
+
+  return (singular == false);
+}
+
+template <typename ValueType>
+void HostMatrixBCSR<ValueType>::LUAnalyse(void) {
+  // the block substitution is sequential, nothing to analyse
+}
+
+template <typename ValueType>
+void HostMatrixBCSR<ValueType>::LUAnalyseClear(void) {
+  // the block substitution is sequential, nothing to analyse
+}
+
+template <typename ValueType>
+bool HostMatrixBCSR<ValueType>::LUSolve(const BaseVector<ValueType> &in, BaseVector<ValueType> *out) const {
+
+  assert(in.  get_size() >= 0);
+  assert(out->get_size() >= 0);
+  assert(in.  get_size() == this->get_ncol());
+  assert(out->get_size() == this->get_nrow());
+
+  const HostVector<ValueType> *cast_in = dynamic_cast<const HostVector<ValueType>*> (&in) ;
+  HostVector<ValueType> *cast_out      = dynamic_cast<      HostVector<ValueType>*> (out) ;
+
+  assert(cast_in != NULL);
+  assert(cast_out!= NULL);
+
+  const int blockdim = this->get_blockdim();
+  const int bsize = blockdim*blockdim;
+  const int nrowb = this->get_nrow() / blockdim;
+
+  ValueType *sum = NULL;
+  allocate_host(blockdim, &sum);
+
+  // forward substitution with the unit block lower part
+  for (int bi=0; bi<nrowb; ++bi) {
+
+    for (int r=0; r<blockdim; ++r)
+      sum[r] = cast_in->vec_[bi*blockdim+r];
+
+    for (int j=this->mat_.row_offset[bi]; (j<this->mat_.row_offset[bi+1]) && (this->mat_.col[j] < bi); ++j) {
+
+      const int bj = this->mat_.col[j];
+
+      for (int r=0; r<blockdim; ++r)
+        for (int c=0; c<blockdim; ++c)
+          sum[r] -= this->mat_.val[j*bsize+r*blockdim+c] * cast_out->vec_[bj*blockdim+c];
+
+    }
+
+    for (int r=0; r<blockdim; ++r)
+      cast_out->vec_[bi*blockdim+r] = sum[r];
+
+  }
+
+  // backward substitution, the diagonal blocks are already inverted
+  for (int bi=nrowb-1; bi>=0; --bi) {
+
+    int diag = -1;
+
+    for (int r=0; r<blockdim; ++r)
+      sum[r] = cast_out->vec_[bi*blockdim+r];
+
+    for (int j=this->mat_.row_offset[bi+1]-1; j>=this->mat_.row_offset[bi]; --j) {
+
+      const int bj = this->mat_.col[j];
+
+      if (bj > bi) {
+
+        for (int r=0; r<blockdim; ++r)
+          for (int c=0; c<blockdim; ++c)
+            sum[r] -= this->mat_.val[j*bsize+r*blockdim+c] * cast_out->vec_[bj*blockdim+c];
+
+      } else {
+
+        if (bj == bi)
+          diag = j;
+
+        break;
+
+      }
+
+    }
+
+    assert(diag != -1);
+
+    for (int r=0; r<blockdim; ++r) {
+
+      ValueType value = ValueType(0.0);
+
+      for (int c=0; c<blockdim; ++c)
+        value += this->mat_.val[diag*bsize+r*blockdim+c] * sum[c];
+
+      cast_out->vec_[bi*blockdim+r] = value;
+
+    }
+
+  }
+
+  free_host(&sum);
+
+  return true;
 }
 
 template class HostMatrixBCSR<double>;
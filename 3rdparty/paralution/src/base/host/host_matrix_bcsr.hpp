@@ -37,14 +37,26 @@ public:
   HostMatrixBCSR(const Paralution_Backend_Descriptor local_backend);
   virtual ~HostMatrixBCSR();
 
+  inline int get_blockdim(void) const { return mat_.blockdim; }
+
   virtual void info(void) const;
   virtual unsigned int get_mat_format(void) const { return  BCSR; }
 
   virtual void Clear(void);
-  virtual void AllocateBCSR(const int nnz, const int nrow, const int ncol);
+  virtual void AllocateBCSR(const int nnz, const int nrow, const int ncol, const int blockdim);
 
   virtual bool ConvertFrom(const BaseMatrix<ValueType> &mat);
 
+  virtual bool ExtractDiagonal(BaseVector<ValueType> *vec_diag) const;
+  virtual bool ExtractInverseDiagonal(BaseVector<ValueType> *vec_inv_diag) const;
+  virtual bool ExtractInverseBlockDiagonal(BaseMatrix<ValueType> *mat_inv_diag) const;
+
+  virtual bool ILU0Factorize(void);
+
+  virtual void LUAnalyse(void);
+  virtual void LUAnalyseClear(void);
+  virtual bool LUSolve(const BaseVector<ValueType> &in, BaseVector<ValueType> *out) const;
+
   virtual void CopyFrom(const BaseMatrix<ValueType> &mat);
   virtual void CopyTo(BaseMatrix<ValueType> *mat) const;
 
@@ -80,6 +80,14 @@ HostMatrixCSR<ValueType>::HostMatrixCSR(const Paralution_Backend_Descriptor loca
 
   this->L_diag_unit_ = true;
   this->U_diag_unit_ = false;
+
+  this->L_nlevels_      = 0;
+  this->L_level_offset_ = NULL;
+  this->L_level_rows_   = NULL;
+
+  this->U_nlevels_      = 0;
+  this->U_level_offset_ = NULL;
+  this->U_level_rows_   = NULL;
  
 }
 
@@ -93,6 +101,9 @@ HostMatrixCSR<ValueType>::~HostMatrixCSR() {
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::Clear() {
 
+  // the level scheduling is valid only for the current structure
+  this->LUAnalyseClear();
+
   if (this->get_nnz() > 0) {
 
     free_host(&this->mat_.row_offset);
@@ -192,6 +203,9 @@ void HostMatrixCSR<ValueType>::LeaveDataPtrCSR(int **row_offset, int **col, Valu
   assert(this->get_ncol() > 0);
   assert(this->get_nnz() > 0);
 
+  // the level scheduling is valid only for the current structure
+  this->LUAnalyseClear();
+
   // see free_host function for details
   *row_offset = this->mat_.row_offset;
   *col = this->mat_.col;
@@ -214,6 +228,9 @@ void HostMatrixCSR<ValueType>::CopyFromCSR(const int *row_offsets, const int *co
   assert(this->get_nrow() > 0);
   assert(this->get_ncol() > 0);
 
+  // the level scheduling is valid only for the current structure
+  this->LUAnalyseClear();
+
   omp_set_num_threads(this->local_backend_.OpenMP_threads);  
 
 #pragma omp parallel for      
@@ -263,6 +280,10 @@ void HostMatrixCSR<ValueType>::CopyFrom(const BaseMatrix<ValueType> &mat) {
     assert((this->get_nnz()  == mat.get_nnz())  &&
            (this->get_nrow() == mat.get_nrow()) &&
            (this->get_ncol() == mat.get_ncol()) );
+
+    // the level scheduling is valid only for the current structure,
+    // the same nnz does not mean the same sparsity pattern
+    this->LUAnalyseClear();
         
     if (this->get_nnz() > 0) {
 
@@ -446,6 +467,23 @@ bool HostMatrixCSR<ValueType>::ConvertFrom(const BaseMatrix<ValueType> &mat) {
 
   }
 
+  if (const HostMatrixBCSR<ValueType> *cast_mat = dynamic_cast<const HostMatrixBCSR<ValueType>*> (&mat)) {
+
+    this->Clear();
+    int nnz;
+
+    bcsr_to_csr(this->local_backend_.OpenMP_threads,
+                cast_mat->get_nnz(), cast_mat->get_nrow(), cast_mat->get_ncol(), 
+                cast_mat->mat_, &this->mat_, &nnz);
+
+    this->nrow_ = cast_mat->get_nrow();
+    this->ncol_ = cast_mat->get_ncol();
+    this->nnz_  = nnz ;
+
+    return true;
+
+  }
+
   if (const HostMatrixHYB<ValueType> *cast_mat = dynamic_cast<const HostMatrixHYB<ValueType>*> (&mat)) {
 
     this->Clear();
@@ -883,6 +921,116 @@ bool HostMatrixCSR<ValueType>::ExtractLDiagonal(BaseMatrix<ValueType> *L) const
 
 }
 
+// Level scheduling of the triangular solves: the level of a row is one more
+// than the highest level of the rows it depends on (off-diagonal entries of
+// the lower resp. upper part), rows of one level are solved in parallel
+template <typename ValueType>
+static void csr_tri_levels(const MatrixCSR<ValueType, int> &mat, const int nrow, const bool lower,
+                           int *nlevels, int **level_offset, int **level_rows) {
+
+  int *level = NULL;
+  allocate_host(nrow, &level);
+
+  *nlevels = 0;
+
+  for (int k=0; k<nrow; ++k) {
+
+    const int ai = lower ? k : nrow-1-k;
+    int lev = 0;
+
+    for (int aj=mat.row_offset[ai]; aj<mat.row_offset[ai+1]; ++aj) {
+
+      const int col = mat.col[aj];
+
+      if ((lower && (col < ai)) || (!lower && (col > ai)))
+        lev = std::max(lev, level[col]+1);
+
+    }
+
+    level[ai] = lev;
+    *nlevels = std::max(*nlevels, lev+1);
+
+  }
+
+  allocate_host(*nlevels+1, level_offset);
+  allocate_host(nrow, level_rows);
+  set_to_zero_host(*nlevels+1, *level_offset);
+
+  for (int ai=0; ai<nrow; ++ai)
+    (*level_offset)[level[ai]+1] += 1;
+
+  for (int lev=0; lev<*nlevels; ++lev)
+    (*level_offset)[lev+1] += (*level_offset)[lev];
+
+  // rows of a level in ascending order
+  int *pos = NULL;
+  allocate_host(*nlevels, &pos);
+
+  for (int lev=0; lev<*nlevels; ++lev)
+    pos[lev] = (*level_offset)[lev];
+
+  for (int ai=0; ai<nrow; ++ai)
+    (*level_rows)[pos[level[ai]]++] = ai;
+
+  free_host(&pos);
+  free_host(&level);
+
+}
+
+static void csr_tri_levels_clear(int *nlevels, int **level_offset, int **level_rows) {
+
+  if (*nlevels > 0) {
+
+    free_host(level_offset);
+    free_host(level_rows);
+    *nlevels = 0;
+
+  }
+
+}
+
+// one barrier per level - narrow levels (banded or badly ordered matrices)
+// are faster in the sequential sweep
+static inline bool csr_tri_levels_parallel(const int nrow, const int nlevels, const int omp_threads) {
+
+  return (nlevels > 0) && (omp_threads > 1) && (nrow >= 32*nlevels);
+
+}
+
+template <typename ValueType>
+static void csr_tri_solve_levels(const MatrixCSR<ValueType, int> &mat, const bool lower, const bool diag_unit,
+                                 const int nlevels, const int *level_offset, const int *level_rows,
+                                 const ValueType *in, ValueType *out) {
+
+#pragma omp parallel
+  for (int lev=0; lev<nlevels; ++lev) {
+
+#pragma omp for schedule(static)
+    for (int k=level_offset[lev]; k<level_offset[lev+1]; ++k) {
+
+      const int ai = level_rows[k];
+      ValueType sum  = in[ai];
+      ValueType diag = ValueType(1.0);
+
+      for (int aj=mat.row_offset[ai]; aj<mat.row_offset[ai+1]; ++aj) {
+
+        const int col = mat.col[aj];
+
+        if ((lower && (col < ai)) || (!lower && (col > ai)))
+          sum -= mat.val[aj] * out[col];
+        else if (col == ai)
+          diag = mat.val[aj];
+
+      }
+
+      out[ai] = diag_unit ? sum : sum / diag;
+
+    }
+
+  }
+
+}
+
 #ifdef SUPPORT_MKL
 
 template <>
@@ -947,6 +1095,25 @@ bool HostMatrixCSR<ValueType>::LUSolve(const BaseVector<ValueType> &in, BaseVect
   assert(cast_in != NULL);
   assert(cast_out!= NULL);
 
+  if (csr_tri_levels_parallel(this->get_nrow(), std::min(this->L_nlevels_, this->U_nlevels_),
+                              this->local_backend_.OpenMP_threads)) {
+
+    omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
+    // L has unit diagonal
+    csr_tri_solve_levels(this->mat_, true, true,
+                         this->L_nlevels_, this->L_level_offset_, this->L_level_rows_,
+                         cast_in->vec_, cast_out->vec_);
+
+    // in-place backward substitution, each row reads only rows of lower levels
+    csr_tri_solve_levels(this->mat_, false, false,
+                         this->U_nlevels_, this->U_level_offset_, this->U_level_rows_,
+                         cast_out->vec_, cast_out->vec_);
+
+    return true;
+
+  }
+
   // Solve L
   for (int ai=0; ai<this->get_nrow(); ++ai) {
 
@@ -992,22 +1159,40 @@ bool HostMatrixCSR<ValueType>::LUSolve(const BaseVector<ValueType> &in, BaseVect
 
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::LLAnalyse(void) {
-  // do nothing
+
+  this->LUAnalyse();
+
 }
 
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::LLAnalyseClear(void) {
-  // do nothing
+
+  this->LUAnalyseClear();
+
 }
 
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::LUAnalyse(void) {
-  // do nothing
+
+  this->LUAnalyseClear();
+
+  if (this->get_nnz() > 0) {
+
+    csr_tri_levels(this->mat_, this->get_nrow(), true,
+                   &this->L_nlevels_, &this->L_level_offset_, &this->L_level_rows_);
+    csr_tri_levels(this->mat_, this->get_nrow(), false,
+                   &this->U_nlevels_, &this->U_level_offset_, &this->U_level_rows_);
+
+  }
+
 }
 
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::LUAnalyseClear(void) {
-  // do nothing
+
+  csr_tri_levels_clear(&this->L_nlevels_, &this->L_level_offset_, &this->L_level_rows_);
+  csr_tri_levels_clear(&this->U_nlevels_, &this->U_level_offset_, &this->U_level_rows_);
+
 }
  
 
@@ -1024,6 +1209,24 @@ bool HostMatrixCSR<ValueType>::LLSolve(const BaseVector<ValueType> &in, BaseVect
 
   assert(cast_in != NULL);
   assert(cast_out!= NULL);
+
+  if (csr_tri_levels_parallel(this->get_nrow(), std::min(this->L_nlevels_, this->U_nlevels_),
+                              this->local_backend_.OpenMP_threads)) {
+
+    omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
+    csr_tri_solve_levels(this->mat_, true, false,
+                         this->L_nlevels_, this->L_level_offset_, this->L_level_rows_,
+                         cast_in->vec_, cast_out->vec_);
+
+    csr_tri_solve_levels(this->mat_, false, false,
+                         this->U_nlevels_, this->U_level_offset_, this->U_level_rows_,
+                         cast_out->vec_, cast_out->vec_);
+
+    return true;
+
+  }
+
   int diag_aj = 0 ;
 
   // Solve L
@@ -1076,12 +1279,20 @@ void HostMatrixCSR<ValueType>::LAnalyse(const bool diag_unit) {
 
   this->L_diag_unit_ = diag_unit;
 
+  csr_tri_levels_clear(&this->L_nlevels_, &this->L_level_offset_, &this->L_level_rows_);
+
+  if (this->get_nnz() > 0)
+    csr_tri_levels(this->mat_, this->get_nrow(), true,
+                   &this->L_nlevels_, &this->L_level_offset_, &this->L_level_rows_);
+
 }
 
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::LAnalyseClear(void) {
-  // do nothing
+
+  csr_tri_levels_clear(&this->L_nlevels_, &this->L_level_offset_, &this->L_level_rows_);
   this->L_diag_unit_ = true;
+
 }
 
 // TODO - make mkl interface
@@ -1099,6 +1310,19 @@ bool HostMatrixCSR<ValueType>::LSolve(const BaseVector<ValueType> &in, BaseVecto
   assert(cast_in != NULL);
   assert(cast_out!= NULL);
 
+  if (csr_tri_levels_parallel(this->get_nrow(), this->L_nlevels_,
+                              this->local_backend_.OpenMP_threads)) {
+
+    omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
+    csr_tri_solve_levels(this->mat_, true, this->L_diag_unit_,
+                         this->L_nlevels_, this->L_level_offset_, this->L_level_rows_,
+                         cast_in->vec_, cast_out->vec_);
+
+    return true;
+
+  }
+
   int diag_aj = 0;
 
   // Solve L
@@ -1135,12 +1359,20 @@ void HostMatrixCSR<ValueType>::UAnalyse(const bool diag_unit) {
 
   this->U_diag_unit_ = diag_unit;
 
+  csr_tri_levels_clear(&this->U_nlevels_, &this->U_level_offset_, &this->U_level_rows_);
+
+  if (this->get_nnz() > 0)
+    csr_tri_levels(this->mat_, this->get_nrow(), false,
+                   &this->U_nlevels_, &this->U_level_offset_, &this->U_level_rows_);
+
 }
 
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::UAnalyseClear(void) {
-  // do nothing
+
+  csr_tri_levels_clear(&this->U_nlevels_, &this->U_level_offset_, &this->U_level_rows_);
   this->U_diag_unit_ = false;
+
 }
 
 // TODO - make mkl interface
@@ -1158,6 +1390,19 @@ bool HostMatrixCSR<ValueType>::USolve(const BaseVector<ValueType> &in, BaseVecto
   assert(cast_in != NULL);
   assert(cast_out!= NULL);
 
+  if (csr_tri_levels_parallel(this->get_nrow(), this->U_nlevels_,
+                              this->local_backend_.OpenMP_threads)) {
+
+    omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
+    csr_tri_solve_levels(this->mat_, false, this->U_diag_unit_,
+                         this->U_nlevels_, this->U_level_offset_, this->U_level_rows_,
+                         cast_in->vec_, cast_out->vec_);
+
+    return true;
+
+  }
+
   // last elements should the diagonal one (last)
   int diag_aj = this->get_nnz()-1;
 
@@ -1173,13 +1418,13 @@ bool HostMatrixCSR<ValueType>::USolve(const BaseVector<ValueType> &in, BaseVecto
         cast_out->vec_[ai] -= this->mat_.val[aj] * cast_out->vec_[ this->mat_.col[aj] ];
       } 
 
-      if (this->L_diag_unit_ == false)      
+      if (this->U_diag_unit_ == false)      
         if (this->mat_.col[aj] == ai) {
           diag_aj = aj;
         }
     }
 
-    if (this->L_diag_unit_ == false) 
+    if (this->U_diag_unit_ == false) 
     cast_out->vec_[ai] /= this->mat_.val[diag_aj];
   }
 
@@ -1850,6 +2095,31 @@ void HostMatrixCSR<ValueType>::SymbolicMatMatMult(const BaseMatrix<ValueType> &s
 
 }
 
+// Sort the columns (and values) of rows [row_begin, row_end) in ascending
+// order; insertion sort, the rows produced by the products are short
+template <typename ValueType>
+static void csr_sort_rows(const int *row_offset, int *col, ValueType *val,
+                          const int row_begin, const int row_end) {
+
+  for (int i=row_begin; i<row_end; ++i)
+    for (int j=row_offset[i]+1; j<row_offset[i+1]; ++j) {
+
+      const int ind = col[j];
+      const ValueType v = val[j];
+
+      int jj = j - 1;
+      for (; (jj >= row_offset[i]) && (col[jj] > ind); --jj) {
+        col[jj+1] = col[jj];
+        val[jj+1] = val[jj];
+      }
+
+      col[jj+1] = ind;
+      val[jj+1] = v;
+
+    }
+
+}
+
 // ----------------------------------------------------------
 // original function prod(const spmat1 &A, const spmat2 &B)
 // ----------------------------------------------------------
@@ -1860,6 +2130,7 @@ void HostMatrixCSR<ValueType>::SymbolicMatMatMult(const BaseMatrix<ValueType> &s
 // CHANGELOG
 // - adopted interface
 // sorting is added
+// - rows are sorted by the owning thread (insertion sort)
 // ----------------------------------------------------------
 template <typename ValueType>
 bool HostMatrixCSR<ValueType>::MatMatMult(const BaseMatrix<ValueType> &A, const BaseMatrix<ValueType> &B) {
@@ -1889,6 +2160,8 @@ bool HostMatrixCSR<ValueType>::MatMatMult(const BaseMatrix<ValueType> &A, const
   for (int i=0; i<n+1; ++i)
     row_offset[i] = 0;
 
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
 #pragma omp parallel
   {
     std::vector<int> marker(m, -1);
@@ -1954,31 +2227,168 @@ bool HostMatrixCSR<ValueType>::MatMatMult(const BaseMatrix<ValueType> &A, const
         }
       }
     }
+
+    // Sorting the col (per row)
+    csr_sort_rows(row_offset, col, val, chunk_start, chunk_end);
   }
 
 
   this->SetDataPtrCSR(&row_offset, &col, &val, row_offset[n], cast_mat_A->get_nrow(), cast_mat_B->get_ncol());
 
-  // Sorting the col (per row)
-  // Bubble sort algorithm
+  return true;
 
- #pragma omp parallel for      
-  for (int i=0; i<this->get_nrow(); ++i)
-    for (int j=this->mat_.row_offset[i]; j<this->mat_.row_offset[i+1]; ++j)
-      for (int jj=this->mat_.row_offset[i]; jj<this->mat_.row_offset[i+1]-1; ++jj)
-        if (this->mat_.col[jj] > this->mat_.col[jj+1]) {
-          //swap elements
+}
+
+// Row-wise Galerkin product without forming R*A as a matrix: a row of R*A
+// is accumulated in a per-thread work row (over the columns of A) and is
+// then multiplied by P (over the columns of P)
+template <typename ValueType>
+bool HostMatrixCSR<ValueType>::TripleMatrixProduct(const BaseMatrix<ValueType> &R,
+                                                   const BaseMatrix<ValueType> &A,
+                                                   const BaseMatrix<ValueType> &P) {
+
+  assert((this != &R) && (this != &A) && (this != &P));
+  assert(R.get_ncol() == A.get_nrow());
+  assert(A.get_ncol() == P.get_nrow());
+
+  const HostMatrixCSR<ValueType> *cast_mat_R = dynamic_cast<const HostMatrixCSR<ValueType>*> (&R);
+  const HostMatrixCSR<ValueType> *cast_mat_A = dynamic_cast<const HostMatrixCSR<ValueType>*> (&A);
+  const HostMatrixCSR<ValueType> *cast_mat_P = dynamic_cast<const HostMatrixCSR<ValueType>*> (&P);
+
+  if ((cast_mat_R == NULL) || (cast_mat_A == NULL) || (cast_mat_P == NULL))
+    return false;
+
+  const int n  = cast_mat_R->get_nrow();
+  const int na = cast_mat_A->get_ncol();
+  const int m  = cast_mat_P->get_ncol();
+
+  int *row_offset = NULL;
+  allocate_host(n+1, &row_offset);
+  int *col = NULL;
+  ValueType *val = NULL;
+
+  for (int i=0; i<n+1; ++i)
+    row_offset[i] = 0;
+
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);
 
-          int ind = this->mat_.col[jj];
-          ValueType val = this->mat_.val[jj];
+#pragma omp parallel
+  {
+    std::vector<int> marker_ra(na, -1);
+    std::vector<int> marker(m, -1);
+
+    std::vector<int> col_ra;
+    std::vector<ValueType> val_ra(na, ValueType(0.0));
+
+#ifdef _OPENMP
+    int nt  = omp_get_num_threads();
+    int tid = omp_get_thread_num();
+
+    int chunk_size  = (n + nt - 1) / nt;
+    int chunk_start = std::min(n, tid * chunk_size);
+    int chunk_end   = std::min(n, chunk_start + chunk_size);
+#else
+    int chunk_start = 0;
+    int chunk_end   = n;
+#endif
+
+    // Structure
+    for (int ir=chunk_start; ir<chunk_end; ++ir) {
+
+      col_ra.clear();
+
+      for (int jr=cast_mat_R->mat_.row_offset[ir]; jr<cast_mat_R->mat_.row_offset[ir+1]; ++jr) {
+        int cr = cast_mat_R->mat_.col[jr];
+
+        for (int ja=cast_mat_A->mat_.row_offset[cr]; ja<cast_mat_A->mat_.row_offset[cr+1]; ++ja) {
+          int ca = cast_mat_A->mat_.col[ja];
+
+          if (marker_ra[ca] != ir) {
+            marker_ra[ca] = ir;
+            col_ra.push_back(ca);
+          }
+        }
+      }
+
+      for (size_t k=0; k<col_ra.size(); ++k) {
+        int ca = col_ra[k];
+
+        for (int jp=cast_mat_P->mat_.row_offset[ca]; jp<cast_mat_P->mat_.row_offset[ca+1]; ++jp) {
+          int cp = cast_mat_P->mat_.col[jp];
+
+          if (marker[cp] != ir) {
+            marker[cp] = ir;
+            ++row_offset[ir+1];
+          }
+        }
+      }
+
+    }
+
+    std::fill(marker_ra.begin(), marker_ra.end(), -1);
+    std::fill(marker.begin(), marker.end(), -1);
+
+#pragma omp barrier
+#pragma omp single
+    {
+      for (int i=1; i<n+1; ++i)
+        row_offset[i] += row_offset[i-1];
+
+      allocate_host(row_offset[n], &col);
+      allocate_host(row_offset[n], &val);
+    }
 
-          this->mat_.col[jj] = this->mat_.col[jj+1];
-          this->mat_.val[jj] = this->mat_.val[jj+1];          
+    // Values
+    for (int ir=chunk_start; ir<chunk_end; ++ir) {
 
-          this->mat_.col[jj+1] = ind;
-          this->mat_.val[jj+1] = val;
+      col_ra.clear();
+
+      for (int jr=cast_mat_R->mat_.row_offset[ir]; jr<cast_mat_R->mat_.row_offset[ir+1]; ++jr) {
+        int cr = cast_mat_R->mat_.col[jr];
+        ValueType vr = cast_mat_R->mat_.val[jr];
+
+        for (int ja=cast_mat_A->mat_.row_offset[cr]; ja<cast_mat_A->mat_.row_offset[cr+1]; ++ja) {
+          int ca = cast_mat_A->mat_.col[ja];
+
+          if (marker_ra[ca] != ir) {
+            marker_ra[ca] = ir;
+            col_ra.push_back(ca);
+            val_ra[ca] = vr * cast_mat_A->mat_.val[ja];
+          } else {
+            val_ra[ca] += vr * cast_mat_A->mat_.val[ja];
+          }
+        }
+      }
+
+      int row_begin = row_offset[ir];
+      int row_end   = row_begin;
+
+      for (size_t k=0; k<col_ra.size(); ++k) {
+        int ca = col_ra[k];
+        ValueType va = val_ra[ca];
+
+        for (int jp=cast_mat_P->mat_.row_offset[ca]; jp<cast_mat_P->mat_.row_offset[ca+1]; ++jp) {
+          int cp = cast_mat_P->mat_.col[jp];
+          ValueType vp = cast_mat_P->mat_.val[jp];
+
+          if (marker[cp] < row_begin) {
+            marker[cp] = row_end;
+            col[row_end] = cp;
+            val[row_end] = va * vp;
+            ++row_end;
+          } else {
+            val[marker[cp]] += va * vp;
+          }
         }
+      }
+
+    }
+
+    csr_sort_rows(row_offset, col, val, chunk_start, chunk_end);
+  }
 
+  this->Clear();
+  this->SetDataPtrCSR(&row_offset, &col, &val, row_offset[n], n, m);
 
   return true;
 
@@ -2625,6 +3035,9 @@ bool HostMatrixCSR<ValueType>::Compress(const ValueType drop_off) {
 
 }
 
+// Each thread counts the columns of its chunk of rows, the per-thread
+// counts give every thread its own insertion position in each row of the
+// transpose, the entries keep the order of the sequential algorithm
 template <typename ValueType>
 bool HostMatrixCSR<ValueType>::Transpose(void) {
 
@@ -2637,35 +3050,73 @@ bool HostMatrixCSR<ValueType>::Transpose(void) {
     this->Clear();
     this->AllocateCSR(tmp.get_nnz(), tmp.get_ncol(), tmp.get_nrow());
 
-    for (int i=0; i<this->get_nnz(); ++i)
-      this->mat_.row_offset[ tmp.mat_.col[i]+1 ] += 1;
+    const int nrow = this->get_nrow();
+    const int ncol = this->get_ncol();
 
-    for (int i=0; i<this->get_nrow(); ++i)
-      this->mat_.row_offset[i+1] += this->mat_.row_offset[i];
+    std::vector<int> count;
+
+    omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
+#pragma omp parallel
+    {
+
+#ifdef _OPENMP
+      int nt  = omp_get_num_threads();
+      int tid = omp_get_thread_num();
+
+      int chunk_size  = (ncol + nt - 1) / nt;
+      int chunk_start = std::min(ncol, tid * chunk_size);
+      int chunk_end   = std::min(ncol, chunk_start + chunk_size);
+#else
+      int nt  = 1;
+      int tid = 0;
 
-    for (int ai=0; ai<this->get_ncol(); ++ai)  
-      for (int aj=tmp.mat_.row_offset[ai]; aj<tmp.mat_.row_offset[ai+1]; ++aj) {
+      int chunk_start = 0;
+      int chunk_end   = ncol;
+#endif
 
-        const int ind_col = tmp.mat_.col[aj];
-        const int ind = this->mat_.row_offset[ ind_col ];
+#pragma omp single
+      count.assign(size_t(nt) * nrow, 0);
 
-        this->mat_.col[ind] = ai;
-        this->mat_.val[ind] = tmp.mat_.val[aj];        
+      int *count_tid = &count[size_t(tid) * nrow];
 
-        this->mat_.row_offset[ ind_col ] += 1;
+      for (int aj=tmp.mat_.row_offset[chunk_start]; aj<tmp.mat_.row_offset[chunk_end]; ++aj)
+        ++count_tid[ tmp.mat_.col[aj] ];
 
+#pragma omp barrier
+#pragma omp for
+      for (int i=0; i<nrow; ++i) {
+        int sum = 0;
+        for (int t=0; t<nt; ++t) {
+          int c = count[size_t(t) * nrow + i];
+          count[size_t(t) * nrow + i] = sum;
+          sum += c;
+        }
+        this->mat_.row_offset[i+1] = sum;
       }
-    
-    int shift = 0 ;
-    for (int i=0; i<this->get_nrow(); ++i) {
-      int tmp = this->mat_.row_offset[i] ;
-      this->mat_.row_offset[i] = shift ;
-      shift = tmp;
+
+#pragma omp single
+      for (int i=0; i<nrow; ++i)
+        this->mat_.row_offset[i+1] += this->mat_.row_offset[i];
+
+#pragma omp for
+      for (int i=0; i<nrow; ++i)
+        for (int t=0; t<nt; ++t)
+          count[size_t(t) * nrow + i] += this->mat_.row_offset[i];
+
+      for (int ai=chunk_start; ai<chunk_end; ++ai)
+        for (int aj=tmp.mat_.row_offset[ai]; aj<tmp.mat_.row_offset[ai+1]; ++aj) {
+
+          const int ind = count_tid[ tmp.mat_.col[aj] ]++;
+
+          this->mat_.col[ind] = ai;
+          this->mat_.val[ind] = tmp.mat_.val[aj];
+
+        }
+
     }
-    
-    this->mat_.row_offset[this->get_nrow()] = shift ;
-    
-    assert(tmp.get_nnz() == shift);
+
+    assert(tmp.get_nnz() == this->mat_.row_offset[nrow]);
   }
 
   return true;
@@ -2885,6 +3336,10 @@ void HostMatrixCSR<ValueType>::AMGConnect(const ValueType eps, BaseVector<int> *
 // ----------------------------------------------------------
 // CHANGELOG
 // - adopted interface
+// - the sequential greedy sweep is replaced by a parallel
+//   distance-2 maximal independent set (the roots of the
+//   aggregates) computed in synchronous rounds, the result
+//   does not depend on the number of threads
 // ----------------------------------------------------------
 template <typename ValueType>
 void HostMatrixCSR<ValueType>::AMGAggregate(const BaseVector<int> &connections, BaseVector<int> *aggregates) const {
@@ -2901,19 +3356,19 @@ void HostMatrixCSR<ValueType>::AMGAggregate(const BaseVector<int> &connections,
   aggregates->Clear();
   aggregates->Allocate(this->get_nrow());
 
+  const int nrow = this->get_nrow();
+
   const int undefined = -1;
   const int removed   = -2;
 
-  // Remove nodes without neighbours
-  int max_neib = 0;
-  for (int i=0; i<this->get_nrow(); ++i) {
-    int j = this->mat_.row_offset[i];
-    int e = this->mat_.row_offset[i+1];
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);
 
-    max_neib = std::max(e - j, max_neib);
+  // Remove nodes without neighbours
+#pragma omp parallel for
+  for (int i=0; i<nrow; ++i) {
 
     int state = removed;
-    for (; j<e; ++j) {
+    for (int j=this->mat_.row_offset[i]; j<this->mat_.row_offset[i+1]; ++j) {
       if (cast_conn->vec_[j]) {
         state = undefined;
         break;
@@ -2924,41 +3379,139 @@ void HostMatrixCSR<ValueType>::AMGAggregate(const BaseVector<int> &connections,
 
   }
 
-  std::vector<int> neib;
-  neib.reserve(max_neib);
+  // The state of a node is packed with a pseudo-random priority and the node
+  // index into one key (state | priority | index), the maximum over the
+  // distance-2 neighbourhood decides if an undecided node becomes a root
+  const unsigned long long st_out  = 0ULL;
+  const unsigned long long st_undo = 1ULL;
+  const unsigned long long st_root = 2ULL;
+
+  std::vector<unsigned long long> key(nrow);
+  std::vector<unsigned long long> key_max1(nrow);
+  std::vector<unsigned long long> key_max2(nrow);
+
+  std::vector<int> root(nrow);
 
   int last_g = -1;
 
-  // Perform plain aggregation
-  for(int i=0; i<this->get_nrow(); ++i) {
+  // The second pass builds new aggregates from the nodes not reached by the
+  // first one, a root needs at least two free strong neighbours there
+  for (int pass=0; pass<2; ++pass) {
 
-    if (cast_agg->vec_[i] != undefined) continue;
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int i=0; i<nrow; ++i) {
+
+      int nfree = 0;
+      if (cast_agg->vec_[i] == undefined)
+        for (int j=this->mat_.row_offset[i]; j<this->mat_.row_offset[i+1]; ++j)
+          if (cast_conn->vec_[j] && cast_agg->vec_[this->mat_.col[j]] == undefined)
+            ++nfree;
 
-      // The point is not adjacent to a core of any previous aggregate:
-      // so its a seed of a new aggregate.
-      cast_agg->vec_[i] = ++last_g;
+      unsigned int h = (unsigned int) i;
+      h = ((h >> 16) ^ h) * 0x45d9f3bU;
+      h = ((h >> 16) ^ h) * 0x45d9f3bU;
+      h = (h >> 16) ^ h;
 
-      neib.clear();
+      key[i] = (((nfree > pass) ? st_undo : st_out) << 62) |
+               ((unsigned long long) (h & 0x3fffffffU) << 32) |
+               (unsigned long long) (unsigned int) i;
 
-      // Include its neighbors as well.
-      for (int j=this->mat_.row_offset[i], e=this->mat_.row_offset[i+1]; j<e; ++j) {
-        int c = this->mat_.col[j];
-        if (cast_conn->vec_[j] && cast_agg->vec_[c] != removed) {
-          cast_agg->vec_[c] = last_g;
-          neib.push_back(c);
-        }
+      root[i] = undefined;
+
+    }
+
+    int nundecided = 1;
+
+    while (nundecided > 0) {
+
+      // Two sweeps of max-propagation over the strong connections
+#pragma omp parallel for schedule(dynamic, 1024)
+      for (int i=0; i<nrow; ++i) {
+        unsigned long long m = key[i];
+        for (int j=this->mat_.row_offset[i]; j<this->mat_.row_offset[i+1]; ++j)
+          if (cast_conn->vec_[j] && key[this->mat_.col[j]] > m)
+            m = key[this->mat_.col[j]];
+        key_max1[i] = m;
       }
 
-      // Temporarily mark undefined points adjacent to the new aggregate as
-      // belonging to the aggregate. If nobody claims them later, they will
-      // stay here.
-      for (typename std::vector<int>::const_iterator nb = neib.begin(); nb != neib.end(); ++nb)
-        for (int j=this->mat_.row_offset[*nb], e=this->mat_.row_offset[*nb+1]; j<e; ++j)
-          if (cast_conn->vec_[j] && cast_agg->vec_[this->mat_.col[j]] == undefined)
-            cast_agg->vec_[this->mat_.col[j]] = last_g;
+#pragma omp parallel for schedule(dynamic, 1024)
+      for (int i=0; i<nrow; ++i) {
+        unsigned long long m = key_max1[i];
+        for (int j=this->mat_.row_offset[i]; j<this->mat_.row_offset[i+1]; ++j)
+          if (cast_conn->vec_[j] && key_max1[this->mat_.col[j]] > m)
+            m = key_max1[this->mat_.col[j]];
+        key_max2[i] = m;
+      }
+
+      nundecided = 0;
+
+#pragma omp parallel for reduction(+:nundecided)
+      for (int i=0; i<nrow; ++i) {
+
+        if ((key[i] >> 62) != st_undo) continue;
+
+        if (key_max2[i] == key[i])
+          key[i] = (key[i] & ~(3ULL << 62)) | (st_root << 62);
+        else if ((key_max2[i] >> 62) == st_root)
+          key[i] = key[i] & ~(3ULL << 62);
+        else
+          ++nundecided;
+
+      }
+
+    }
+
+    // Number the roots in index order
+    for (int i=0; i<nrow; ++i)
+      if ((key[i] >> 62) == st_root)
+        root[i] = ++last_g;
+
+    // Roots take their free strong neighbours
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int i=0; i<nrow; ++i) {
+
+      if (cast_agg->vec_[i] != undefined) continue;
+
+      int g = root[i];
+      for (int j=this->mat_.row_offset[i]; (g < 0) && (j<this->mat_.row_offset[i+1]); ++j)
+        if (cast_conn->vec_[j])
+          g = root[this->mat_.col[j]];
+
+      cast_agg->vec_[i] = g;
 
     }
 
+  }
+
+  // The remaining nodes join an aggregate of a strong neighbour
+  std::vector<int> agg1(cast_agg->vec_, cast_agg->vec_ + nrow);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+  for (int i=0; i<nrow; ++i) {
+
+    if (agg1[i] != undefined) continue;
+
+    for (int j=this->mat_.row_offset[i]; j<this->mat_.row_offset[i+1]; ++j)
+      if (cast_conn->vec_[j] && agg1[this->mat_.col[j]] >= 0) {
+        cast_agg->vec_[i] = agg1[this->mat_.col[j]];
+        break;
+      }
+
+  }
+
+  // Nodes out of reach (non-symmetric strong connections) form new aggregates
+  for (int i=0; i<nrow; ++i) {
+
+    if (cast_agg->vec_[i] != undefined) continue;
+
+    cast_agg->vec_[i] = ++last_g;
+
+    for (int j=this->mat_.row_offset[i]; j<this->mat_.row_offset[i+1]; ++j)
+      if (cast_conn->vec_[j] && cast_agg->vec_[this->mat_.col[j]] == undefined)
+        cast_agg->vec_[this->mat_.col[j]] = last_g;
+
+  }
+
 }
 
 // ----------------------------------------------------------
@@ -3006,6 +3559,8 @@ void HostMatrixCSR<ValueType>::AMGSmoothedAggregation(const ValueType relax,
 
   ++ncol;
 
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
 #pragma omp parallel
   {
     std::vector<int> marker(ncol, -1);
@@ -3109,24 +3664,10 @@ void HostMatrixCSR<ValueType>::AMGSmoothedAggregation(const ValueType relax,
 
     }
 
-  }
-
-#pragma omp parallel for      
-  for (int i=0; i<cast_prolong->get_nrow(); ++i)
-    for (int j=cast_prolong->mat_.row_offset[i]; j<cast_prolong->mat_.row_offset[i+1]; ++j)
-      for (int jj=cast_prolong->mat_.row_offset[i]; jj<cast_prolong->mat_.row_offset[i+1]-1; ++jj)
-        if (cast_prolong->mat_.col[jj] > cast_prolong->mat_.col[jj+1]) {
-          //swap elements
-
-          int ind = cast_prolong->mat_.col[jj];
-          ValueType val = cast_prolong->mat_.val[jj];
-
-          cast_prolong->mat_.col[jj] = cast_prolong->mat_.col[jj+1];
-          cast_prolong->mat_.val[jj] = cast_prolong->mat_.val[jj+1];          
+    csr_sort_rows(cast_prolong->mat_.row_offset, cast_prolong->mat_.col, cast_prolong->mat_.val,
+                  chunk_start, chunk_end);
 
-          cast_prolong->mat_.col[jj+1] = ind;
-          cast_prolong->mat_.val[jj+1] = val;
-        }
+  }
 
   cast_restrict->CopyFrom(*cast_prolong);
   cast_restrict->Transpose();
@@ -3188,12 +3729,14 @@ void HostMatrixCSR<ValueType>::AMGAggregation(const BaseVector<int> &aggregates,
   allocate_host(row_offset[this->get_nrow()], &col);
   allocate_host(row_offset[this->get_nrow()], &val);
 
-  for (int i=0, j=0; i<this->get_nrow(); ++i) {
+  omp_set_num_threads(this->local_backend_.OpenMP_threads);
+
+#pragma omp parallel for
+  for (int i=0; i<this->get_nrow(); ++i) {
 
     if (cast_agg->vec_[i] >= 0) {
-      col[j] = cast_agg->vec_[i];
-      val[j] = 1.0;
-      ++j;
+      col[row_offset[i]] = cast_agg->vec_[i];
+      val[row_offset[i]] = 1.0;
     }
 
   }
@@ -83,6 +83,8 @@ public:
 
   virtual void SymbolicMatMatMult(const BaseMatrix<ValueType> &src);
   virtual bool MatMatMult(const BaseMatrix<ValueType> &A, const BaseMatrix<ValueType> &B);
+  virtual bool TripleMatrixProduct(const BaseMatrix<ValueType> &R, const BaseMatrix<ValueType> &A,
+                                   const BaseMatrix<ValueType> &P);
   virtual void SymbolicMatMatMult(const BaseMatrix<ValueType> &A, const BaseMatrix<ValueType> &B);
   virtual void NumericMatMatMult(const BaseMatrix<ValueType> &A, const BaseMatrix<ValueType> &B);
 
@@ -181,6 +183,16 @@ private:
   bool L_diag_unit_;
   bool U_diag_unit_;
 
+  // level scheduling of the triangular parts (see LAnalyse, UAnalyse),
+  // rows of the same level do not depend on each other
+  int  L_nlevels_;
+  int *L_level_offset_;
+  int *L_level_rows_;
+
+  int  U_nlevels_;
+  int *U_level_offset_;
+  int *U_level_rows_;
+
 };
 
 
@@ -975,6 +975,52 @@ void LocalMatrix<ValueType>::ExtractInverseDiagonal(LocalVector<ValueType> *vec_
   }
 }
 
+template <typename ValueType>
+void LocalMatrix<ValueType>::ExtractInverseBlockDiagonal(LocalMatrix<ValueType> *mat_inv_diag) const {
+
+  assert(mat_inv_diag != NULL);
+  assert(this->get_format() == BCSR);
+
+  if (this->get_nnz() > 0) {
+
+    assert( ( (this->matrix_ == this->matrix_host_)  && (mat_inv_diag->matrix_ == mat_inv_diag->matrix_host_)) ||
+            ( (this->matrix_ == this->matrix_accel_) && (mat_inv_diag->matrix_ == mat_inv_diag->matrix_accel_) ) );
+
+    mat_inv_diag->Clear();
+    mat_inv_diag->ConvertToBCSR();
+    mat_inv_diag->object_name_ = "Inverse of the diagonal blocks of " + this->object_name_;
+
+    bool err = this->matrix_->ExtractInverseBlockDiagonal(mat_inv_diag->matrix_);
+
+    if ((err == false) && (this->is_host() == true)) {
+      LOG_INFO("Computation of LocalMatrix::ExtractInverseBlockDiagonal() fail");
+      this->info();
+      FATAL_ERROR(__FILE__, __LINE__);
+    }
+
+
+    if (err == false) {
+
+      LocalMatrix<ValueType> tmp_mat;
+      tmp_mat.CloneFrom(*this);
+
+      tmp_mat.MoveToHost();
+      mat_inv_diag->MoveToHost();
+
+      if (tmp_mat.matrix_->ExtractInverseBlockDiagonal(mat_inv_diag->matrix_) == false) {
+        LOG_INFO("Computation of LocalMatrix::ExtractInverseBlockDiagonal() fail");
+        this->info();
+        FATAL_ERROR(__FILE__, __LINE__);
+      }
+
+      LOG_VERBOSE_INFO(2, "*** warning: LocalMatrix::ExtractInverseBlockDiagonal() is performed on the host");
+
+      mat_inv_diag->MoveToAccelerator();
+
+    }
+  }
+}
+
 template <typename ValueType>
 void LocalMatrix<ValueType>::ExtractSubMatrix(const int row_offset,
                                               const int col_offset,
@@ -1437,8 +1483,9 @@ void LocalMatrix<ValueType>::ILU0Factorize(void) {
 
   assert(this->get_nnz() > 0);
 
-  // Only CSR factorization
-  this->ConvertToCSR();
+  // CSR factorization, BCSR matrices are factorized in blocks on the host
+  if ((this->get_format() != BCSR) || (this->is_host() == false))
+    this->ConvertToCSR();
 
   bool err = this->matrix_->ILU0Factorize();
 
@@ -2241,6 +2288,63 @@ void LocalMatrix<ValueType>::MatrixMult(const LocalMatrix<ValueType> &A, const L
 
 }
 
+template <typename ValueType>
+void LocalMatrix<ValueType>::TripleMatrixProduct(const LocalMatrix<ValueType> &R, const LocalMatrix<ValueType> &A,
+                                                 const LocalMatrix<ValueType> &P) {
+
+  assert(&R != NULL);
+  assert(&A != NULL);
+  assert(&P != NULL);
+  assert(&R != this);
+  assert(&A != this);
+  assert(&P != this);
+
+  assert( ( (this->matrix_ == this->matrix_host_)  && (R.matrix_ == R.matrix_host_) &&
+            (A.matrix_ == A.matrix_host_)  && (P.matrix_ == P.matrix_host_)) ||
+          ( (this->matrix_ == this->matrix_accel_) && (R.matrix_ == R.matrix_accel_) &&
+            (A.matrix_ == A.matrix_accel_) && (P.matrix_ == P.matrix_accel_)) );
+
+  this->object_name_ = R.object_name_ + "x" + A.object_name_ + "x" + P.object_name_;
+
+  bool err = this->matrix_->TripleMatrixProduct(*R.matrix_, *A.matrix_, *P.matrix_);
+
+  if ((err == false) && (this->is_host() == true)) {
+    LOG_INFO("Computation of LocalMatrix::TripleMatrixProduct() fail");
+    this->info();
+    FATAL_ERROR(__FILE__, __LINE__);
+  }
+
+  if (err == false) {
+
+    LocalMatrix<ValueType> tmp_matR;
+    tmp_matR.CloneFrom(R);
+
+    LocalMatrix<ValueType> tmp_matA;
+    tmp_matA.CloneFrom(A);
+
+    LocalMatrix<ValueType> tmp_matP;
+    tmp_matP.CloneFrom(P);
+
+    tmp_matR.MoveToHost();
+    tmp_matA.MoveToHost();
+    tmp_matP.MoveToHost();
+    this->MoveToHost();
+
+    if (this->matrix_->TripleMatrixProduct(*tmp_matR.matrix_, *tmp_matA.matrix_, *tmp_matP.matrix_) == false) {
+
+      LOG_INFO("Computation of LocalMatrix::TripleMatrixProduct() fail");
+      this->info();
+      FATAL_ERROR(__FILE__, __LINE__);
+    }
+
+    LOG_VERBOSE_INFO(2, "*** warning: LocalMatrix::TripleMatrixProduct() is performed on the host");
+
+    this->MoveToAccelerator();
+
+  }
+
+}
+
 template <typename ValueType>
 void LocalMatrix<ValueType>::DiagonalMatrixMult(const LocalVector<ValueType> &diag) {
 
@@ -132,6 +132,10 @@ public:
   /// Extract the inverse (reciprocal) diagonal values of the matrix into a LocalVector
   void ExtractInverseDiagonal(LocalVector<ValueType> *vec_inv_diag) const;
 
+  /// Extract the inverses of the diagonal blocks of a BCSR matrix into a
+  /// block diagonal BCSR matrix
+  void ExtractInverseBlockDiagonal(LocalMatrix<ValueType> *mat_inv_diag) const;
+
   /// Extract the upper triangular matrix
   void ExtractU(LocalMatrix<ValueType> *U, const bool diag) const;
   /// Extract the lower triangular matrix
@@ -296,6 +300,11 @@ public:
   /// Multiply two matrices, this = A * B
   void MatrixMult(const LocalMatrix<ValueType> &A, const LocalMatrix<ValueType> &B);
 
+  /// Multiply three matrices, this = R * A * P (e.g. the Galerkin product
+  /// of the multigrid coarse operators) without storing R * A
+  void TripleMatrixProduct(const LocalMatrix<ValueType> &R, const LocalMatrix<ValueType> &A,
+                           const LocalMatrix<ValueType> &P);
+
   /// Multiply the matrix with diagonal matrix (stored in LocalVector), 
   /// this=this*diag
   void DiagonalMatrixMult(const LocalVector<ValueType> &diag);
@@ -151,6 +151,7 @@ private:
 
   friend class LocalMatrix<ValueType>;  
   friend class GlobalMatrix<ValueType>;  
+  friend class GlobalVector<ValueType>;  
   friend class LocalStencil<ValueType>;  
   friend class GlobalStencil<ValueType>;  
 
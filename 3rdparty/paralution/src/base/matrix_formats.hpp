@@ -79,8 +79,21 @@ struct MatrixMCSR {
   ValueType *diag;
 };
 
+/// Sparse Matrix -
+/// Block Compressed Row Format (nrow and ncol are multiples of blockdim)
 template <typename ValueType, typename IndexType>
 struct MatrixBCSR {
+  /// Block row offsets (row ptr)
+  IndexType *row_offset;
+
+  /// Block column index
+  IndexType *col;
+
+  /// Values - dense blocks (blockdim x blockdim, row major)
+  ValueType *val;
+
+  /// Dimension of the blocks
+  IndexType blockdim;
 };
 
 /// Sparse Matrix -
@@ -52,5 +52,10 @@
 
 
 
+// BCSR indexing (dense blocks, row major)
+#define BCSR_IND(blk, r, c, blockdim) (((blk)*(blockdim) + (r))*(blockdim) + (c))
+
+
+
 #endif // PARALUTION_MATRIX_FORMATS_IND_HPP_
 
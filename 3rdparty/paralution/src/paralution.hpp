@@ -62,6 +62,7 @@
 #include "solvers/preconditioners/preconditioner_multielimination.hpp"
 #include "solvers/preconditioners/preconditioner_saddlepoint.hpp"
 #include "solvers/preconditioners/preconditioner_blockprecond.hpp"
+#include "solvers/preconditioners/preconditioner_as.hpp"
 
 #include "utils/allocate_free.hpp"
 #include "utils/math_functions.hpp"
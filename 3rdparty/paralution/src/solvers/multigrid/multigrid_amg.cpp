@@ -638,12 +638,9 @@ void AMG<OperatorType, VectorType, ValueType>::CoarsenOperator(const OperatorTyp
   assert(&restrict != NULL);
   assert(&prolong  != NULL);
 
-  OperatorType tmp;
-  tmp.CloneBackend(*this->op_);
   op_coarse->CloneBackend(*this->op_);
 
-  tmp.MatrixMult(restrict, op_fine);
-  op_coarse->MatrixMult(tmp, prolong);
+  op_coarse->TripleMatrixProduct(restrict, op_fine, prolong);
 
 }
 
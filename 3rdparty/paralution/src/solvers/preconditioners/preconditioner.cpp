@@ -160,6 +160,108 @@ void Jacobi<OperatorType, VectorType, ValueType>::MoveToAcceleratorLocalData_(vo
 
 
 
+template <class OperatorType, class VectorType, typename ValueType>
+PointBlockJacobi<OperatorType, VectorType, ValueType>::PointBlockJacobi() {
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+PointBlockJacobi<OperatorType, VectorType, ValueType>::~PointBlockJacobi() {
+
+  this->Clear();
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void PointBlockJacobi<OperatorType, VectorType, ValueType>::Print(void) const {
+
+  LOG_INFO("Point-block Jacobi preconditioner");
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void PointBlockJacobi<OperatorType, VectorType, ValueType>::Build(void) {
+
+  if (this->build_ == true)
+    this->Clear();
+
+  assert(this->build_ == false);
+  this->build_ = true;
+
+  assert(this->op_ != NULL);
+
+  this->inv_diag_blocks_.CloneBackend(*this->op_);
+  this->op_->ExtractInverseBlockDiagonal(&this->inv_diag_blocks_);
+
+  this->tmp_.CloneBackend(*this->op_);
+  this->tmp_.Allocate("Point-block Jacobi tmp", this->op_->get_nrow());
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void PointBlockJacobi<OperatorType, VectorType, ValueType>::ResetOperator(const OperatorType &op) {
+
+  assert(this->op_ != NULL);
+
+  this->inv_diag_blocks_.Clear();
+  this->inv_diag_blocks_.CloneBackend(*this->op_);
+  this->op_->ExtractInverseBlockDiagonal(&this->inv_diag_blocks_);
+
+}
+
+
+template <class OperatorType, class VectorType, typename ValueType>
+void PointBlockJacobi<OperatorType, VectorType, ValueType>::Clear(void) {
+
+  this->inv_diag_blocks_.Clear();
+  this->tmp_.Clear();
+  this->build_ = false;
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void PointBlockJacobi<OperatorType, VectorType, ValueType>::Solve(const VectorType &rhs,
+                                                                  VectorType *x) {
+
+  assert(this->build_ == true);
+  assert(x != NULL);
+
+  if (x != &rhs) {
+
+    this->inv_diag_blocks_.Apply(rhs, x);
+
+  } else {
+
+    this->tmp_.CopyFrom(rhs);
+    this->inv_diag_blocks_.Apply(this->tmp_, x);
+
+  }
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void PointBlockJacobi<OperatorType, VectorType, ValueType>::MoveToHostLocalData_(void) {
+
+  this->inv_diag_blocks_.MoveToHost();
+  this->tmp_.MoveToHost();
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void PointBlockJacobi<OperatorType, VectorType, ValueType>::MoveToAcceleratorLocalData_(void) {
+
+  this->inv_diag_blocks_.MoveToAccelerator();
+  this->tmp_.MoveToAccelerator();
+
+}
+
+
+
+
+
+
+
+
+
 template <class OperatorType, class VectorType, typename ValueType>
 ILU<OperatorType, VectorType, ValueType>::ILU() {
 
@@ -863,6 +965,12 @@ template class Preconditioner< GlobalStencil<float>,  GlobalVector<float>, float
 template class Jacobi< LocalMatrix<double>, LocalVector<double>, double >;
 template class Jacobi< LocalMatrix<float>,  LocalVector<float>, float >;
 
+template class Jacobi< GlobalMatrix<double>, GlobalVector<double>, double >;
+template class Jacobi< GlobalMatrix<float>,  GlobalVector<float>, float >;
+
+template class PointBlockJacobi< LocalMatrix<double>, LocalVector<double>, double >;
+template class PointBlockJacobi< LocalMatrix<float>,  LocalVector<float>, float >;
+
 template class ILU< LocalMatrix<double>, LocalVector<double>, double >;
 template class ILU< LocalMatrix<float>,  LocalVector<float>, float >;
 
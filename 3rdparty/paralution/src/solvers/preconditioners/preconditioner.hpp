@@ -75,6 +75,37 @@ private:
 
 };
 
+//// Point-block Jacobi preconditioner, inverts the dense diagonal blocks
+//// of a BCSR matrix
+template <class OperatorType, class VectorType, typename ValueType>
+class PointBlockJacobi : public Preconditioner<OperatorType, VectorType, ValueType> {
+
+public:
+
+  PointBlockJacobi();
+  virtual ~PointBlockJacobi();
+
+  virtual void Print(void) const;
+  virtual void Solve(const VectorType &rhs,
+                     VectorType *x);
+  virtual void Build(void);
+  virtual void Clear(void);
+
+  virtual void ResetOperator(const OperatorType &op);
+
+protected:
+
+  virtual void MoveToHostLocalData_(void);
+  virtual void MoveToAcceleratorLocalData_(void) ;
+
+
+private:
+
+  OperatorType inv_diag_blocks_;
+  VectorType tmp_;
+
+};
+
 /// ILU preconditioner based on levels
 template <class OperatorType, class VectorType, typename ValueType>
 class ILU : public Preconditioner<OperatorType, VectorType, ValueType> {
@@ -0,0 +1,318 @@
+// *************************************************************************
+//
+//    PARALUTION   www.paralution.com
+//
+//    Copyright (C) 2012-2013 Dimitar Lukarski
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// *************************************************************************
+
+#include "preconditioner_as.hpp"
+#include "preconditioner.hpp"
+#include "../solver.hpp"
+#include "../../base/global_matrix.hpp"
+#include "../../base/local_matrix.hpp"
+
+#include "../../base/global_vector.hpp"
+#include "../../base/local_vector.hpp"
+#include "../../base/backend_manager.hpp"
+
+#include "../../utils/log.hpp"
+
+#include <assert.h>
+
+namespace paralution {
+
+template <class OperatorType, class VectorType, typename ValueType>
+AS<OperatorType, VectorType, ValueType>::AS() {
+
+  this->overlap_ = true;
+
+  this->num_domains_ = 0;
+
+  this->local_mat_ = NULL;
+  this->local_rhs_ = NULL;
+  this->local_sol_ = NULL;
+  this->ghost_ = NULL;
+
+  this->local_solvers_ = NULL;
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+AS<OperatorType, VectorType, ValueType>::~AS() {
+
+  this->Clear();
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void AS<OperatorType, VectorType, ValueType>::Print(void) const {
+
+  if (this->build_ == true) {
+
+    LOG_INFO("Additive Schwarz preconditioner with " << this->num_domains_ << " subdomains:");
+
+    this->local_solvers_[0]->Print();
+
+  } else {
+
+    LOG_INFO("Additive Schwarz preconditioner");
+
+  }
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void AS<OperatorType, VectorType, ValueType>::Set(const int n,
+                                                  Solver<LocalMatrix<ValueType>, LocalVector<ValueType>, ValueType> **local_solvers) {
+
+  assert(this->build_ == false);
+  assert(this->local_solvers_ == NULL);
+  assert(n > 0);
+  assert(local_solvers != NULL);
+
+  this->num_domains_ = n;
+  this->local_solvers_ = new Solver<LocalMatrix<ValueType>, LocalVector<ValueType>, ValueType>*[n];
+
+  for (int d=0; d<n; ++d)
+    this->local_solvers_[d] = local_solvers[d];
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void AS<OperatorType, VectorType, ValueType>::Build(void) {
+
+  assert(this->build_ == false);
+  this->build_ = true;
+
+  assert(this->op_ != NULL);
+
+  const int nd = this->op_->get_ndomains();
+  assert(nd > 0);
+
+  if (this->local_solvers_ == NULL) {
+
+    this->num_domains_ = nd;
+    this->local_solvers_ = new Solver<LocalMatrix<ValueType>, LocalVector<ValueType>, ValueType>*[nd];
+
+    for (int d=0; d<nd; ++d)
+      this->local_solvers_[d] = new ILU<LocalMatrix<ValueType>, LocalVector<ValueType>, ValueType>;
+
+  }
+
+  assert(this->num_domains_ == nd);
+
+  if (this->overlap_ == true) {
+
+    this->local_mat_ = new LocalMatrix<ValueType>[nd];
+    this->op_->ExtractOverlapMatrices(this->local_mat_);
+
+  }
+
+  this->local_rhs_ = new LocalVector<ValueType>[nd];
+  this->local_sol_ = new LocalVector<ValueType>[nd];
+  this->ghost_ = new LocalVector<ValueType>[nd];
+
+  const int nested = _paralution_begin_nested();
+
+#pragma omp parallel for num_threads(nd) schedule(static, 1)
+  for (int d=0; d<nd; ++d) {
+
+    const LocalMatrix<ValueType> &mat = (this->overlap_ == true) ? this->local_mat_[d] : this->op_->GetInterior(d);
+
+    this->local_solvers_[d]->SetOperator(mat);
+    this->local_solvers_[d]->Build();
+
+    this->local_rhs_[d].CloneBackend(mat);
+    this->local_rhs_[d].Allocate("AS rhs", mat.get_nrow());
+
+    this->local_sol_[d].CloneBackend(mat);
+    this->local_sol_[d].Allocate("AS sol", mat.get_nrow());
+
+  }
+
+  _paralution_end_nested(nested);
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void AS<OperatorType, VectorType, ValueType>::Clear(void) {
+
+  if (this->local_solvers_ != NULL) {
+
+    for (int d=0; d<this->num_domains_; ++d) {
+      this->local_solvers_[d]->Clear();
+      delete this->local_solvers_[d];
+    }
+
+    delete[] this->local_solvers_;
+    this->local_solvers_ = NULL;
+
+  }
+
+  delete[] this->local_mat_;
+  delete[] this->local_rhs_;
+  delete[] this->local_sol_;
+  delete[] this->ghost_;
+
+  this->local_mat_ = NULL;
+  this->local_rhs_ = NULL;
+  this->local_sol_ = NULL;
+  this->ghost_ = NULL;
+
+  this->num_domains_ = 0;
+
+  this->build_ = false;
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void AS<OperatorType, VectorType, ValueType>::Solve(const VectorType &rhs,
+                                                    VectorType *x) {
+
+  assert(this->build_ == true);
+  assert(x != NULL);
+  assert(x != &rhs);
+
+  const int nd = this->num_domains_;
+  const int nested = _paralution_begin_nested();
+
+  if (this->overlap_ == true) {
+
+    // all extended right-hand sides are gathered before x is written
+#pragma omp parallel for num_threads(nd) schedule(static, 1)
+    for (int d=0; d<nd; ++d) {
+
+      const LocalVector<ValueType> &rhs_interior = rhs.GetInterior(d);
+      const int n = rhs_interior.get_size();
+
+      this->op_->GetGhostValues(d, rhs, &this->ghost_[d]);
+
+      this->local_rhs_[d].CopyFrom(rhs_interior, 0, 0, n);
+
+      if (this->ghost_[d].get_size() > 0)
+        this->local_rhs_[d].CopyFrom(this->ghost_[d], 0, n, this->ghost_[d].get_size());
+
+    }
+
+#pragma omp parallel for num_threads(nd) schedule(static, 1)
+    for (int d=0; d<nd; ++d) {
+
+      LocalVector<ValueType> &x_interior = x->GetInterior(d);
+
+      this->local_sol_[d].Zeros();
+      this->local_solvers_[d]->Solve(this->local_rhs_[d], &this->local_sol_[d]);
+
+      // restricted - the overlap part of the solution is dropped
+      x_interior.CopyFrom(this->local_sol_[d], 0, 0, x_interior.get_size());
+
+    }
+
+  } else {
+
+#pragma omp parallel for num_threads(nd) schedule(static, 1)
+    for (int d=0; d<nd; ++d) {
+
+      this->local_sol_[d].Zeros();
+      this->local_solvers_[d]->Solve(rhs.GetInterior(d), &this->local_sol_[d]);
+
+      x->GetInterior(d).CopyFrom(this->local_sol_[d]);
+
+    }
+
+  }
+
+  _paralution_end_nested(nested);
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void AS<OperatorType, VectorType, ValueType>::MoveToHostLocalData_(void) {
+
+  if (this->build_ == true)
+    for (int d=0; d<this->num_domains_; ++d) {
+
+      if (this->overlap_ == true)
+        this->local_mat_[d].MoveToHost();
+
+      this->local_solvers_[d]->ResetOperator((this->overlap_ == true) ? this->local_mat_[d] : this->op_->GetInterior(d));
+      this->local_solvers_[d]->MoveToHost();
+
+      this->local_rhs_[d].MoveToHost();
+      this->local_sol_[d].MoveToHost();
+      this->ghost_[d].MoveToHost();
+
+    }
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void AS<OperatorType, VectorType, ValueType>::MoveToAcceleratorLocalData_(void) {
+
+  if (this->build_ == true)
+    for (int d=0; d<this->num_domains_; ++d) {
+
+      if (this->overlap_ == true)
+        this->local_mat_[d].MoveToAccelerator();
+
+      this->local_solvers_[d]->ResetOperator((this->overlap_ == true) ? this->local_mat_[d] : this->op_->GetInterior(d));
+      this->local_solvers_[d]->MoveToAccelerator();
+
+      this->local_rhs_[d].MoveToAccelerator();
+      this->local_sol_[d].MoveToAccelerator();
+      this->ghost_[d].MoveToAccelerator();
+
+    }
+
+}
+
+
+template <class OperatorType, class VectorType, typename ValueType>
+BlockJacobi<OperatorType, VectorType, ValueType>::BlockJacobi() {
+
+  this->overlap_ = false;
+
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+BlockJacobi<OperatorType, VectorType, ValueType>::~BlockJacobi() {
+}
+
+template <class OperatorType, class VectorType, typename ValueType>
+void BlockJacobi<OperatorType, VectorType, ValueType>::Print(void) const {
+
+  if (this->build_ == true) {
+
+    LOG_INFO("Block-Jacobi preconditioner with " << this->num_domains_ << " subdomains:");
+
+    this->local_solvers_[0]->Print();
+
+  } else {
+
+    LOG_INFO("Block-Jacobi preconditioner");
+
+  }
+
+}
+
+
+template class AS< GlobalMatrix<double>, GlobalVector<double>, double >;
+template class AS< GlobalMatrix<float>,  GlobalVector<float>, float >;
+
+template class BlockJacobi< GlobalMatrix<double>, GlobalVector<double>, double >;
+template class BlockJacobi< GlobalMatrix<float>,  GlobalVector<float>, float >;
+
+}
@@ -0,0 +1,95 @@
+// *************************************************************************
+//
+//    PARALUTION   www.paralution.com
+//
+//    Copyright (C) 2012-2013 Dimitar Lukarski
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// *************************************************************************
+
+#ifndef PARALUTION_PRECONDITIONER_AS_HPP_
+#define PARALUTION_PRECONDITIONER_AS_HPP_
+
+#include "../solver.hpp"
+#include "preconditioner.hpp"
+#include "../../base/local_matrix.hpp"
+#include "../../base/local_vector.hpp"
+
+namespace paralution {
+
+/// Restricted additive Schwarz preconditioner for a partitioned GlobalMatrix;
+/// every subdomain is extended by one layer of ghost unknowns and solved
+/// by its own local solver, only the interior part of the local solutions
+/// is kept. The subdomains are processed concurrently.
+template <class OperatorType, class VectorType, typename ValueType>
+class AS : public Preconditioner<OperatorType, VectorType, ValueType> {
+
+public:
+
+  AS();
+  virtual ~AS();
+
+  virtual void Print(void) const;
+
+  /// Set the local solvers (one per subdomain), the preconditioner takes the
+  /// ownership of the solvers; if not set ILU(0) is used on every subdomain
+  virtual void Set(const int n,
+                   Solver<LocalMatrix<ValueType>, LocalVector<ValueType>, ValueType> **local_solvers);
+
+  virtual void Solve(const VectorType &rhs,
+                     VectorType *x);
+
+  virtual void Build(void);
+  virtual void Clear(void);
+
+protected:
+
+  virtual void MoveToHostLocalData_(void);
+  virtual void MoveToAcceleratorLocalData_(void);
+
+  /// Extend the subdomains by the ghost layer
+  bool overlap_;
+
+  int num_domains_;
+
+  /// Extended subdomain matrices (overlap only)
+  LocalMatrix<ValueType> *local_mat_;
+
+  LocalVector<ValueType> *local_rhs_;
+  LocalVector<ValueType> *local_sol_;
+  LocalVector<ValueType> *ghost_;
+
+  Solver<LocalMatrix<ValueType>, LocalVector<ValueType>, ValueType> **local_solvers_;
+
+};
+
+/// Block-Jacobi preconditioner for a partitioned GlobalMatrix - additive
+/// Schwarz without overlap, the local solvers act on the interior matrices
+template <class OperatorType, class VectorType, typename ValueType>
+class BlockJacobi : public AS<OperatorType, VectorType, ValueType> {
+
+public:
+
+  BlockJacobi();
+  virtual ~BlockJacobi();
+
+  virtual void Print(void) const;
+
+};
+
+
+}
+
+#endif // PARALUTION_PRECONDITIONER_AS_HPP_
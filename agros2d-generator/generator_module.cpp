@@ -575,11 +575,12 @@ void Agros2DGeneratorModule::generatePluginErrorCalculator()
                     {
                         QString exprCpp;
                         if (coordinateType == CoordinateType_Planar)
-                            exprCpp = parseWeakFormExpression(analysisType, coordinateType, linearityTypes[lt], QString::fromStdString(expr.planar().get()), true, true);
+                            exprCpp = parseWeakFormExpression(analysisType, coordinateType, linearityTypes[lt], QString::fromStdString(expr.planar().get()), true, true, true);
                         else
-                            exprCpp = parseWeakFormExpression(analysisType, coordinateType, linearityTypes[lt], QString::fromStdString(expr.axi().get()), true, true);
+                            exprCpp = parseWeakFormExpression(analysisType, coordinateType, linearityTypes[lt], QString::fromStdString(expr.axi().get()), true, true, true);
 
                         expression->SetValue("EXPRESSION", exprCpp.toStdString());
+                        generatePointValues(analysisType, exprCpp, *expression);
 
                         foreach(QString key, m_volumeVariables.keys())
                         {
@@ -1414,6 +1415,7 @@ void Agros2DGeneratorModule::createIntegralExpression(ctemplate::TemplateDiction
         expression->SetValue("ANALYSIS_TYPE", Agros2DGenerator::analysisTypeStringEnum(analysisType).toStdString());
         expression->SetValue("COORDINATE_TYPE", Agros2DGenerator::coordinateTypeStringEnum(coordinateType).toStdString());
         expression->SetValue("EXPRESSION", parsePostprocessorExpression(analysisType, coordinateType, expr, true).toStdString());
+        expression->SetValue("EXPRESSION_ORDER", parsePostprocessorExpressionOrder(analysisType, coordinateType, expr).toStdString());
         expression->SetValue("POSITION", QString::number(pos).toStdString());
     }
 }
@@ -1624,6 +1626,100 @@ QString Agros2DGeneratorModule::parsePostprocessorExpression(AnalysisType analys
     }
 }
 
+QString Agros2DGeneratorModule::parsePostprocessorExpressionOrder(AnalysisType analysisType, CoordinateType coordinateType, const QString &expr)
+{
+    try
+    {
+        int numOfSol = Agros2DGenerator::numberOfSolutions(m_module->general().analyses(), analysisType);
+
+        QMap<QString, QString> dict;
+
+        // coordinates (affine elements)
+        if (coordinateType == CoordinateType_Planar)
+        {
+            dict["x"] = "Hermes::Ord(1)";
+            dict["y"] = "Hermes::Ord(1)";
+            dict["tanx"] = "Hermes::Ord(0)";
+            dict["tany"] = "Hermes::Ord(0)";
+        }
+        else
+        {
+            dict["r"] = "Hermes::Ord(1)";
+            dict["z"] = "Hermes::Ord(1)";
+            dict["tanr"] = "Hermes::Ord(0)";
+            dict["tanz"] = "Hermes::Ord(0)";
+        }
+
+        // constants
+        dict["PI"] = "M_PI";
+        dict["f"] = "m_fieldInfo->frequency()";
+        foreach (XMLModule::constant cnst, m_module->constants().constant())
+            dict[QString::fromStdString(cnst.id())] = QString::number(cnst.value());
+
+        // functions
+        for (int i = 1; i < numOfSol + 1; i++)
+        {
+            dict[QString("value%1").arg(i)] = QString("fns[%1]->val[0]").arg(i-1);
+            if (coordinateType == CoordinateType_Planar)
+            {
+                dict[QString("dx%1").arg(i)] = QString("fns[%1]->dx[0]").arg(i-1);
+                dict[QString("dy%1").arg(i)] = QString("fns[%1]->dy[0]").arg(i-1);
+            }
+            else
+            {
+                dict[QString("dr%1").arg(i)] = QString("fns[%1]->dx[0]").arg(i-1);
+                dict[QString("dz%1").arg(i)] = QString("fns[%1]->dy[0]").arg(i-1);
+            }
+        }
+        // eggshell
+        if (coordinateType == CoordinateType_Planar)
+        {
+            dict["dxegg"] = "fns[source_functions.size() - 1]->dx[0]";
+            dict["dyegg"] = "fns[source_functions.size() - 1]->dy[0]";
+        }
+        else
+        {
+            dict["dregg"] = "fns[source_functions.size() - 1]->dx[0]";
+            dict["dzegg"] = "fns[source_functions.size() - 1]->dy[0]";
+        }
+
+        // variables (constant material, nonlinear material and special functions as in the weak forms)
+        foreach (XMLModule::quantity quantity, m_module->volume().quantity())
+        {
+            if (quantity.shortname().present())
+            {
+                QString nonlinearExpr = nonlinearExpression(QString::fromStdString(quantity.id()), analysisType, coordinateType);
+
+                if (nonlinearExpr.isEmpty())
+                    dict[QString::fromStdString(quantity.shortname().get())] = "1.0";
+                else
+                    dict[QString::fromStdString(quantity.shortname().get())] = "Hermes::Ord(1)";
+            }
+        }
+
+        foreach (XMLModule::function function, m_module->volume().function())
+            dict[QString::fromStdString(function.shortname())] = "Hermes::Ord(1)";
+
+        LexicalAnalyser *lex = postprocessorLexicalAnalyser(analysisType, coordinateType);
+        lex->setExpression(expr);
+        QString exprCpp = lex->replaceVariables(dict);
+
+        // TODO: move from lex
+        exprCpp = lex->replaceOperatorByFunction(exprCpp);
+
+        delete lex;
+
+        // constant expression (double) is converted to Hermes::Ord
+        return QString("(%1) + Hermes::Ord(0)").arg(exprCpp);
+    }
+    catch (ParserException e)
+    {
+        Hermes::Mixins::Loggable::Static::error(QString("%1 in module %2").arg(e.toString()).arg(QString::fromStdString(m_module->general().id())).toLatin1());
+
+        return "Hermes::Ord(Hermes::Ord::get_max_order())";
+    }
+}
+
 //-----------------------------------------------------------------------------------------
 
 LexicalAnalyser *Agros2DGeneratorModule::weakFormLexicalAnalyser(AnalysisType analysisType, CoordinateType coordinateType)
@@ -1742,7 +1838,7 @@ LexicalAnalyser *Agros2DGeneratorModule::weakFormLexicalAnalyser(AnalysisType an
 }
 
 QString Agros2DGeneratorModule::parseWeakFormExpression(AnalysisType analysisType, CoordinateType coordinateType, LinearityType linearityType,
-                                                        const QString &expr, bool includeVariables, bool errorCalculation)
+                                                        const QString &expr, bool includeVariables, bool errorCalculation, bool pointValues)
 {
     try
     {
@@ -1891,15 +1987,23 @@ QString Agros2DGeneratorModule::parseWeakFormExpression(AnalysisType analysisTyp
                             {
                                 // spacedep boundary condition
                                 // ERROR: Python expression evaluation doesn't work from weakform - ERROR
-                                dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtPoint(Point(x, y))").
-                                        arg(QString::fromStdString(quantity.shortname().get()));
+                                if (pointValues)
+                                    dict[QString::fromStdString(quantity.shortname().get())] = QString("%1_values[i]").
+                                            arg(QString::fromStdString(quantity.shortname().get()));
+                                else
+                                    dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtPoint(Point(x, y))").
+                                            arg(QString::fromStdString(quantity.shortname().get()));
                             }
                             else if (dep == "time-space")
                             {
                                 // spacedep boundary condition
                                 // ERROR: Python expression evaluation doesn't work from weakform - ERROR
-                                dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtTimeAndPoint(Agros2D::problem()->actualTime(), Point(x, y))").
-                                        arg(QString::fromStdString(quantity.shortname().get()));
+                                if (pointValues)
+                                    dict[QString::fromStdString(quantity.shortname().get())] = QString("%1_values[i]").
+                                            arg(QString::fromStdString(quantity.shortname().get()));
+                                else
+                                    dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtTimeAndPoint(Agros2D::problem()->actualTime(), Point(x, y))").
+                                            arg(QString::fromStdString(quantity.shortname().get()));
                             }
                         }
                         else
@@ -1964,14 +2068,22 @@ QString Agros2DGeneratorModule::parseWeakFormExpression(AnalysisType analysisTyp
                     else if (dep == "space")
                     {
                         // spacedep boundary condition
-                        dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtPoint(Point(x, y))").
-                                arg(QString::fromStdString(quantity.shortname().get()));
+                        if (pointValues)
+                            dict[QString::fromStdString(quantity.shortname().get())] = QString("%1_values[i]").
+                                    arg(QString::fromStdString(quantity.shortname().get()));
+                        else
+                            dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtPoint(Point(x, y))").
+                                    arg(QString::fromStdString(quantity.shortname().get()));
                     }
                     else if (dep == "time-space")
                     {
                         // spacedep boundary condition
-                        dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtTimeAndPoint(Agros2D::problem()->actualTime(), Point(x, y))").
-                                arg(QString::fromStdString(quantity.shortname().get()));
+                        if (pointValues)
+                            dict[QString::fromStdString(quantity.shortname().get())] = QString("%1_values[i]").
+                                    arg(QString::fromStdString(quantity.shortname().get()));
+                        else
+                            dict[QString::fromStdString(quantity.shortname().get())] = QString("%1->numberAtTimeAndPoint(Agros2D::problem()->actualTime(), Point(x, y))").
+                                    arg(QString::fromStdString(quantity.shortname().get()));
                     }
                 }
             }
@@ -1996,6 +2108,30 @@ QString Agros2DGeneratorModule::parseWeakFormExpression(AnalysisType analysisTyp
     }
 }
 
+void Agros2DGeneratorModule::generatePointValues(AnalysisType analysisType, const QString &exprCpp, ctemplate::TemplateDictionary &output)
+{
+    QHash<QString, QString> variables = m_volumeVariables;
+    foreach (QString key, m_surfaceVariables.keys())
+        variables[key] = m_surfaceVariables[key];
+
+    QSet<QString> shortnames;
+    for (QHash<QString, QString>::const_iterator it = variables.begin(); it != variables.end(); ++it)
+    {
+        if (shortnames.contains(it.value()) || !exprCpp.contains(QString("%1_values[i]").arg(it.value())))
+            continue;
+        shortnames.insert(it.value());
+
+        QString dep = dependence(it.key(), analysisType);
+
+        ctemplate::TemplateDictionary *field = output.AddSectionDictionary("POINT_VALUE");
+        field->SetValue("VARIABLE_SHORT", it.value().toStdString());
+        if (dep == "time-space")
+            field->SetValue("POINT_VALUE_METHOD", QString("numberAtTimeAndPoints(Agros2D::problem()->actualTime(), ").toStdString());
+        else
+            field->SetValue("POINT_VALUE_METHOD", QString("numberAtPoints(").toStdString());
+    }
+}
+
 class ValueGenerator
 {
 public:
@@ -2265,9 +2401,13 @@ void Agros2DGeneratorModule::generateForm(FormInfo formInfo, LinearityType linea
             field->SetValue("WEAKFORM_ID", formInfo.id.toStdString());
 
             // expression
+            // exact solution is evaluated point by point, forms loop over integration points
+            bool pointValues = (weakFormType != "EXACT");
             QString exprCpp = parseWeakFormExpression(analysisTypeFromStringKey(QString::fromStdString(weakform.analysistype())),
-                                                      coordinateType, linearityType, expression);
+                                                      coordinateType, linearityType, expression, true, false, pointValues);
             field->SetValue("EXPRESSION", exprCpp.toStdString());
+            if (pointValues)
+                generatePointValues(analysisTypeFromStringKey(QString::fromStdString(weakform.analysistype())), exprCpp, *field);
 
             QString exprCppCheck = parseWeakFormExpressionCheck(analysisTypeFromStringKey(QString::fromStdString(weakform.analysistype())),
                                                                 coordinateType, linearityType, formInfo.condition);
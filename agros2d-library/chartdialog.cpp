@@ -96,7 +96,7 @@ void ChartView::setControls()
 // **************************************************************************************************
 
 ChartWidget::ChartWidget(ChartView *chart,
-                         QWidget *parent) : QWidget(parent), m_chart(chart)
+                         QWidget *parent) : QWidget(parent), m_chart(chart), m_probeID(-1)
 {
     connect(Agros2D::problem(), SIGNAL(solved()), this, SLOT(updateControls()));
 
@@ -423,14 +423,17 @@ void ChartWidget::plotGeometry()
     {
         if (physicFieldVariable.id() != variable.id()) continue;
 
-        foreach (Point point, points)
+        // all points at once, elements are located by walking along the line
+        LocalValue *localValue = fieldWidget->selectedField()->plugin()->localValue(fieldWidget->selectedField(),
+                                                                                    fieldWidget->selectedTimeStep(),
+                                                                                    fieldWidget->selectedAdaptivityStep(),
+                                                                                    fieldWidget->selectedAdaptivitySolutionType(),
+                                                                                    points);
+        QList<QMap<QString, LocalPointValue> > pointValues = localValue->pointValues();
+
+        for (int i = 0; i < points.count(); i++)
         {
-            LocalValue *localValue = fieldWidget->selectedField()->plugin()->localValue(fieldWidget->selectedField(),
-                                                                                        fieldWidget->selectedTimeStep(),
-                                                                                        fieldWidget->selectedAdaptivityStep(),
-                                                                                        fieldWidget->selectedAdaptivitySolutionType(),
-                                                                                        point);
-            QMap<QString, LocalPointValue> values = localValue->values();
+            QMap<QString, LocalPointValue> values = pointValues.at(i);
 
             if (variable.isScalar())
             {
@@ -445,9 +448,9 @@ void ChartWidget::plotGeometry()
                 else
                     yval.append(values[variable.id()].vector.magnitude());
             }
-
-            delete localValue;
         }
+
+        delete localValue;
     }
 
     assert(xval.count() == yval.count());
@@ -491,6 +494,47 @@ void ChartWidget::plotTime()
 
     createChartLine();
 
+    // values recorded during the solve (no reloading of the time steps)
+    Point point(txtTimeX->value(), txtTimeY->value());
+    SolutionStore::Probe probe(fieldWidget->selectedField(), SolutionStore::ProbeType_LocalValue, point);
+    int probeID = Agros2D::solutionStore()->findProbe(probe);
+    if (probeID != -1)
+    {
+        SolutionStore::ProbeSeries series = Agros2D::solutionStore()->probeSeries(probeID);
+        if (series.times.count() == timeLevels.count())
+        {
+            xval = series.times;
+
+            if (physicFieldVariable.isScalar())
+            {
+                yval = series.scalars.value(physicFieldVariable.id(), QVector<double>(xval.count(), 0.0));
+            }
+            else
+            {
+                QVector<Point> vectors = series.vectors.value(physicFieldVariable.id(), QVector<Point>(xval.count(), Point()));
+                foreach (Point vector, vectors)
+                {
+                    if (physicFieldVariableComp == PhysicFieldVariableComp_X)
+                        yval.append(vector.x);
+                    else if (physicFieldVariableComp == PhysicFieldVariableComp_Y)
+                        yval.append(vector.y);
+                    else
+                        yval.append(vector.magnitude());
+                }
+            }
+
+            m_chart->chart()->graph(0)->setData(xval, yval);
+            return;
+        }
+    }
+    else
+    {
+        // point will be recorded during the next solve, it replaces the previously plotted point
+        if (m_probeID != -1)
+            Agros2D::solutionStore()->removeProbe(m_probeID);
+        m_probeID = Agros2D::solutionStore()->addProbe(probe);
+    }
+
     foreach (Module::LocalVariable variable, fieldWidget->selectedField()->localPointVariables())
     {
         if (physicFieldVariable.id() != variable.id()) continue;
@@ -500,7 +544,6 @@ void ChartWidget::plotTime()
             // change time level
             xval.append(timeLevels.at(i));
 
-            Point point(txtTimeX->value(), txtTimeY->value());
             int timeLevelIndex = Agros2D::solutionStore()->nthCalculatedTimeStep(fieldWidget->selectedField(), i);
             LocalValue *localValue = fieldWidget->selectedField()->plugin()->localValue(fieldWidget->selectedField(),
                                                                                         timeLevelIndex,
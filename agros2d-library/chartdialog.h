@@ -132,6 +132,9 @@ private:
 
     ChartView *m_chart;
 
+    // point recorded for the time chart (only the last plotted point is recorded)
+    int m_probeID;
+
     void createControls();
 
     QVector<double> horizontalAxisValues(ChartLine *chartLine);
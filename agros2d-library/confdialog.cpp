@@ -66,6 +66,7 @@ void ConfigComputerDialog::load()
 
     // number of threads
     txtNumOfThreads->setValue(Agros2D::configComputer()->numberOfThreads);
+    txtNumOfParallelBlocks->setValue(Agros2D::configComputer()->numberOfParallelBlocks);
 
     // cache size
     txtCacheSize->setValue(Agros2D::configComputer()->cacheSize);
@@ -96,6 +97,7 @@ void ConfigComputerDialog::save()
 
     // number of threads
     Agros2D::configComputer()->numberOfThreads = txtNumOfThreads->value();
+    Agros2D::configComputer()->numberOfParallelBlocks = txtNumOfParallelBlocks->value();
 
     // cache size
     Agros2D::configComputer()->cacheSize = txtCacheSize->value();
@@ -219,18 +221,25 @@ QWidget *ConfigComputerDialog::createSolverWidget()
 {
     // general
     txtCacheSize = new QSpinBox(this);
-    txtCacheSize->setMinimum(2);
-    txtCacheSize->setMaximum(50);
+    txtCacheSize->setMinimum(CACHE_SIZE_MIN);
+    txtCacheSize->setMaximum(CACHE_SIZE_MAX);
+    txtCacheSize->setSuffix(" MB");
 
     txtNumOfThreads = new QSpinBox(this);
     txtNumOfThreads->setMinimum(1);
     txtNumOfThreads->setMaximum(omp_get_max_threads());
 
+    txtNumOfParallelBlocks = new QSpinBox(this);
+    txtNumOfParallelBlocks->setMinimum(1);
+    txtNumOfParallelBlocks->setMaximum(omp_get_max_threads());
+
     QGridLayout *layoutSolver = new QGridLayout();
     layoutSolver->addWidget(new QLabel(tr("Number of threads:")), 0, 0);
     layoutSolver->addWidget(txtNumOfThreads, 0, 1);
-    layoutSolver->addWidget(new QLabel(tr("Number of cache slots:")), 1, 0);
-    layoutSolver->addWidget(txtCacheSize, 1, 1);
+    layoutSolver->addWidget(new QLabel(tr("Parallel blocks:")), 1, 0);
+    layoutSolver->addWidget(txtNumOfParallelBlocks, 1, 1);
+    layoutSolver->addWidget(new QLabel(tr("Solution cache size:")), 2, 0);
+    layoutSolver->addWidget(txtCacheSize, 2, 1);
 
     QGroupBox *grpSolver = new QGroupBox(tr("Solver"));
     grpSolver->setLayout(layoutSolver);
@@ -66,6 +66,7 @@ private:
 
     // threads
     QSpinBox *txtNumOfThreads;
+    QSpinBox *txtNumOfParallelBlocks;
 
     void load();
     void save();
@@ -232,6 +232,8 @@ public:
     void deleteValuePointerTable();
 
     const Value** valuePointerTable(QString id) const;
+    // postprocessor uses all module variables, the table contains variables of the analysis only
+    inline bool hasValuePointerTable(const QString &id) const { return m_valuePointersTable.contains(id); }
     int hermesMarkerToAgrosLabel(int hermesMarker) const;
     double labelArea(int agrosLabel) const;
     inline double frequency() const { return m_frequency; }
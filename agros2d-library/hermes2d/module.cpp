@@ -1095,18 +1095,22 @@ void Module::DialogUI::clear()
 
 // ***********************************************************************************************
 
-AGROS_LIBRARY_API void Module::updateTimeFunctions(double time)
+AGROS_LIBRARY_API void Module::updateTimeFunctions(double time, const FieldInfo *fieldInfo)
 {
+    // blocks are solved concurrently, expressions could be evaluated by Python
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
     // update materials
     foreach (SceneMaterial *material, Agros2D::scene()->materials->items())
-        if (material->fieldInfo())
+        if (material->fieldInfo() && (!fieldInfo || material->fieldInfo() == fieldInfo))
             foreach (Module::MaterialTypeVariable variable, material->fieldInfo()->materialTypeVariables())
                 if (variable.isTimeDep() && material->fieldInfo()->analysisType() == AnalysisType_Transient)
                     material->evaluate(variable.id(), time);
 
     // update boundaries
     foreach (SceneBoundary *boundary, Agros2D::scene()->boundaries->items())
-        if (boundary->fieldInfo())
+        if (boundary->fieldInfo() && (!fieldInfo || boundary->fieldInfo() == fieldInfo))
             foreach (Module::BoundaryType boundaryType, boundary->fieldInfo()->boundaryTypes())
                 foreach (Module::BoundaryTypeVariable variable, boundaryType.variables())
                     if (variable.isTimeDep() && boundary->fieldInfo()->analysisType() == AnalysisType_Transient)
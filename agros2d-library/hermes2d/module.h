@@ -568,7 +568,8 @@ private:
 };
 
 // functions
-AGROS_LIBRARY_API void updateTimeFunctions(double time);
+// updates time dependent values of all fields (or of the given field only)
+AGROS_LIBRARY_API void updateTimeFunctions(double time, const FieldInfo *fieldInfo = NULL);
 
 // available modules
 AGROS_LIBRARY_API QMap<QString, QString> availableModules();
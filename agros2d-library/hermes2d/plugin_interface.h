@@ -142,19 +142,29 @@ class LocalValue
 {
 public:
     LocalValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType, const Point &point)
-        : m_fieldInfo(fieldInfo), m_timeStep(timeStep), m_adaptivityStep(adaptivityStep), m_solutionType(solutionType), m_point(point) {}
+        : m_fieldInfo(fieldInfo), m_timeStep(timeStep), m_adaptivityStep(adaptivityStep), m_solutionType(solutionType), m_point(point)
+    {
+        m_points.append(point);
+    }
+    LocalValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType, const QList<Point> &points)
+        : m_fieldInfo(fieldInfo), m_timeStep(timeStep), m_adaptivityStep(adaptivityStep), m_solutionType(solutionType),
+          m_point(points.isEmpty() ? Point() : points.first()), m_points(points) {}
 
     // point
     inline Point point() { return m_point; }
+    inline QList<Point> points() const { return m_points; }
 
     // variables
     QMap<QString, LocalPointValue> values() const { return m_values; }
+    // variables in the points (empty for points outside of the mesh)
+    inline QList<QMap<QString, LocalPointValue> > pointValues() const { return m_pointValues; }
 
     virtual void calculate() = 0;
 
 protected:
     // point
     Point m_point;
+    QList<Point> m_points;
     // field info
     const FieldInfo *m_fieldInfo;
     int m_timeStep;
@@ -163,6 +173,7 @@ protected:
 
     // variables
     QMap<QString, LocalPointValue> m_values;
+    QList<QMap<QString, LocalPointValue> > m_pointValues;
 };
 
 class IntegralValue
@@ -173,6 +184,8 @@ public:
 
     // variables
     inline QMap<QString, double> values() const { return m_values; }
+    // variables of the regions (batch calculation)
+    inline QList<QMap<QString, double> > regionValues() const { return m_regionValues; }
 
 protected:
     // field info
@@ -183,6 +196,7 @@ protected:
 
     // variables
     QMap<QString, double> m_values;
+    QList<QMap<QString, double> > m_regionValues;
 };
 
 const int OFFSET_NON_DEF = -100;
@@ -306,13 +320,24 @@ public:
 
     // local values
     virtual LocalValue *localValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType, const Point &point) = 0;
+    // local values in many points in one pass (elements are found by the hash grid of the mesh)
+    virtual LocalValue *localValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType, const QList<Point> &points) = 0;
     // surface integrals
     virtual IntegralValue *surfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType) = 0;
+    // surface integrals over sets of edges in one pass (scene selection is not used)
+    virtual IntegralValue *surfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                           const QList<QList<int> > &edges) = 0;
     // volume integrals
     virtual IntegralValue *volumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType) = 0;
+    // volume integrals over sets of labels in one pass (scene selection is not used)
+    virtual IntegralValue *volumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                          const QList<QList<int> > &labels) = 0;
     // force calculation
     virtual Point3 force(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
                          Hermes::Hermes2D::Element *element, SceneMaterial *material, const Point3 &point, const Point3 &velocity) = 0;
+    // force calculation with the given solutions (time functions are not updated, solutions must not be shared between threads)
+    virtual Point3 force(const FieldInfo *fieldInfo, int timeStep, const Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > &solutions,
+                         Hermes::Hermes2D::Element *element, SceneMaterial *material, const Point3 &point, const Point3 &velocity) = 0;
     virtual bool hasForce(const FieldInfo *fieldInfo) = 0;
 
     // localization
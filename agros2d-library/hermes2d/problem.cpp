@@ -232,6 +232,7 @@ void Problem::addField(FieldInfo *field)
 void Problem::removeField(FieldInfo *field)
 {
     clearSolution();
+    Agros2D::solutionStore()->removeProbes(field);
 
     // first remove references to markers of this field from all edges and labels
     Agros2D::scene()->edges->removeFieldMarkers(field);
@@ -460,11 +461,10 @@ double Problem::timeStepToTime(int timeStepIndex) const
 
 double Problem::timeStepToTotalTime(int timeStepIndex) const
 {
-    double time = 0;
-    for(int ts = 0; ts < timeStepIndex; ts++)
-        time += m_timeStepLengths[ts];
+    if (timeStepIndex <= 0)
+        return 0.0;
 
-    return time;
+    return m_timeStepTotalTimes[timeStepIndex - 1];
 }
 
 int Problem::timeToTimeStep(double time) const
@@ -521,6 +521,13 @@ void Problem::refuseLastTimeStepLength()
 
 void Problem::updateActualTimeDuringCalculation()
 {
+    // time step lengths are only appended or removed from the end
+    while (m_timeStepTotalTimes.size() > m_timeStepLengths.size())
+        m_timeStepTotalTimes.removeLast();
+    while (m_timeStepTotalTimes.size() < m_timeStepLengths.size())
+        m_timeStepTotalTimes.append((m_timeStepTotalTimes.isEmpty() ? 0.0 : m_timeStepTotalTimes.last()) +
+                                    m_timeStepLengths[m_timeStepTotalTimes.size()]);
+
     m_actualTime = timeStepToTotalTime(m_timeStepLengths.size());
 }
 
@@ -780,73 +787,23 @@ void Problem::solveAction()
         solvers[block].data()->createInitialSpace();
     }
 
+    // independent blocks (without weak coupling between them) can be solved concurrently
+    QList<QList<Block *> > levels;
+    if (Agros2D::configComputer()->numberOfParallelBlocks > 1)
+        levels = blockLevels();
+    else
+        foreach (Block* block, m_blocks)
+            levels.append(QList<Block *>() << block);
+
     TimeStepInfo nextTimeStep(config()->initialTimeStepLength());
     bool doNextTimeStep = true;
     do
     {
-        foreach (Block* block, m_blocks)
+        foreach (QList<Block *> level, levels)
         {
-            if (block->isTransient() && (actualTimeStep() == 0))
-            {
-                solvers[block]->solveInitialTimeStep();
-            }
-            else if(!skipThisTimeStep(block))
-            {
-                stepMessage(block);
-                if (block->adaptivityType() == AdaptivityType_None)
-                {
-                    // no adaptivity
-                    solvers[block]->solveSimple(actualTimeStep(), 0);
-                }
-                else
-                {
-                    // adaptivity
-                    int adaptStep = 1;
-                    bool doContinueAdaptivity = true;
-                    while (doContinueAdaptivity && (adaptStep <= block->adaptivitySteps()) && !m_abort)
-                    {
-                        // solve problem
-                        solvers[block]->solveReferenceAndProject(actualTimeStep(), adaptStep - 1);
-                        // create adapted space
-                        doContinueAdaptivity = solvers[block]->createAdaptedSpace(actualTimeStep(), adaptStep);
-
-                        // Python callback
-                        foreach (Field *field, block->fields())
-                        {
-                            QString command = QString("(agros2d.field(\"%1\").adaptivity_callback(%2) if (agros2d.field(\"%1\").adaptivity_callback is not None and hasattr(agros2d.field(\"%1\").adaptivity_callback, '__call__')) else True)").
-                                    arg(field->fieldInfo()->fieldId()).
-                                    arg(adaptStep - 1);
-
-                            double cont = 1.0;
-                            bool successfulRun = currentPythonEngine()->runExpression(command, &cont);
-                            if (!successfulRun)
-                            {
-                                ErrorResult result = currentPythonEngine()->parseError();
-                                Agros2D::log()->printError(QObject::tr("Adaptivity callback"), result.error());
-                            }
-
-                            if (!cont)
-                                doContinueAdaptivity = false;
-                            break;
-                        }
-
-                        adaptStep++;
-                    }
-                }
-
-                // TODO: it should be estimated in the first step as well
-                // TODO: what if more blocks are transient? (take minimum? )
-
-                // TODO: space + time adaptivity
-                if (block->isTransient() && (actualTimeStep() >= 1))
-                {
-                    nextTimeStep = solvers[block]->estimateTimeStepLength(actualTimeStep(), 0);
-
-                    //save actual time and indicator, whether calculation on this time was refused
-                    m_timeHistory.push_back(QPair<double, bool>(actualTime(), nextTimeStep.refuse));
-                    //qDebug() << nextTimeStep.length << ", " << actualTime() << ", " << nextTimeStep.refuse;
-                }
-            }
+            solveBlocks(level, solvers, nextTimeStep);
+            if (m_abort)
+                break;
         }
 
         doNextTimeStep = false;
@@ -886,6 +843,198 @@ void Problem::solveAction()
                 doNextTimeStep = defineActualTimeStepLength(nextTimeStep.length);
         }
     } while (doNextTimeStep && !m_abort);
+
+    // wait for solutions written in the background
+    Agros2D::solutionStore()->flush();
+}
+
+// solves one block of the level in its own thread
+class BlockSolverThread : public QThread
+{
+public:
+    BlockSolverThread(Problem *problem, Block *block, QSharedPointer<ProblemSolver<double> > solver, TimeStepInfo nextTimeStep)
+        : QThread(), m_problem(problem), m_block(block), m_solver(solver), m_nextTimeStep(nextTimeStep) {}
+
+    inline Block *block() const { return m_block; }
+    inline TimeStepInfo nextTimeStep() const { return m_nextTimeStep; }
+    inline std::exception_ptr exception() const { return m_exception; }
+
+protected:
+    virtual void run()
+    {
+        try
+        {
+            m_problem->solveBlock(m_block, m_solver, m_nextTimeStep);
+        }
+        catch (...)
+        {
+            // rethrown in the calculation thread
+            m_exception = std::current_exception();
+        }
+    }
+
+private:
+    Problem *m_problem;
+    Block *m_block;
+    QSharedPointer<ProblemSolver<double> > m_solver;
+    TimeStepInfo m_nextTimeStep;
+    std::exception_ptr m_exception;
+};
+
+QList<QList<Block *> > Problem::blockLevels() const
+{
+    QList<QList<Block *> > levels;
+    QMap<Block *, int> blockLevel;
+
+    // blocks are created in order of weak couplings (source field first)
+    foreach (Block *block, m_blocks)
+    {
+        int level = 0;
+        foreach (CouplingInfo *couplingInfo, m_couplingInfos)
+        {
+            if (couplingInfo->isWeak() && block->contains(couplingInfo->targetField()))
+            {
+                Block *sourceBlock = blockOfField(couplingInfo->sourceField());
+                if ((sourceBlock != block) && blockLevel.contains(sourceBlock))
+                    level = qMax(level, blockLevel[sourceBlock] + 1);
+            }
+        }
+
+        blockLevel[block] = level;
+        while (levels.count() <= level)
+            levels.append(QList<Block *>());
+        levels[level].append(block);
+    }
+
+    return levels;
+}
+
+void Problem::solveBlocks(const QList<Block *> &blocks, QMap<Block*, QSharedPointer<ProblemSolver<double> > > &solvers, TimeStepInfo &nextTimeStep)
+{
+    int numberOfThreads = Agros2D::configComputer()->numberOfThreads;
+    int parallelBlocks = qMin(blocks.count(), qMin(Agros2D::configComputer()->numberOfParallelBlocks, numberOfThreads));
+
+    // matrix solver type is a global Hermes setting, PARALUTION has global initialization and backend
+    foreach (Block* block, blocks)
+        if ((block->matrixSolver() != blocks.first()->matrixSolver()) || isMatrixSolverIterative(block->matrixSolver()))
+            parallelBlocks = 1;
+
+    if (parallelBlocks <= 1)
+    {
+        foreach (Block* block, blocks)
+            solveBlock(block, solvers[block], nextTimeStep);
+
+        return;
+    }
+
+    // thread budget is split between blocks and assembly
+    // actual time and time step lengths are changed only between levels, solvers read them
+    Hermes::HermesCommonApi.set_integral_param_value(Hermes::numThreads, qMax(1, numberOfThreads / parallelBlocks));
+
+    std::exception_ptr exception;
+    for (int first = 0; first < blocks.count(); first += parallelBlocks)
+    {
+        QList<BlockSolverThread *> threads;
+        for (int i = first; i < qMin(first + parallelBlocks, blocks.count()); i++)
+        {
+            BlockSolverThread *thread = new BlockSolverThread(this, blocks[i], solvers[blocks[i]], nextTimeStep);
+            thread->start();
+            threads.append(thread);
+        }
+
+        foreach (BlockSolverThread *thread, threads)
+        {
+            thread->wait();
+
+            if (thread->exception())
+            {
+                if (!exception)
+                    exception = thread->exception();
+            }
+            else if (thread->block()->isTransient())
+            {
+                nextTimeStep = thread->nextTimeStep();
+            }
+
+            delete thread;
+        }
+
+        if (exception || m_abort)
+            break;
+    }
+
+    Hermes::HermesCommonApi.set_integral_param_value(Hermes::numThreads, numberOfThreads);
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void Problem::solveBlock(Block *block, QSharedPointer<ProblemSolver<double> > solver, TimeStepInfo &nextTimeStep)
+{
+    if (block->isTransient() && (actualTimeStep() == 0))
+    {
+        solver->solveInitialTimeStep();
+    }
+    else if(!skipThisTimeStep(block))
+    {
+        stepMessage(block);
+        if (block->adaptivityType() == AdaptivityType_None)
+        {
+            // no adaptivity
+            solver->solveSimple(actualTimeStep(), 0);
+        }
+        else
+        {
+            // adaptivity
+            int adaptStep = 1;
+            bool doContinueAdaptivity = true;
+            while (doContinueAdaptivity && (adaptStep <= block->adaptivitySteps()) && !m_abort)
+            {
+                // solve problem
+                solver->solveReferenceAndProject(actualTimeStep(), adaptStep - 1);
+                // create adapted space
+                doContinueAdaptivity = solver->createAdaptedSpace(actualTimeStep(), adaptStep);
+
+                // Python callback
+                foreach (Field *field, block->fields())
+                {
+                    QString command = QString("(agros2d.field(\"%1\").adaptivity_callback(%2) if (agros2d.field(\"%1\").adaptivity_callback is not None and hasattr(agros2d.field(\"%1\").adaptivity_callback, '__call__')) else True)").
+                            arg(field->fieldInfo()->fieldId()).
+                            arg(adaptStep - 1);
+
+                    double cont = 1.0;
+                    QMutexLocker locker(&m_solveMutex);
+                    bool successfulRun = currentPythonEngine()->runExpression(command, &cont);
+                    if (!successfulRun)
+                    {
+                        ErrorResult result = currentPythonEngine()->parseError();
+                        Agros2D::log()->printError(QObject::tr("Adaptivity callback"), result.error());
+                    }
+
+                    if (!cont)
+                        doContinueAdaptivity = false;
+                    break;
+                }
+
+                adaptStep++;
+            }
+        }
+
+        // TODO: it should be estimated in the first step as well
+        // TODO: what if more blocks are transient? (take minimum? )
+
+        // TODO: space + time adaptivity
+        if (block->isTransient() && (actualTimeStep() >= 1))
+        {
+            nextTimeStep = solver->estimateTimeStepLength(actualTimeStep(), 0);
+
+            //save actual time and indicator, whether calculation on this time was refused
+            QMutexLocker locker(&m_solveMutex);
+            m_timeHistory.push_back(QPair<double, bool>(actualTime(), nextTimeStep.refuse));
+            //qDebug() << nextTimeStep.length << ", " << actualTime() << ", " << nextTimeStep.refuse;
+        }
+    }
+
 }
 
 void Problem::stepMessage(Block* block)
@@ -1040,7 +1189,7 @@ void Problem::readSolutionsFromFile()
 {
     Agros2D::log()->printMessage(tr("Problem"), tr("Loading spaces and solutions from disk"));
 
-    if (QFile::exists(QString("%1/runtime.xml").arg(cacheProblemDir())))
+    if (SolutionStore::hasRunTimeDetails())
     {
         // load structure
         Agros2D::solutionStore()->loadRunTimeDetails();
@@ -1050,6 +1199,10 @@ void Problem::readSolutionsFromFile()
             block->createBoundaryConditions();
         }
 
+        // material tables of the labels (used by the postprocessor)
+        foreach (FieldInfo* fieldInfo, m_fieldInfos)
+            fieldInfo->createValuePointerTable();
+
         // emit solve
         emit solved();
     }
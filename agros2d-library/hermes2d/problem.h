@@ -13,6 +13,11 @@ class Problem;
 class ProblemConfig;
 class ProblemSetting;
 class PyProblem;
+class BlockSolverThread;
+
+struct TimeStepInfo;
+template <typename Scalar>
+class ProblemSolver;
 
 class CalculationThread : public QThread
 {
@@ -184,6 +189,8 @@ private:
     bool m_isNonlinear;
 
     QList<double> m_timeStepLengths;
+    // total time after each time step (prefix sums of m_timeStepLengths)
+    QList<double> m_timeStepTotalTimes;
     double m_actualTime;
 
     // has to be called allways when m_timeStepLengths are modified during the calculation
@@ -199,9 +206,18 @@ private:
     void solve(bool commandLine);
     void solveAction(); // called by solve, can throw SolverException
 
+    // blocks grouped by weak couplings, blocks in one level are independent
+    QList<QList<Block *> > blockLevels() const;
+    void solveBlocks(const QList<Block *> &blocks, QMap<Block*, QSharedPointer<ProblemSolver<double> > > &solvers, TimeStepInfo &nextTimeStep);
+    void solveBlock(Block *block, QSharedPointer<ProblemSolver<double> > solver, TimeStepInfo &nextTimeStep);
+
+    // serializes Python callbacks and time history of blocks solved in parallel
+    QMutex m_solveMutex;
+
     void stepMessage(Block* block);    
 
     friend class CalculationThread;
+    friend class BlockSolverThread;
     friend class PyProblem;
     friend class AgrosSolver;
 
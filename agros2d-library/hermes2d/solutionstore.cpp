@@ -28,25 +28,608 @@
 #include "scene.h"
 #include "problem.h"
 #include "problem_config.h"
+#include "plugin_interface.h"
+#include "particle/mesh_hash.h"
+
+#include <QtEndian>
 
 #include "../../resources_source/classes/structure_xml.h"
+#include "../../3rdparty/quazip/JlCompress.h"
 
 using namespace Hermes::Hermes2D;
 
+const QString RUNTIME_MANIFEST_FILENAME = "runtime.bin";
+const quint32 RUNTIME_MANIFEST_MAGIC = 0x41324452;
+const quint32 RUNTIME_MANIFEST_VERSION = 1;
+
+const QString RUNTIME_INDEX_FILENAME = "runtime.idx";
+const quint32 RUNTIME_INDEX_MAGIC = 0x41324449;
+const quint32 RUNTIME_INDEX_VERSION = 1;
+// record, solution mode, length of field id, reserved, time step, adaptivity step, time step length, offset, field id
+const int RUNTIME_INDEX_FIELDID_SIZE = 36;
+const int RUNTIME_INDEX_ENTRY_SIZE = 4 + 2 * 4 + 2 * 8 + RUNTIME_INDEX_FIELDID_SIZE;
+const quint8 RUNTIME_INDEX_FIELDID_NOT_INDEXED = 0xFF;
+
+SolutionStoreWriter::SolutionStoreWriter(int queueSize) : QThread(),
+    m_queueSize(queueSize), m_isWriting(false), m_stop(false)
+{
+}
+
+SolutionStoreWriter::~SolutionStoreWriter()
+{
+    m_mutex.lock();
+    m_stop = true;
+    m_queueNotEmpty.wakeAll();
+    m_mutex.unlock();
+
+    wait();
+}
+
+void SolutionStoreWriter::enqueue(const Task &task)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!isRunning())
+        start(QThread::LowPriority);
+
+    while (m_queue.size() >= m_queueSize)
+        m_queueNotFull.wait(&m_mutex);
+
+    m_queue.enqueue(task);
+    foreach (QString fileName, task.fileNames())
+        m_pendingFiles.insert(fileName);
+    m_queueNotEmpty.wakeOne();
+}
+
+void SolutionStoreWriter::flush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (!m_queue.isEmpty() || m_isWriting)
+        m_queueDrained.wait(&m_mutex);
+}
+
+void SolutionStoreWriter::waitForFiles(const QStringList &fileNames)
+{
+    QMutexLocker locker(&m_mutex);
+
+    foreach (QString fileName, fileNames)
+        while (m_pendingFiles.contains(fileName))
+            m_taskWritten.wait(&m_mutex);
+}
+
+QStringList SolutionStoreWriter::takeErrors()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QStringList errors = m_errors;
+    m_errors.clear();
+
+    return errors;
+}
+
+void SolutionStoreWriter::run()
+{
+    while (true)
+    {
+        Task task;
+
+        m_mutex.lock();
+        while (m_queue.isEmpty() && !m_stop)
+            m_queueNotEmpty.wait(&m_mutex);
+
+        if (m_queue.isEmpty() && m_stop)
+        {
+            m_mutex.unlock();
+            return;
+        }
+
+        task = m_queue.dequeue();
+        m_isWriting = true;
+        m_queueNotFull.wakeOne();
+        m_mutex.unlock();
+
+        QString error;
+        try
+        {
+            write(task);
+        }
+        catch (Hermes::Exceptions::Exception &e)
+        {
+            error = QString::fromStdString(e.what());
+        }
+        catch (AgrosException &e)
+        {
+            error = e.toString();
+        }
+        catch (std::exception &e)
+        {
+            error = QString::fromStdString(e.what());
+        }
+        catch (...)
+        {
+            error = QObject::tr("Unknown error while writing the solution.");
+        }
+
+        m_mutex.lock();
+        if (!error.isEmpty())
+            m_errors.append(error);
+        m_isWriting = false;
+        foreach (QString fileName, task.fileNames())
+            m_pendingFiles.remove(fileName);
+        m_taskWritten.wakeAll();
+        if (m_queue.isEmpty())
+            m_queueDrained.wakeAll();
+        m_mutex.unlock();
+    }
+}
+
+// exceptions are caught in run(), log is not accessible from the writer thread
+void SolutionStoreWriter::write(const Task &task)
+{
+    // meshes
+    for (int i = 0; i < task.meshFileNames.size(); i++)
+        Module::writeMeshToFileBSON(task.meshFileNames[i], task.meshes[i]);
+
+    // spaces
+    for (int i = 0; i < task.spaceFileNames.size(); i++)
+        task.spaces[i]->save_bson(compatibleFilename(task.spaceFileNames[i]).toStdString().c_str());
+
+    // solutions
+    for (int i = 0; i < task.solutionFileNames.size(); i++)
+        dynamic_cast<Hermes::Hermes2D::Solution<double> *>(task.solutions[i].get())->save_bson(compatibleFilename(task.solutionFileNames[i]).toStdString().c_str());
+}
+
+// ************************************************************************************
+
+SolutionArchive::SolutionArchive() : m_zip(NULL)
+{
+}
+
+SolutionArchive::~SolutionArchive()
+{
+    close();
+}
+
+QString SolutionArchive::fileName() const
+{
+    return m_zip ? m_zip->getZipName() : QString();
+}
+
+bool SolutionArchive::open(const QString &fileName)
+{
+    close();
+
+    m_zip = new QuaZip(fileName);
+    if (!m_zip->open(QuaZip::mdUnzip))
+    {
+        close();
+        return false;
+    }
+
+    // positions of entries
+    for (bool more = m_zip->goToFirstFile(); more; more = m_zip->goToNextFile())
+    {
+        unz_file_pos position;
+        unzGetFilePos(m_zip->getUnzFile(), &position);
+
+        m_entries[m_zip->getCurrentFileName()] = QPair<qulonglong, qulonglong>(position.pos_in_zip_directory, position.num_of_file);
+    }
+
+    return true;
+}
+
+void SolutionArchive::close()
+{
+    if (m_zip)
+    {
+        m_zip->close();
+        delete m_zip;
+        m_zip = NULL;
+    }
+
+    m_entries.clear();
+}
+
+bool SolutionArchive::goToEntry(const QString &entry)
+{
+    if (!m_zip || !m_entries.contains(entry))
+        return false;
+
+    // move to the entry without scanning of the central directory
+    unz_file_pos position;
+    position.pos_in_zip_directory = m_entries[entry].first;
+    position.num_of_file = m_entries[entry].second;
+
+    if (!m_zip->hasCurrentFile())
+        m_zip->goToFirstFile();
+
+    return (unzGoToFilePos(m_zip->getUnzFile(), &position) == UNZ_OK);
+}
+
+bool SolutionArchive::extract(const QString &entry, const QString &dir)
+{
+    if (!goToEntry(entry))
+        return false;
+
+    QuaZipFile inFile(m_zip);
+    if (!inFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QFile outFile(QString("%1/%2").arg(dir).arg(entry));
+    if (!outFile.open(QIODevice::WriteOnly))
+        return false;
+
+    outFile.write(inFile.readAll());
+    outFile.close();
+    inFile.close();
+
+    return (inFile.getZipError() == UNZ_OK);
+}
+
+bool SolutionArchive::save(const QString &fileName, const QStringList &entries, const QString &dir)
+{
+    // new archive replaces the target when it is complete
+    QString fnTemp = QString("%1.tmp").arg(fileName);
+    if (QFile::exists(fnTemp))
+        QFile::remove(fnTemp);
+
+    QuaZip zip(fnTemp);
+    if (!zip.open(QuaZip::mdCreate))
+        return false;
+
+    bool ok = true;
+    foreach (QString entry, entries)
+    {
+        QFile inFile(QString("%1/%2").arg(dir).arg(entry));
+        if (inFile.exists())
+        {
+            if (!inFile.open(QIODevice::ReadOnly))
+            {
+                ok = false;
+                break;
+            }
+
+            QuaZipFile outFile(&zip);
+            if (!outFile.open(QIODevice::WriteOnly, QuaZipNewInfo(entry, inFile.fileName())))
+            {
+                ok = false;
+                break;
+            }
+
+            outFile.write(inFile.readAll());
+            outFile.close();
+            inFile.close();
+
+            if (outFile.getZipError() != ZIP_OK)
+            {
+                ok = false;
+                break;
+            }
+        }
+        else if (goToEntry(entry))
+        {
+            // copy of the compressed data
+            QuaZipFileInfo info;
+            m_zip->getCurrentFileInfo(&info);
+
+            int method = 0;
+            int level = 0;
+            QuaZipFile rawInFile(m_zip);
+            if (!rawInFile.open(QIODevice::ReadOnly, &method, &level, true))
+            {
+                ok = false;
+                break;
+            }
+
+            QuaZipNewInfo newInfo(entry);
+            newInfo.dateTime = info.dateTime;
+            newInfo.uncompressedSize = info.uncompressedSize;
+
+            QuaZipFile rawOutFile(&zip);
+            if (!rawOutFile.open(QIODevice::WriteOnly, newInfo, NULL, info.crc, method, level, true))
+            {
+                ok = false;
+                break;
+            }
+
+            rawOutFile.write(rawInFile.readAll());
+            rawInFile.close();
+            rawOutFile.close();
+
+            if ((rawInFile.getZipError() != UNZ_OK) || (rawOutFile.getZipError() != ZIP_OK))
+            {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    zip.close();
+    if (!ok || (zip.getZipError() != ZIP_OK))
+    {
+        QFile::remove(fnTemp);
+        return false;
+    }
+
+    // replace the target
+    QString fnOld = this->fileName();
+    close();
+    if ((QFile::exists(fileName) && !QFile::remove(fileName)) || !QFile::rename(fnTemp, fileName))
+    {
+        QFile::remove(fnTemp);
+        if (!fnOld.isEmpty())
+            open(fnOld);
+        return false;
+    }
+
+    return open(fileName);
+}
+
+// ************************************************************************************
+
+SolutionStore::SolutionStore() : m_mutex(QMutex::Recursive), m_multiSolutionCounter(0), m_multiSolutionCacheMemorySize(0), m_probeCounter(0)
+{
+    m_writer = new SolutionStoreWriter(SOLUTION_STORE_WRITE_QUEUE_SIZE);
+    m_archive = new SolutionArchive();
+}
+
 void SolutionStore::printDebugCacheStatus()
 {
     assert(m_multiSolutionCacheIDOrder.size() == m_multiSolutionCache.keys().size());
     qDebug() << "solution store cache status:";
+    qDebug() << QString("memory: %1 MB / %2 MB, hits: %3, misses: %4, evictions: %5").
+                arg(m_multiSolutionCacheMemorySize / 1024.0 / 1024.0).
+                arg(Agros2D::configComputer()->cacheSize).
+                arg(m_cacheStatistics.hits).
+                arg(m_cacheStatistics.misses).
+                arg(m_cacheStatistics.evictions);
     foreach(FieldSolutionID fsid, m_multiSolutionCacheIDOrder)
     {
         assert(m_multiSolutionCache.keys().contains(fsid));
-        qDebug() << fsid.toString();
+        qDebug() << fsid.toString() << m_multiSolutionCacheMemorySizes[fsid];
     }
 }
 
 SolutionStore::~SolutionStore()
 {
     clearAll();
+
+    delete m_writer;
+    delete m_archive;
+}
+
+void SolutionStore::flush()
+{
+    m_writer->flush();
+
+    printWriterErrors();
+}
+
+void SolutionStore::printWriterErrors()
+{
+    foreach (QString error, m_writer->takeErrors())
+        Agros2D::log()->printError(QObject::tr("Solver"), error);
+}
+
+bool SolutionStore::Probe::operator==(const Probe &probe) const
+{
+    return ((fieldInfo == probe.fieldInfo) && (type == probe.type) &&
+            ((point - probe.point).magnitude() < EPS_ZERO) && (regions == probe.regions));
+}
+
+int SolutionStore::addProbe(const Probe &probe)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int id = findProbe(probe);
+    if (id != -1)
+        return id;
+
+    id = m_probeCounter++;
+    m_probes[id] = probe;
+    m_probeSeries[id] = ProbeSeries();
+
+    return id;
+}
+
+int SolutionStore::findProbe(const Probe &probe) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (QMap<int, Probe>::const_iterator it = m_probes.constBegin(); it != m_probes.constEnd(); ++it)
+        if (it.value() == probe)
+            return it.key();
+
+    return -1;
+}
+
+bool SolutionStore::hasProbe(int id) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_probes.contains(id);
+}
+
+void SolutionStore::removeProbe(int id)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_probes.remove(id);
+    m_probeSeries.remove(id);
+}
+
+void SolutionStore::removeProbes(const FieldInfo *fieldInfo)
+{
+    QMutexLocker locker(&m_mutex);
+
+    foreach (int id, m_probes.keys())
+    {
+        if (!fieldInfo || m_probes[id].fieldInfo == fieldInfo)
+        {
+            m_probes.remove(id);
+            m_probeSeries.remove(id);
+        }
+    }
+}
+
+SolutionStore::Probe SolutionStore::probe(int id) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_probes.value(id);
+}
+
+SolutionStore::ProbeSeries SolutionStore::probeSeries(int id) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_probeSeries.value(id);
+}
+
+void SolutionStore::recordProbes(FieldSolutionID solutionID)
+{
+    // reference solutions are not recorded
+    if (solutionID.solutionMode != SolutionMode_Normal)
+        return;
+
+    FieldInfo *fieldInfo = solutionID.group;
+
+    QList<int> localIds;
+    QList<Point> points;
+    QList<int> surfaceIds;
+    QList<QList<int> > edges;
+    QList<int> volumeIds;
+    QList<QList<int> > labels;
+
+    for (QMap<int, Probe>::const_iterator it = m_probes.constBegin(); it != m_probes.constEnd(); ++it)
+    {
+        const Probe &probe = it.value();
+        if (probe.fieldInfo != fieldInfo)
+            continue;
+
+        if (probe.type == ProbeType_LocalValue)
+        {
+            localIds.append(it.key());
+            points.append(probe.point);
+        }
+        else if (probe.type == ProbeType_SurfaceIntegral)
+        {
+            surfaceIds.append(it.key());
+            edges.append(probe.regions);
+        }
+        else if (probe.type == ProbeType_VolumeIntegral)
+        {
+            volumeIds.append(it.key());
+            labels.append(probe.regions);
+        }
+    }
+
+    try
+    {
+        if (!points.isEmpty())
+        {
+            LocalValue *value = fieldInfo->plugin()->localValue(fieldInfo, solutionID.timeStep, solutionID.adaptivityStep, solutionID.solutionMode, points);
+            QList<QMap<QString, LocalPointValue> > pointValues = value->pointValues();
+            for (int i = 0; i < localIds.count(); i++)
+            {
+                QMap<QString, double> scalars;
+                QMap<QString, Point> vectors;
+
+                QMapIterator<QString, LocalPointValue> it(pointValues.at(i));
+                while (it.hasNext())
+                {
+                    it.next();
+
+                    if (fieldInfo->localVariable(it.key()).isScalar())
+                        scalars[it.key()] = it.value().scalar;
+                    else
+                        vectors[it.key()] = it.value().vector;
+                }
+
+                recordProbe(localIds.at(i), solutionID.timeStep, scalars, vectors);
+            }
+            delete value;
+        }
+
+        if (!edges.isEmpty())
+        {
+            IntegralValue *value = fieldInfo->plugin()->surfaceIntegral(fieldInfo, solutionID.timeStep, solutionID.adaptivityStep, solutionID.solutionMode, edges);
+            for (int i = 0; i < surfaceIds.count(); i++)
+                recordProbe(surfaceIds.at(i), solutionID.timeStep, value->regionValues().at(i), QMap<QString, Point>());
+            delete value;
+        }
+
+        if (!labels.isEmpty())
+        {
+            IntegralValue *value = fieldInfo->plugin()->volumeIntegral(fieldInfo, solutionID.timeStep, solutionID.adaptivityStep, solutionID.solutionMode, labels);
+            for (int i = 0; i < volumeIds.count(); i++)
+                recordProbe(volumeIds.at(i), solutionID.timeStep, value->regionValues().at(i), QMap<QString, Point>());
+            delete value;
+        }
+    }
+    catch (Hermes::Exceptions::Exception &e)
+    {
+        Agros2D::log()->printWarning(QObject::tr("Probes"), QObject::tr("Probes of the field '%1' cannot be evaluated: %2").arg(fieldInfo->name()).arg(QString::fromStdString(e.what())));
+    }
+    catch (AgrosException &e)
+    {
+        Agros2D::log()->printWarning(QObject::tr("Probes"), QObject::tr("Probes of the field '%1' cannot be evaluated: %2").arg(fieldInfo->name()).arg(e.what()));
+    }
+}
+
+void SolutionStore::recordProbe(int id, int timeStep, const QMap<QString, double> &scalars, const QMap<QString, Point> &vectors)
+{
+    ProbeSeries &series = m_probeSeries[id];
+
+    // new adaptivity step of the same time step overrides the record
+    int record = series.timeSteps.count();
+    if (!series.timeSteps.isEmpty() && series.timeSteps.last() == timeStep)
+        record = series.timeSteps.count() - 1;
+
+    if (record == series.timeSteps.count())
+    {
+        series.timeSteps.append(timeStep);
+        series.times.append(Agros2D::problem()->isTransient() ? Agros2D::problem()->timeStepToTotalTime(timeStep) : 0.0);
+
+        for (QMap<QString, QVector<double> >::iterator it = series.scalars.begin(); it != series.scalars.end(); ++it)
+            it.value().append(0.0);
+        for (QMap<QString, QVector<Point> >::iterator it = series.vectors.begin(); it != series.vectors.end(); ++it)
+            it.value().append(Point());
+    }
+
+    // point outside of the mesh has no values (zero is recorded)
+    for (QMap<QString, double>::const_iterator it = scalars.constBegin(); it != scalars.constEnd(); ++it)
+    {
+        if (!series.scalars.contains(it.key()))
+            series.scalars[it.key()] = QVector<double>(series.timeSteps.count(), 0.0);
+        series.scalars[it.key()][record] = it.value();
+    }
+    for (QMap<QString, Point>::const_iterator it = vectors.constBegin(); it != vectors.constEnd(); ++it)
+    {
+        if (!series.vectors.contains(it.key()))
+            series.vectors[it.key()] = QVector<Point>(series.timeSteps.count(), Point());
+        series.vectors[it.key()][record] = it.value();
+    }
+}
+
+void SolutionStore::removeProbeRecords(int timeStep)
+{
+    for (QMap<int, ProbeSeries>::iterator itSeries = m_probeSeries.begin(); itSeries != m_probeSeries.end(); ++itSeries)
+    {
+        ProbeSeries &series = itSeries.value();
+
+        int record = series.timeSteps.indexOf(timeStep);
+        if (record == -1)
+            continue;
+
+        series.timeSteps.remove(record);
+        series.times.remove(record);
+        for (QMap<QString, QVector<double> >::iterator it = series.scalars.begin(); it != series.scalars.end(); ++it)
+            it.value().remove(record);
+        for (QMap<QString, QVector<Point> >::iterator it = series.vectors.begin(); it != series.vectors.end(); ++it)
+            it.value().remove(record);
+    }
 }
 
 QString SolutionStore::baseStoreFileName(FieldSolutionID solutionID) const
@@ -60,40 +643,82 @@ QString SolutionStore::baseStoreFileName(FieldSolutionID solutionID) const
 
 void SolutionStore::clearAll()
 {
+    QMutexLocker locker(&m_mutex);
+
+    // pending writes would recreate removed files
+    flush();
+
+    // archive does not correspond to the solution anymore
+    m_archive->close();
+
     // fast remove of all files
     foreach (FieldSolutionID sid, m_multiSolutions)
         removeSolution(sid, false);
 
     // remove runtime
-    QString fn = QString("%1/runtime.xml").arg(cacheProblemDir());
+    QString fn = QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_MANIFEST_FILENAME);
     if (QFile::exists(fn))
         QFile::remove(fn);
 
+    QString fnIndex = QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_INDEX_FILENAME);
+    if (QFile::exists(fnIndex))
+        QFile::remove(fnIndex);
+
+    QString fnXML = QString("%1/runtime.xml").arg(cacheProblemDir());
+    if (QFile::exists(fnXML))
+        QFile::remove(fnXML);
+
     assert(m_multiSolutions.isEmpty());
+    assert(m_multiSolutionOrder.isEmpty());
+    assert(m_multiSolutionIndex.isEmpty());
+    assert(m_multiSolutionTimeLevels.isEmpty());
     assert(m_multiSolutionRunTimeDetails.isEmpty());
+    assert(m_multiSolutionRunTimeOffsets.isEmpty());
     assert(m_multiSolutionCache.isEmpty());
+    assert(m_multiSolutionCacheMemorySize == 0);
+
+    m_cacheStatistics = CacheStatistics();
+
+    // cached hashes keep the solution meshes alive
+    MeshHash::clearCache();
+
+    // probes stay registered for the next solution
+    for (QMap<int, ProbeSeries>::iterator it = m_probeSeries.begin(); it != m_probeSeries.end(); ++it)
+        it.value() = ProbeSeries();
 }
 
 MultiArray<double> SolutionStore::multiArray(FieldSolutionID solutionID)
 {
+    QMutexLocker locker(&m_mutex);
+
     if(solutionID.solutionMode == SolutionMode_Finer)
     {
         solutionID.solutionMode = SolutionMode_Reference;
-        if(!m_multiSolutions.contains(solutionID))
+        if(!contains(solutionID))
             solutionID.solutionMode = SolutionMode_Normal;
     }
 
-    assert(m_multiSolutions.contains(solutionID));
+    assert(contains(solutionID));
 
     if (!m_multiSolutionCache.contains(solutionID))
     {
         //qDebug() << "Read from disk: " << solutionID.toString();
+        m_cacheStatistics.misses++;
 
         const FieldInfo *fieldInfo = solutionID.group;
         const Block *block = Agros2D::problem()->blockOfField(fieldInfo);
 
         MultiArray<double> msa;
-        SolutionRunTimeDetails runTime = m_multiSolutionRunTimeDetails[solutionID];
+        SolutionRunTimeDetails runTime = runTimeDetails(solutionID);
+
+        // solution could be evicted from the cache before it was written,
+        // wait only for its files (meshes and spaces can be shared with earlier solutions)
+        QStringList fileNames;
+        foreach (SolutionRunTimeDetails::FileName fileName, runTime.fileNames())
+            fileNames << QString("%1/%2").arg(cacheProblemDir()).arg(fileName.meshFileName())
+                      << QString("%1/%2").arg(cacheProblemDir()).arg(fileName.spaceFileName())
+                      << QString("%1/%2").arg(cacheProblemDir()).arg(fileName.solutionFileName());
+        m_writer->waitForFiles(fileNames);
 
         for (int fieldCompIdx = 0; fieldCompIdx < solutionID.group->numberOfSolutions(); fieldCompIdx++)
         {
@@ -101,7 +726,7 @@ MultiArray<double> SolutionStore::multiArray(FieldSolutionID solutionID)
             Hermes::Hermes2D::SpaceSharedPtr<double> space;
             foreach (FieldSolutionID searchSolutionID, m_multiSolutionCacheIDOrder)
             {
-                SolutionRunTimeDetails searchRunTime = m_multiSolutionRunTimeDetails[searchSolutionID];
+                SolutionRunTimeDetails searchRunTime = runTimeDetails(searchSolutionID);
                 if ((fieldCompIdx < searchRunTime.fileNames().size()) &&
                         (runTime.fileNames()[fieldCompIdx].meshFileName() == searchRunTime.fileNames()[fieldCompIdx].meshFileName()) &&
                         (runTime.fileNames()[fieldCompIdx].spaceFileName() == searchRunTime.fileNames()[fieldCompIdx].spaceFileName()))
@@ -115,6 +740,7 @@ MultiArray<double> SolutionStore::multiArray(FieldSolutionID solutionID)
             if (!space.get())
             {
                 // load the mesh file
+                extractFromArchive(runTime.fileNames()[fieldCompIdx].meshFileName());
                 QString fn = QString("%1/%2").arg(cacheProblemDir()).arg(runTime.fileNames()[fieldCompIdx].meshFileName());
                 Hermes::vector<Hermes::Hermes2D::MeshSharedPtr> meshes;
                 if (QFileInfo(fn).suffix() == "msh")
@@ -143,7 +769,8 @@ MultiArray<double> SolutionStore::multiArray(FieldSolutionID solutionID)
                         int bcIndex = fieldCompIdx + block->offset(block->field(fieldInfo));
                         essentialBcs = block->bcs().at(bcIndex);
                     }
-                    QString spaceFileName = QString("%1/%2").arg(cacheProblemDir()).arg(runTime.fileNames()[fieldCompIdx].spaceFileName());       
+                    extractFromArchive(runTime.fileNames()[fieldCompIdx].spaceFileName());
+                    QString spaceFileName = QString("%1/%2").arg(cacheProblemDir()).arg(runTime.fileNames()[fieldCompIdx].spaceFileName());
                     // space = Space<double>::load(compatibleFilename(spaceFileName).toStdString().c_str(), mesh, false, essentialBcs);
                     space = Space<double>::load_bson(compatibleFilename(spaceFileName).toStdString().c_str(), mesh, essentialBcs);
                 }
@@ -155,6 +782,7 @@ MultiArray<double> SolutionStore::multiArray(FieldSolutionID solutionID)
             }
 
             // read solution
+            extractFromArchive(runTime.fileNames()[fieldCompIdx].solutionFileName());
             Solution<double> *sln = new Solution<double>();
             sln->set_validation(false);
             // QTime time;
@@ -165,29 +793,136 @@ MultiArray<double> SolutionStore::multiArray(FieldSolutionID solutionID)
             // sln->load((QString("%1/%2").arg(cacheProblemDir()).arg(runTime.fileNames()[fieldCompIdx].solutionFileName())).toLatin1().data(), space);
             // qDebug() << "LOAD" << time.elapsed();
 
-            msa.append(space, sln);
-        }
+            msa.append(space, sln);
+        }
+
+        // insert to the cache
+        insertMultiSolutionToCache(solutionID, msa);
+
+        //printDebugCacheStatus();
+
+        return msa;
+    }
+    else
+    {
+        m_cacheStatistics.hits++;
+
+        // most recently used
+        m_multiSolutionCacheIDOrder.removeOne(solutionID);
+        m_multiSolutionCacheIDOrder.append(solutionID);
+
+        return m_multiSolutionCache[solutionID];
+    }
+}
+
+void SolutionStore::openArchive(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_archive->open(fileName))
+    {
+        Agros2D::log()->printError(QObject::tr("Problem"), QObject::tr("Solution file '%1' cannot be opened.").arg(fileName));
+        return;
+    }
+
+    // structure of the problem, solutions are extracted on demand
+    QDir().mkpath(cacheProblemDir());
+    foreach (QString entry, QStringList() << "initial.msh" << RUNTIME_MANIFEST_FILENAME << RUNTIME_INDEX_FILENAME << "runtime.xml")
+        if (m_archive->contains(entry))
+            m_archive->extract(entry, cacheProblemDir());
+}
 
-        // insert to the cache
-        insertMultiSolutionToCache(solutionID, msa);
+void SolutionStore::saveArchive(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
 
-        //printDebugCacheStatus();
+    // solutions could be still written in the background
+    flush();
 
-        return msa;
-    }
-    else
+    // XML description for older versions
+    exportRunTimeDetailsXML(QString("%1/runtime.xml").arg(cacheProblemDir()));
+
+    // structure of the problem and files of the stored solutions (removed solutions are dropped)
+    QSet<QString> entries;
+    entries << "initial.msh" << RUNTIME_MANIFEST_FILENAME << RUNTIME_INDEX_FILENAME << "runtime.xml";
+    foreach (FieldSolutionID solutionID, m_multiSolutions)
     {
-        return m_multiSolutionCache[solutionID];
+        foreach (SolutionRunTimeDetails::FileName names, runTimeDetails(solutionID).fileNames())
+            entries << names.meshFileName() << names.spaceFileName() << names.solutionFileName();
     }
+
+    if (!m_archive->save(fileName, entries.toList(), cacheProblemDir()))
+        Agros2D::log()->printError(QObject::tr("Problem"), QObject::tr("Solution file '%1' cannot be saved.").arg(fileName));
+}
+
+void SolutionStore::extractFromArchive(const QString &fileName)
+{
+    if (m_archive->isOpen() && !QFile::exists(QString("%1/%2").arg(cacheProblemDir()).arg(fileName)))
+        m_archive->extract(fileName, cacheProblemDir());
 }
 
 bool SolutionStore::contains(FieldSolutionID solutionID) const
 {
-    return m_multiSolutions.contains(solutionID);
+    QMutexLocker locker(&m_mutex);
+
+    QHash<QPair<const FieldInfo *, int>, TimeStepIndex>::const_iterator it =
+            m_multiSolutionIndex.find(QPair<const FieldInfo *, int>(solutionID.group, solutionID.solutionMode));
+    if (it == m_multiSolutionIndex.end())
+        return false;
+
+    TimeStepIndex::const_iterator itTimeStep = it.value().find(solutionID.timeStep);
+    if (itTimeStep == it.value().end())
+        return false;
+
+    return itTimeStep.value().contains(solutionID.adaptivityStep);
+}
+
+void SolutionStore::insertSolutionID(FieldSolutionID solutionID)
+{
+    m_multiSolutions.insert(m_multiSolutionCounter, solutionID);
+    m_multiSolutionOrder.insert(solutionID, m_multiSolutionCounter);
+    m_multiSolutionCounter++;
+
+    m_multiSolutionIndex[QPair<const FieldInfo *, int>(solutionID.group, solutionID.solutionMode)][solutionID.timeStep].insert(solutionID.adaptivityStep, true);
+    if (m_multiSolutionTimeStepIndex[solutionID.group][solutionID.timeStep]++ == 0)
+    {
+        // new time level (usually the last one)
+        QVector<int> &timeLevels = m_multiSolutionTimeLevels[solutionID.group];
+        timeLevels.insert(qLowerBound(timeLevels.begin(), timeLevels.end(), solutionID.timeStep), solutionID.timeStep);
+    }
+}
+
+void SolutionStore::removeSolutionID(FieldSolutionID solutionID)
+{
+    m_multiSolutions.remove(m_multiSolutionOrder.take(solutionID));
+
+    QPair<const FieldInfo *, int> key(solutionID.group, solutionID.solutionMode);
+    TimeStepIndex &timeSteps = m_multiSolutionIndex[key];
+    timeSteps[solutionID.timeStep].remove(solutionID.adaptivityStep);
+    if (timeSteps[solutionID.timeStep].isEmpty())
+        timeSteps.remove(solutionID.timeStep);
+    if (timeSteps.isEmpty())
+        m_multiSolutionIndex.remove(key);
+
+    QMap<int, int> &count = m_multiSolutionTimeStepIndex[solutionID.group];
+    if (--count[solutionID.timeStep] == 0)
+    {
+        count.remove(solutionID.timeStep);
+
+        QVector<int> &timeLevels = m_multiSolutionTimeLevels[solutionID.group];
+        timeLevels.erase(qBinaryFind(timeLevels.begin(), timeLevels.end(), solutionID.timeStep));
+    }
+    if (count.isEmpty())
+    {
+        m_multiSolutionTimeStepIndex.remove(solutionID.group);
+        m_multiSolutionTimeLevels.remove(solutionID.group);
+    }
 }
 
 MultiArray<double> SolutionStore::multiArray(BlockSolutionID solutionID)
 {
+    QMutexLocker locker(&m_mutex);
+
     MultiArray<double> ma;
     foreach (Field *field, solutionID.group->fields())
     {
@@ -200,8 +935,10 @@ MultiArray<double> SolutionStore::multiArray(BlockSolutionID solutionID)
 
 void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> multiSolution, SolutionRunTimeDetails runTime)
 {
+    QMutexLocker locker(&m_mutex);
+
     // qDebug() << "saving solution " << solutionID;
-    assert(!m_multiSolutions.contains(solutionID));
+    assert(!contains(solutionID));
     assert(solutionID.timeStep >= 0);
     assert(solutionID.adaptivityStep >= 0);
 
@@ -215,7 +952,7 @@ void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> m
     if (m_multiSolutionCache.contains(previous))
     {
         MultiArray<double> ma = m_multiSolutionCache[previous];
-        SolutionRunTimeDetails str = m_multiSolutionRunTimeDetails[previous];
+        SolutionRunTimeDetails str = runTimeDetails(previous);
 
         for (int i = 0; i < multiSolution.size(); i++)
         {
@@ -227,6 +964,25 @@ void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> m
         }
     }
 
+    // snapshot for the writer thread, the solver can refine the meshes and spaces
+    // (initial meshes are replaced, not modified)
+    SolutionStoreWriter::Task task;
+
+    QMap<Hermes::Hermes2D::Mesh *, Hermes::Hermes2D::MeshSharedPtr> meshCopies;
+    for (int i = 0; i < multiSolution.size(); i++)
+    {
+        if (fileNames[i].meshFileName().isEmpty() || fileNames[i].spaceFileName().isEmpty())
+        {
+            Hermes::Hermes2D::MeshSharedPtr mesh = multiSolution.spaces().at(i)->get_mesh();
+            if (!meshCopies.contains(mesh.get()))
+            {
+                Hermes::Hermes2D::MeshSharedPtr meshCopy(new Hermes::Hermes2D::Mesh());
+                meshCopy->copy(mesh);
+                meshCopies.insert(mesh.get(), meshCopy);
+            }
+        }
+    }
+
     // meshes
     for (int i = 0; i < multiSolution.size(); i++)
     {
@@ -236,15 +992,14 @@ void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> m
             foreach(FieldInfo* fieldInfo, Agros2D::problem()->fieldInfos())
             {
                 if (fieldInfo == solutionID.group)
-                    meshes.push_back(multiSolution.spaces().at(i)->get_mesh());
+                    meshes.push_back(meshCopies[multiSolution.spaces().at(i)->get_mesh().get()]);
                 else
                     meshes.push_back(fieldInfo->initialMesh());
             }
 
-            // QString meshFN = QString("%1_%2.msh").arg(baseFN).arg(i);
-            // Module::writeMeshToFileXML(meshFN, meshes);
             QString meshFN = QString("%1_%2.mbs").arg(baseFN).arg(i);
-            Module::writeMeshToFileBSON(meshFN, meshes);
+            task.meshFileNames.append(meshFN);
+            task.meshes.append(meshes);
 
             fileNames[i].setMeshFileName(QFileInfo(meshFN).fileName());
         }
@@ -256,8 +1011,13 @@ void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> m
         if (fileNames[i].spaceFileName().isEmpty())
         {
             QString spaceFN = QString("%1_%2.spc").arg(baseFN).arg(i);
-            // multiSolution.spaces().at(i)->save(compatibleFilename(spaceFN).toStdString().c_str());
-            multiSolution.spaces().at(i)->save_bson(compatibleFilename(spaceFN).toStdString().c_str());
+            // copy of the space on the copy of the mesh
+            Space<double>::ReferenceSpaceCreator spaceCreator(multiSolution.spaces().at(i),
+                                                              meshCopies[multiSolution.spaces().at(i)->get_mesh().get()],
+                                                              0);
+
+            task.spaceFileNames.append(spaceFN);
+            task.spaces.append(spaceCreator.create_ref_space());
 
             fileNames[i].setSpaceFileName(QFileInfo(spaceFN).fileName());
         }
@@ -269,20 +1029,21 @@ void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> m
         if (fileNames[i].solutionFileName().isEmpty())
         {
             QString solutionFN = QString("%1_%2.sln").arg(baseFN).arg(i);
-            // QTime time;
-            // time.start();
-            // dynamic_cast<Hermes::Hermes2D::Solution<double> *>(multiSolution.solutions().at(i).get())->save(solutionFN.toLatin1().data());
-            dynamic_cast<Hermes::Hermes2D::Solution<double> *>(multiSolution.solutions().at(i).get())->save_bson(compatibleFilename(solutionFN).toStdString().c_str());
-            // qDebug() << "SAVE" << time.elapsed();
+            task.solutionFileNames.append(solutionFN);
+            task.solutions.append(multiSolution.solutions().at(i));
 
             fileNames[i].setSolutionFileName(QFileInfo(solutionFN).fileName());
         }
     }
 
+    // solver continues, files are written in the background
+    m_writer->enqueue(task);
+    printWriterErrors();
+
     runTime.setFileNames(fileNames);
 
     // append multisolution
-    m_multiSolutions.append(solutionID);
+    insertSolutionID(solutionID);
 
     // append properties
     m_multiSolutionRunTimeDetails.insert(solutionID, runTime);
@@ -292,8 +1053,11 @@ void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> m
 
     //printDebugCacheStatus();
 
-    // save run time details to the file
-    saveRunTimeDetails();
+    // append run time details to the manifest
+    appendRunTimeDetails(solutionID, RunTimeRecord_Add);
+
+    // solution is in the cache, probes do not need to reload it later
+    recordProbes(solutionID);
 
     // save to the memory info (for debug purposes)
     // m_memoryInfos[solutionID] = tr1::shared_ptr<MemoryInfo>(new MemoryInfo(multiSolution));
@@ -301,20 +1065,21 @@ void SolutionStore::addSolution(FieldSolutionID solutionID, MultiArray<double> m
 
 void SolutionStore::removeSolution(FieldSolutionID solutionID, bool saveRunTime)
 {
-    assert(m_multiSolutions.contains(solutionID));
+    QMutexLocker locker(&m_mutex);
+
+    assert(contains(solutionID));
+
+    // files could be still in the queue
+    flush();
 
     // remove from list
-    m_multiSolutions.removeOne(solutionID);
+    removeSolutionID(solutionID);
     // remove properties
     m_multiSolutionRunTimeDetails.remove(solutionID);
+    m_multiSolutionRunTimeOffsets.remove(solutionID);
     // remove from cache
-    if (m_multiSolutionCache.contains(solutionID))
-    {
-        // free ma
-        m_multiSolutionCache[solutionID].clear();
-        m_multiSolutionCache.remove(solutionID);
-        m_multiSolutionCacheIDOrder.removeOne(solutionID);
-    }
+    removeMultiSolutionFromCache(solutionID);
+    m_multiSolutionCachePinned.removeOne(solutionID);
 
     // remove old files
     QFileInfo info(Agros2D::problem()->config()->fileName());
@@ -338,13 +1103,15 @@ void SolutionStore::removeSolution(FieldSolutionID solutionID, bool saveRunTime)
         }
     }
 
-    // save structure to the file
+    // append removal to the manifest
     if (saveRunTime)
-        saveRunTimeDetails();
+        appendRunTimeDetails(solutionID, RunTimeRecord_Remove);
 }
 
 void SolutionStore::addSolution(BlockSolutionID blockSolutionID, MultiArray<double> multiSolution, SolutionRunTimeDetails runTime)
 {
+    QMutexLocker locker(&m_mutex);
+
     foreach (Field* field, blockSolutionID.group->fields())
     {
         FieldSolutionID fieldSID = blockSolutionID.fieldSolutionID(field->fieldInfo());
@@ -357,6 +1124,8 @@ void SolutionStore::addSolution(BlockSolutionID blockSolutionID, MultiArray<doub
 
 void SolutionStore::removeSolution(BlockSolutionID solutionID)
 {
+    QMutexLocker locker(&m_mutex);
+
     foreach(Field* field, solutionID.group->fields())
     {
         FieldSolutionID fieldSID = solutionID.fieldSolutionID(field->fieldInfo());
@@ -366,28 +1135,43 @@ void SolutionStore::removeSolution(BlockSolutionID solutionID)
 
 void SolutionStore::removeTimeStep(int timeStep)
 {
-    foreach (FieldSolutionID sid, m_multiSolutions)
+    QMutexLocker locker(&m_mutex);
+
+    // solutions of the time step from the index
+    QList<FieldSolutionID> solutionIDs;
+    for (QHash<QPair<const FieldInfo *, int>, TimeStepIndex>::const_iterator it = m_multiSolutionIndex.begin(); it != m_multiSolutionIndex.end(); ++it)
     {
-        if (sid.timeStep == timeStep)
-            removeSolution(sid);
+        TimeStepIndex::const_iterator itTimeStep = it.value().find(timeStep);
+        if (itTimeStep == it.value().end())
+            continue;
+
+        foreach (int adaptivityStep, itTimeStep.value().keys())
+            solutionIDs.append(FieldSolutionID(it.key().first, timeStep, adaptivityStep, (SolutionMode) it.key().second));
     }
 
+    foreach (FieldSolutionID sid, solutionIDs)
+        removeSolution(sid);
+
+    removeProbeRecords(timeStep);
+
 }
 
 int SolutionStore::lastTimeStep(const FieldInfo *fieldInfo, SolutionMode solutionType) const
 {
-    int timeStep = NOT_FOUND_SO_FAR;
-    foreach (FieldSolutionID sid, m_multiSolutions)
-    {
-        if((sid.group == fieldInfo) && (sid.solutionMode == solutionType) && (sid.timeStep > timeStep))
-            timeStep = sid.timeStep;
-    }
+    QMutexLocker locker(&m_mutex);
 
-    return timeStep;
+    QHash<QPair<const FieldInfo *, int>, TimeStepIndex>::const_iterator it =
+            m_multiSolutionIndex.find(QPair<const FieldInfo *, int>(fieldInfo, solutionType));
+    if (it == m_multiSolutionIndex.end())
+        return NOT_FOUND_SO_FAR;
+
+    return it.value().lastKey();
 }
 
 int SolutionStore::lastTimeStep(const Block *block, SolutionMode solutionType) const
 {
+    QMutexLocker locker(&m_mutex);
+
     int timeStep = lastTimeStep(block->fields().at(0)->fieldInfo(), solutionType);
 
     foreach(Field* field, block->fields())
@@ -400,6 +1184,8 @@ int SolutionStore::lastTimeStep(const Block *block, SolutionMode solutionType) c
 
 MultiArray<double> SolutionStore::multiSolutionPreviousCalculatedTS(BlockSolutionID solutionID)
 {
+    QMutexLocker locker(&m_mutex);
+
     MultiArray<double> ma;
     foreach(Field *field, solutionID.group->fields())
     {
@@ -415,54 +1201,61 @@ MultiArray<double> SolutionStore::multiSolutionPreviousCalculatedTS(BlockSolutio
 
 int SolutionStore::nthCalculatedTimeStep(const FieldInfo *fieldInfo, int n) const
 {
+    QMutexLocker locker(&m_mutex);
+
+    TimeStepIndex timeSteps = m_multiSolutionIndex.value(QPair<const FieldInfo *, int>(fieldInfo, SolutionMode_Normal));
+
     int count = 0;
-    for(int step = 0; step <= lastTimeStep(fieldInfo, SolutionMode_Normal); step++)
+    for (TimeStepIndex::const_iterator it = timeSteps.begin(); it != timeSteps.end(); ++it)
     {
-        if(this->contains(FieldSolutionID(fieldInfo, step, 0, SolutionMode_Normal)))
+        if (it.value().contains(0))
             count++;
 
         // n is counted from zero
-        if(count == n + 1)
-            return step;
+        if (count == n + 1)
+            return it.key();
     }
 
     assert(0);
 }
 
-
 int SolutionStore::nearestTimeStep(const FieldInfo *fieldInfo, int timeStep) const
 {
-    int ts = timeStep;
-    while (!this->contains(FieldSolutionID(fieldInfo, ts, 0, SolutionMode_Normal)))
+    QMutexLocker locker(&m_mutex);
+
+    QHash<QPair<const FieldInfo *, int>, TimeStepIndex>::const_iterator itIndex =
+            m_multiSolutionIndex.find(QPair<const FieldInfo *, int>(fieldInfo, SolutionMode_Normal));
+    if (itIndex == m_multiSolutionIndex.end())
+        return 0;
+
+    // first time step greater than timeStep, go back
+    TimeStepIndex::const_iterator it = itIndex.value().upperBound(timeStep);
+    while (it != itIndex.value().begin())
     {
-        ts--;
-        if (ts <= 0)
+        --it;
+        if (it.key() <= 0)
             return 0;
+        if (it.value().contains(0))
+            return it.key();
     }
-    return ts;
+
+    return 0;
 }
 
 double SolutionStore::lastTime(const FieldInfo *fieldInfo)
 {
+    QMutexLocker locker(&m_mutex);
+
     int timeStep = lastTimeStep(fieldInfo, SolutionMode_Normal);
-    double time = NOT_FOUND_SO_FAR;
+    assert(timeStep != NOT_FOUND_SO_FAR);
 
-    foreach (FieldSolutionID id, m_multiSolutions)
-    {
-        if ((id.group == fieldInfo) && (id.timeStep == timeStep))
-        {
-            if (time == NOT_FOUND_SO_FAR)
-                time = Agros2D::problem()->timeStepToTotalTime(id.timeStep);
-            else
-                assert(time == Agros2D::problem()->timeStepToTotalTime(id.timeStep));
-        }
-    }
-    assert(time != NOT_FOUND_SO_FAR);
-    return time;
+    return Agros2D::problem()->timeStepToTotalTime(timeStep);
 }
 
 double SolutionStore::lastTime(const Block *block)
 {
+    QMutexLocker locker(&m_mutex);
+
     double time = lastTime(block->fields().at(0)->fieldInfo());
 
     foreach(Field* field, block->fields())
@@ -476,21 +1269,27 @@ double SolutionStore::lastTime(const Block *block)
 
 int SolutionStore::lastAdaptiveStep(const FieldInfo *fieldInfo, SolutionMode solutionType, int timeStep) const
 {
+    QMutexLocker locker(&m_mutex);
+
+    QHash<QPair<const FieldInfo *, int>, TimeStepIndex>::const_iterator it =
+            m_multiSolutionIndex.find(QPair<const FieldInfo *, int>(fieldInfo, solutionType));
+    if (it == m_multiSolutionIndex.end())
+        return NOT_FOUND_SO_FAR;
+
     if (timeStep == -1)
-        timeStep = lastTimeStep(fieldInfo, solutionType);
+        timeStep = it.value().lastKey();
 
-    int adaptiveStep = NOT_FOUND_SO_FAR;
-    foreach (FieldSolutionID sid, m_multiSolutions)
-    {
-        if ((sid.group == fieldInfo) && (sid.solutionMode == solutionType) && (sid.timeStep == timeStep) && (sid.adaptivityStep > adaptiveStep))
-            adaptiveStep = sid.adaptivityStep;
-    }
+    TimeStepIndex::const_iterator itTimeStep = it.value().find(timeStep);
+    if (itTimeStep == it.value().end())
+        return NOT_FOUND_SO_FAR;
 
-    return adaptiveStep;
+    return itTimeStep.value().lastKey();
 }
 
 int SolutionStore::lastAdaptiveStep(const Block *block, SolutionMode solutionType, int timeStep) const
 {
+    QMutexLocker locker(&m_mutex);
+
     int adaptiveStep = lastAdaptiveStep(block->fields().at(0)->fieldInfo(), solutionType, timeStep);
 
     foreach(Field* field, block->fields())
@@ -503,6 +1302,8 @@ int SolutionStore::lastAdaptiveStep(const Block *block, SolutionMode solutionTyp
 
 FieldSolutionID SolutionStore::lastTimeAndAdaptiveSolution(const FieldInfo *fieldInfo, SolutionMode solutionType)
 {
+    QMutexLocker locker(&m_mutex);
+
     FieldSolutionID solutionID;
     if (solutionType == SolutionMode_Finer) {
         FieldSolutionID solutionIDNormal = lastTimeAndAdaptiveSolution(fieldInfo, SolutionMode_Normal);
@@ -530,6 +1331,8 @@ FieldSolutionID SolutionStore::lastTimeAndAdaptiveSolution(const FieldInfo *fiel
 
 BlockSolutionID SolutionStore::lastTimeAndAdaptiveSolution(const Block *block, SolutionMode solutionType)
 {
+    QMutexLocker locker(&m_mutex);
+
     FieldSolutionID fsid = lastTimeAndAdaptiveSolution(block->fields().at(0)->fieldInfo(), solutionType);
     BlockSolutionID bsid = fsid.blockSolutionID(block);
 
@@ -544,70 +1347,523 @@ BlockSolutionID SolutionStore::lastTimeAndAdaptiveSolution(const Block *block, S
 
 QList<double> SolutionStore::timeLevels(const FieldInfo *fieldInfo) const
 {
+    QMutexLocker locker(&m_mutex);
+
     QList<double> list;
 
-    foreach(FieldSolutionID fsid, m_multiSolutions)
-    {
-        if (fsid.group == fieldInfo)
-        {
-            double time = Agros2D::problem()->timeStepToTotalTime(fsid.timeStep);
-            if (!list.contains(time))
-                list.push_back(time);
-        }
-    }
+    // time steps are ordered
+    const QVector<int> timeSteps = m_multiSolutionTimeLevels.value(fieldInfo);
+    list.reserve(timeSteps.size());
+    for (int i = 0; i < timeSteps.size(); i++)
+        list.push_back(Agros2D::problem()->timeStepToTotalTime(timeSteps.at(i)));
 
     return list;
 }
 
 int SolutionStore::timeLevelIndex(const FieldInfo *fieldInfo, double time)
 {
-    int level = -1;
-    QList<double> levels = timeLevels(fieldInfo);
-    if(levels.isEmpty())
+    QMutexLocker locker(&m_mutex);
+
+    const QVector<int> timeSteps = m_multiSolutionTimeLevels.value(fieldInfo);
+    if (timeSteps.isEmpty())
         return 0;
 
-    foreach(double timeLevel, levels)
+    // number of levels smaller or equal to time (total time grows with the time step)
+    int low = 0;
+    int high = timeSteps.size();
+    while (low < high)
     {
-        if(timeLevel <= time)
-            level++;
+        int mid = (low + high) / 2;
+        if (Agros2D::problem()->timeStepToTotalTime(timeSteps.at(mid)) <= time)
+            low = mid + 1;
+        else
+            high = mid;
     }
+
+    int level = low - 1;
     assert(level >= 0);
     return level;
 }
 
 double SolutionStore::timeLevel(const FieldInfo *fieldInfo, int timeLevelIndex)
 {
-    QList<double> levels = timeLevels(fieldInfo);
-    if (timeLevelIndex >= 0 && timeLevelIndex < levels.count())
-        return levels.at(timeLevelIndex);
+    QMutexLocker locker(&m_mutex);
+
+    const QVector<int> timeSteps = m_multiSolutionTimeLevels.value(fieldInfo);
+    if (timeLevelIndex >= 0 && timeLevelIndex < timeSteps.count())
+        return Agros2D::problem()->timeStepToTotalTime(timeSteps.at(timeLevelIndex));
+
+    return 0.0;
 }
 
 void SolutionStore::insertMultiSolutionToCache(FieldSolutionID solutionID, MultiArray<double> multiSolution)
 {
     if (!m_multiSolutionCache.contains(solutionID))
     {
-        // flush cache
-        if (m_multiSolutionCache.count() > Agros2D::configComputer()->cacheSize)
+        qint64 memorySize = multiArrayMemorySize(multiSolution);
+        qint64 memoryLimit = (qint64) Agros2D::configComputer()->cacheSize * 1024 * 1024;
+
+        // flush least recently used, not pinned solutions
+        int index = 0;
+        while ((m_multiSolutionCacheMemorySize + memorySize > memoryLimit) && (index < m_multiSolutionCacheIDOrder.size()))
         {
-            assert(! m_multiSolutionCacheIDOrder.empty());
-            FieldSolutionID idRemove = m_multiSolutionCacheIDOrder[0];
-            m_multiSolutionCacheIDOrder.removeFirst();
+            FieldSolutionID idRemove = m_multiSolutionCacheIDOrder[index];
+            if (m_multiSolutionCachePinned.contains(idRemove))
+            {
+                index++;
+                continue;
+            }
 
-            // free ma
-            m_multiSolutionCache[idRemove].clear();
-            m_multiSolutionCache.remove(idRemove);
+            removeMultiSolutionFromCache(idRemove);
+            m_cacheStatistics.evictions++;
         }
 
-        // add solution
+        // add solution (even if it exceeds the limit itself)
         m_multiSolutionCache.insert(solutionID, multiSolution);
         m_multiSolutionCacheIDOrder.append(solutionID);
+        m_multiSolutionCacheMemorySizes.insert(solutionID, memorySize);
+        m_multiSolutionCacheMemorySize += memorySize;
+    }
+}
+
+void SolutionStore::removeMultiSolutionFromCache(FieldSolutionID solutionID)
+{
+    if (m_multiSolutionCache.contains(solutionID))
+    {
+        // free ma
+        m_multiSolutionCache[solutionID].clear();
+        m_multiSolutionCache.remove(solutionID);
+        m_multiSolutionCacheIDOrder.removeOne(solutionID);
+        m_multiSolutionCacheMemorySize -= m_multiSolutionCacheMemorySizes.take(solutionID);
+    }
+}
+
+void SolutionStore::setPinnedSolutions(QList<FieldSolutionID> solutionIDs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_multiSolutionCachePinned.clear();
+    foreach (FieldSolutionID solutionID, solutionIDs)
+    {
+        if (solutionID.solutionMode == SolutionMode_Finer)
+        {
+            solutionID.solutionMode = SolutionMode_Reference;
+            if (!contains(solutionID))
+                solutionID.solutionMode = SolutionMode_Normal;
+        }
+
+        m_multiSolutionCachePinned.append(solutionID);
+    }
+}
+
+qint64 SolutionStore::multiArrayMemorySize(MultiArray<double> multiSolution) const
+{
+    qint64 size = 0;
+
+    QList<Hermes::Hermes2D::Mesh *> meshes;
+    for (int comp = 0; comp < multiSolution.size(); comp++)
+    {
+        Hermes::Hermes2D::SpaceSharedPtr<double> space = multiSolution.spaces().at(comp);
+        Hermes::Hermes2D::MeshSharedPtr mesh = space->get_mesh();
+
+        // mesh (shared by components)
+        if (!meshes.contains(mesh.get()))
+        {
+            meshes.append(mesh.get());
+            size += (qint64) mesh->get_max_element_id() * sizeof(Hermes::Hermes2D::Element);
+            size += (qint64) mesh->get_max_node_id() * sizeof(Hermes::Hermes2D::Node);
+        }
+
+        // space (node and element data)
+        size += (qint64) mesh->get_max_node_id() * 4 * sizeof(int);
+        size += (qint64) mesh->get_max_element_id() * 4 * sizeof(int);
+
+        // solution (monomial coefficients)
+        Hermes::Hermes2D::Element *element;
+        for_all_active_elements(element, mesh)
+        {
+            int order = H2D_GET_H_ORDER(space->get_element_order(element->id)) + 1;
+            size += (qint64) order * order * multiSolution.solutions().at(comp)->get_num_components() * sizeof(double);
+        }
+    }
+
+    return size;
+}
+
+static void writeRunTimeDetails(QDataStream &stream, const SolutionStore::SolutionRunTimeDetails &runTime)
+{
+    stream << runTime.timeStepLength() << runTime.adaptivityError()
+           << (qint32) runTime.DOFs() << (qint32) runTime.jacobianCalculations();
+
+    stream << (qint32) runTime.fileNames().size();
+    foreach (SolutionStore::SolutionRunTimeDetails::FileName fileName, runTime.fileNames())
+        stream << fileName.meshFileName() << fileName.spaceFileName() << fileName.solutionFileName();
+
+    stream << runTime.relativeChangeOfSolutions() << runTime.newtonResidual() << runTime.nonlinearDamping();
+}
+
+static SolutionStore::SolutionRunTimeDetails readRunTimeDetails(QDataStream &stream)
+{
+    double timeStepLength, adaptivityError;
+    qint32 DOFs, jacobianCalculations;
+    stream >> timeStepLength >> adaptivityError >> DOFs >> jacobianCalculations;
+
+    SolutionStore::SolutionRunTimeDetails runTime(timeStepLength, adaptivityError, DOFs);
+    runTime.setJacobianCalculations(jacobianCalculations);
+
+    qint32 count;
+    stream >> count;
+    QList<SolutionStore::SolutionRunTimeDetails::FileName> fileNames;
+    for (int i = 0; i < count; i++)
+    {
+        QString meshFileName, spaceFileName, solutionFileName;
+        stream >> meshFileName >> spaceFileName >> solutionFileName;
+        fileNames.append(SolutionStore::SolutionRunTimeDetails::FileName(meshFileName, spaceFileName, solutionFileName));
+    }
+    runTime.setFileNames(fileNames);
+
+    QVector<double> relativeChangeOfSolutions, newtonResidual, nonlinearDamping;
+    stream >> relativeChangeOfSolutions >> newtonResidual >> nonlinearDamping;
+    runTime.setRelativeChangeOfSolutions(relativeChangeOfSolutions);
+    runTime.setNewtonResidual(newtonResidual);
+    runTime.setNonlinearDamping(nonlinearDamping);
+
+    return runTime;
+}
+
+bool SolutionStore::hasRunTimeDetails()
+{
+    return (QFile::exists(QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_MANIFEST_FILENAME)) ||
+            QFile::exists(QString("%1/runtime.xml").arg(cacheProblemDir())));
+}
+
+void SolutionStore::appendRunTimeDetails(FieldSolutionID solutionID, RunTimeRecord record)
+{
+    // record
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    stream << (quint8) record
+           << solutionID.group->fieldId()
+           << (qint32) solutionID.timeStep
+           << (qint32) solutionID.adaptivityStep
+           << solutionTypeToStringKey(solutionID.solutionMode);
+
+    if (record != RunTimeRecord_Remove)
+        writeRunTimeDetails(stream, runTimeDetails(solutionID));
+
+    // append to the manifest
+    QFile file(QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_MANIFEST_FILENAME));
+    bool isEmpty = !file.exists() || (file.size() == 0);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        Agros2D::log()->printError(QObject::tr("Solver"), QObject::tr("Access denied '%1'").arg(file.fileName()));
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_8);
+    if (isEmpty)
+        out << RUNTIME_MANIFEST_MAGIC << RUNTIME_MANIFEST_VERSION;
+
+    // length prefixed record (after the header)
+    qint64 offset = isEmpty ? 2 * sizeof(quint32) : file.size();
+    out << data;
+    file.close();
+
+    appendRunTimeIndex(solutionID, record, offset);
+}
+
+void SolutionStore::appendRunTimeIndex(FieldSolutionID solutionID, RunTimeRecord record, qint64 offset)
+{
+    QFile file(QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_INDEX_FILENAME));
+    bool isEmpty = !file.exists() || (file.size() == 0);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        Agros2D::log()->printError(QObject::tr("Solver"), QObject::tr("Access denied '%1'").arg(file.fileName()));
+        return;
+    }
+
+    // longer field ids are not indexed (manifest is replayed)
+    QByteArray fieldId = solutionID.group->fieldId().toLatin1();
+    quint8 fieldIdLength = (fieldId.size() <= RUNTIME_INDEX_FIELDID_SIZE) ? fieldId.size() : RUNTIME_INDEX_FIELDID_NOT_INDEXED;
+    fieldId = fieldId.left(RUNTIME_INDEX_FIELDID_SIZE).leftJustified(RUNTIME_INDEX_FIELDID_SIZE, '\0');
+
+    double timeStepLength = (record != RunTimeRecord_Remove) ? runTimeDetails(solutionID).timeStepLength() : 0.0;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_8);
+    if (isEmpty)
+        out << RUNTIME_INDEX_MAGIC << RUNTIME_INDEX_VERSION;
+
+    out << (quint8) record << (quint8) solutionID.solutionMode << fieldIdLength << (quint8) 0
+        << (qint32) solutionID.timeStep << (qint32) solutionID.adaptivityStep
+        << timeStepLength << offset;
+    out.writeRawData(fieldId.constData(), RUNTIME_INDEX_FIELDID_SIZE);
+
+    file.close();
+}
+
+bool SolutionStore::containsRunTimeDetails(FieldSolutionID solutionID) const
+{
+    return (m_multiSolutionRunTimeDetails.contains(solutionID) || m_multiSolutionRunTimeOffsets.contains(solutionID));
+}
+
+SolutionStore::SolutionRunTimeDetails SolutionStore::runTimeDetails(FieldSolutionID solutionID) const
+{
+    if (!m_multiSolutionRunTimeOffsets.contains(solutionID))
+        return m_multiSolutionRunTimeDetails.value(solutionID);
+
+    // read single record of the manifest
+    QString fn = QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_MANIFEST_FILENAME);
+    QFile file(fn);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(m_multiSolutionRunTimeOffsets.value(solutionID)))
+        throw AgrosException(QObject::tr("File '%1' cannot be opened (%2).").arg(fn).arg(file.errorString()));
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    QByteArray data;
+    in >> data;
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    quint8 record;
+    QString fieldId, solutionType;
+    qint32 timeStep, adaptivityStep;
+    stream >> record >> fieldId >> timeStep >> adaptivityStep >> solutionType;
+
+    SolutionRunTimeDetails runTime = readRunTimeDetails(stream);
+    if ((in.status() != QDataStream::Ok) || (stream.status() != QDataStream::Ok))
+        throw AgrosException(QObject::tr("Solution manifest '%1' is corrupted.").arg(fn));
+
+    m_multiSolutionRunTimeDetails.insert(solutionID, runTime);
+    m_multiSolutionRunTimeOffsets.remove(solutionID);
+
+    return runTime;
+}
+
+bool SolutionStore::loadRunTimeIndex()
+{
+    QFile fileManifest(QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_MANIFEST_FILENAME));
+    QFile file(QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_INDEX_FILENAME));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly) || !fileManifest.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 size = file.size();
+    qint64 sizeManifest = fileManifest.size();
+    if ((size < 8) || ((size - 8) % RUNTIME_INDEX_ENTRY_SIZE != 0))
+        return false;
+
+    // map index to the memory, entries are not parsed
+    uchar *memory = file.map(0, size);
+    QByteArray raw = memory ? QByteArray::fromRawData((const char *) memory, size) : file.readAll();
+    const uchar *data = (const uchar *) raw.constData();
+
+    bool ok = (qFromBigEndian<quint32>(data) == RUNTIME_INDEX_MAGIC) && (qFromBigEndian<quint32>(data + 4) == RUNTIME_INDEX_VERSION);
+
+    // live records in order of insertion
+    QList<FieldSolutionID> solutionIDs;
+    QMap<FieldSolutionID, QPair<qint64, double> > records;
+
+    int count = (size - 8) / RUNTIME_INDEX_ENTRY_SIZE;
+    qint64 lastOffset = 0;
+    for (int i = 0; ok && (i < count); i++)
+    {
+        const uchar *entry = data + 8 + i * RUNTIME_INDEX_ENTRY_SIZE;
+
+        quint8 record = entry[0];
+        SolutionMode solutionMode = (SolutionMode) entry[1];
+        quint8 fieldIdLength = entry[2];
+        qint32 timeStep = qFromBigEndian<qint32>(entry + 4);
+        qint32 adaptivityStep = qFromBigEndian<qint32>(entry + 8);
+        quint64 timeStepLengthBits = qFromBigEndian<quint64>(entry + 12);
+        qint64 offset = qFromBigEndian<qint64>(entry + 20);
+
+        double timeStepLength;
+        memcpy(&timeStepLength, &timeStepLengthBits, sizeof(double));
+
+        // records follow the header of the manifest and are ordered
+        if ((fieldIdLength == RUNTIME_INDEX_FIELDID_NOT_INDEXED) || (offset <= lastOffset) || (offset >= sizeManifest) ||
+                ((i == 0) && (offset != 8)))
+        {
+            ok = false;
+            break;
+        }
+        lastOffset = offset;
+
+        QString fieldId = QString::fromLatin1((const char *) entry + 28, fieldIdLength);
+        if (!Agros2D::problem()->hasField(fieldId))
+            throw AgrosException(QObject::tr("Field '%1' info mismatch.").arg(fieldId));
+
+        FieldSolutionID solutionID(Agros2D::problem()->fieldInfo(fieldId), timeStep, adaptivityStep, solutionMode);
+
+        switch (record)
+        {
+        case RunTimeRecord_Add:
+            solutionIDs.append(solutionID);
+            records.insert(solutionID, QPair<qint64, double>(offset, timeStepLength));
+            break;
+        case RunTimeRecord_Replace:
+            records.insert(solutionID, QPair<qint64, double>(offset, timeStepLength));
+            break;
+        case RunTimeRecord_Remove:
+            solutionIDs.removeOne(solutionID);
+            records.remove(solutionID);
+            break;
+        default:
+            ok = false;
+            break;
+        }
+    }
+
+    // last record of the manifest has to be indexed
+    if (ok && (count > 0))
+    {
+        quint32 length = 0;
+        ok = fileManifest.seek(lastOffset) && (fileManifest.read((char *) &length, 4) == 4) &&
+                (lastOffset + 4 + qFromBigEndian<quint32>((const uchar *) &length) == sizeManifest);
+    }
+
+    if (memory)
+        file.unmap(memory);
+    file.close();
+    fileManifest.close();
+
+    if (!ok)
+        return false;
+
+    int time_step = 0;
+    foreach (FieldSolutionID solutionID, solutionIDs)
+    {
+        // append multisolution
+        insertSolutionID(solutionID);
+
+        // TODO: remove "problem time step structures"
+        // define transient time step
+        if (solutionID.timeStep > time_step)
+        {
+            // new time step
+            time_step = solutionID.timeStep;
+
+            Agros2D::problem()->defineActualTimeStepLength(records[solutionID].second);
+        }
+
+        // run time details are read on demand
+        m_multiSolutionRunTimeOffsets.insert(solutionID, records[solutionID].first);
     }
+
+    return true;
 }
 
 void SolutionStore::loadRunTimeDetails()
 {
-    QString fn = QString("%1/runtime.xml").arg(cacheProblemDir());
+    QString fn = QString("%1/%2").arg(cacheProblemDir()).arg(RUNTIME_MANIFEST_FILENAME);
+
+    // older solutions
+    if (!QFile::exists(fn))
+    {
+        loadRunTimeDetailsXML(QString("%1/runtime.xml").arg(cacheProblemDir()));
+        return;
+    }
+
+    // index of the manifest
+    if (loadRunTimeIndex())
+        return;
 
+    QFile file(fn);
+    if (!file.open(QIODevice::ReadOnly))
+        throw AgrosException(QObject::tr("File '%1' cannot be opened (%2).").arg(fn).arg(file.errorString()));
+
+    // map manifest to the memory
+    qint64 size = file.size();
+    uchar *memory = file.map(0, size);
+    QByteArray raw = memory ? QByteArray::fromRawData((const char *) memory, size) : file.readAll();
+
+    QDataStream in(raw);
+    in.setVersion(QDataStream::Qt_4_8);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if ((magic != RUNTIME_MANIFEST_MAGIC) || (version != RUNTIME_MANIFEST_VERSION))
+        throw AgrosException(QObject::tr("Solution manifest '%1' is corrupted.").arg(fn));
+
+    // replay records, keep order of insertion
+    QList<FieldSolutionID> solutionIDs;
+    QMap<FieldSolutionID, SolutionRunTimeDetails> runTimeDetails;
+    while (!in.atEnd())
+    {
+        QByteArray data;
+        in >> data;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        QDataStream stream(data);
+        stream.setVersion(QDataStream::Qt_4_8);
+
+        quint8 record;
+        QString fieldId, solutionType;
+        qint32 timeStep, adaptivityStep;
+        stream >> record >> fieldId >> timeStep >> adaptivityStep >> solutionType;
+
+        // check field
+        if (!Agros2D::problem()->hasField(fieldId))
+            throw AgrosException(QObject::tr("Field '%1' info mismatch.").arg(fieldId));
+
+        FieldSolutionID solutionID(Agros2D::problem()->fieldInfo(fieldId),
+                                   timeStep,
+                                   adaptivityStep,
+                                   solutionTypeFromStringKey(solutionType));
+
+        switch (record)
+        {
+        case RunTimeRecord_Add:
+            solutionIDs.append(solutionID);
+            runTimeDetails.insert(solutionID, readRunTimeDetails(stream));
+            break;
+        case RunTimeRecord_Replace:
+            runTimeDetails.insert(solutionID, readRunTimeDetails(stream));
+            break;
+        case RunTimeRecord_Remove:
+            solutionIDs.removeOne(solutionID);
+            runTimeDetails.remove(solutionID);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (memory)
+        file.unmap(memory);
+    file.close();
+
+    int time_step = 0;
+    foreach (FieldSolutionID solutionID, solutionIDs)
+    {
+        SolutionRunTimeDetails runTime = runTimeDetails[solutionID];
+
+        // append multisolution
+        insertSolutionID(solutionID);
+
+        // TODO: remove "problem time step structures"
+        // define transient time step
+        if (solutionID.timeStep > time_step)
+        {
+            // new time step
+            time_step = solutionID.timeStep;
+
+            Agros2D::problem()->defineActualTimeStepLength(runTime.timeStepLength());
+        }
+
+        // append run time details
+        m_multiSolutionRunTimeDetails.insert(solutionID, runTime);
+    }
+}
+
+void SolutionStore::loadRunTimeDetailsXML(const QString &fn)
+{
     try
     {
         std::auto_ptr<XMLStructure::structure> structure_xsd = XMLStructure::structure_(compatibleFilename(fn).toStdString(), xml_schema::flags::dont_validate);
@@ -627,7 +1883,7 @@ void SolutionStore::loadRunTimeDetails()
                                        data.adaptivity_step(),
                                        solutionTypeFromStringKey(QString::fromStdString(data.solution_type())));
             // append multisolution
-            m_multiSolutions.append(solutionID);
+            insertSolutionID(solutionID);
 
             // TODO: remove "problem time step structures"
             // define transient time step
@@ -665,16 +1921,14 @@ void SolutionStore::loadRunTimeDetails()
     }
 }
 
-void SolutionStore::saveRunTimeDetails()
+void SolutionStore::exportRunTimeDetailsXML(const QString &fn) const
 {
-    QString fn = QString("%1/runtime.xml").arg(cacheProblemDir());
-
     try
     {
         XMLStructure::structure structure;
         foreach (FieldSolutionID solutionID, m_multiSolutions)
         {
-            SolutionRunTimeDetails str = m_multiSolutionRunTimeDetails[solutionID];
+            SolutionRunTimeDetails str = runTimeDetails(solutionID);
 
             XMLStructure::files files;
             for (int solutionIndex = 0; solutionIndex < solutionID.group->numberOfSolutions(); solutionIndex++)
@@ -732,12 +1986,23 @@ void SolutionStore::saveRunTimeDetails()
     }
 }
 
+SolutionStore::SolutionRunTimeDetails SolutionStore::multiSolutionRunTimeDetail(FieldSolutionID solutionID) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    assert(containsRunTimeDetails(solutionID));
+    return runTimeDetails(solutionID);
+}
+
 void SolutionStore::multiSolutionRunTimeDetailReplace(FieldSolutionID solutionID, SolutionRunTimeDetails runTime)
 {
-    assert(m_multiSolutionRunTimeDetails.contains(solutionID));
+    QMutexLocker locker(&m_mutex);
+
+    assert(containsRunTimeDetails(solutionID));
     m_multiSolutionRunTimeDetails[solutionID] = runTime;
+    m_multiSolutionRunTimeOffsets.remove(solutionID);
 
-    // save structure to the file
-    saveRunTimeDetails();
+    // append new details to the manifest (last record wins)
+    appendRunTimeDetails(solutionID, RunTimeRecord_Replace);
 }
 
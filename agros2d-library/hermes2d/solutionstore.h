@@ -22,9 +22,94 @@
 
 #include "solutiontypes.h"
 
+class QuaZip;
+
+// background writer, serializes meshes, spaces and solutions to the cache directory
+class SolutionStoreWriter : public QThread
+{
+public:
+    // in-memory snapshot of one stored solution, meshes and spaces are copies
+    // (the solver can refine the originals), shared pointers keep data alive until written
+    struct Task
+    {
+        QList<QString> meshFileNames;
+        QList<Hermes::vector<Hermes::Hermes2D::MeshSharedPtr> > meshes;
+        QList<QString> spaceFileNames;
+        QList<Hermes::Hermes2D::SpaceSharedPtr<double> > spaces;
+        QList<QString> solutionFileNames;
+        QList<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > solutions;
+
+        QStringList fileNames() const { return meshFileNames + spaceFileNames + solutionFileNames; }
+    };
+
+    SolutionStoreWriter(int queueSize);
+    ~SolutionStoreWriter();
+
+    // blocks while the queue is full (backpressure)
+    void enqueue(const Task &task);
+    // blocks until all queued tasks are written
+    void flush();
+    // blocks until the given files (full paths) are written, other queued tasks are not waited for
+    void waitForFiles(const QStringList &fileNames);
+    // errors of the writer thread, reported by the owning thread
+    QStringList takeErrors();
+
+protected:
+    virtual void run();
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_queueNotEmpty;
+    QWaitCondition m_queueNotFull;
+    QWaitCondition m_queueDrained;
+    QWaitCondition m_taskWritten;
+
+    QQueue<Task> m_queue;
+    // files of the queued tasks and of the task being written
+    QSet<QString> m_pendingFiles;
+    int m_queueSize;
+    bool m_isWriting;
+    bool m_stop;
+    QStringList m_errors;
+
+    void write(const Task &task);
+};
+
+// random access to the entries of the solution archive (.sol)
+class SolutionArchive
+{
+public:
+    SolutionArchive();
+    ~SolutionArchive();
+
+    // reads central directory of the archive, later entries override earlier ones
+    bool open(const QString &fileName);
+    void close();
+
+    inline bool isOpen() const { return m_zip; }
+    QString fileName() const;
+
+    inline bool contains(const QString &entry) const { return m_entries.contains(entry); }
+    inline QStringList entries() const { return m_entries.keys(); }
+
+    // extracts single entry to the directory
+    bool extract(const QString &entry, const QString &dir);
+    // writes archive with the listed entries only (fileName can be this archive), files from
+    // the directory take precedence, other entries are copied from this archive without recompression
+    bool save(const QString &fileName, const QStringList &entries, const QString &dir);
+
+private:
+    QuaZip *m_zip;
+
+    bool goToEntry(const QString &entry);
+    // entry -> position in the central directory
+    QMap<QString, QPair<qulonglong, qulonglong> > m_entries;
+};
+
 class AGROS_LIBRARY_API SolutionStore
 {
 public:
+    SolutionStore();
     ~SolutionStore();
 
     class SolutionRunTimeDetails
@@ -50,7 +135,7 @@ public:
         };
 
         SolutionRunTimeDetails(double time_step_length = 0, double error = 0, int DOFs = 0)
-            : m_timeStepLength(time_step_length), m_adaptivityError(error), m_DOFs(DOFs) {}
+            : m_timeStepLength(time_step_length), m_adaptivityError(error), m_DOFs(DOFs), m_jacobianCalculations(0) {}
         ~SolutionRunTimeDetails()
         {
             m_fileNames.clear();
@@ -88,6 +173,15 @@ public:
         QVector<double> m_nonlinearDamping;
     };
 
+    struct CacheStatistics
+    {
+        CacheStatistics() : hits(0), misses(0), evictions(0) {}
+
+        int hits;
+        int misses;
+        int evictions;
+    };
+
     bool contains(FieldSolutionID solutionID) const;
     MultiArray<double> multiArray(FieldSolutionID solutionID);
     MultiArray<double> multiArray(BlockSolutionID solutionID);
@@ -128,9 +222,13 @@ public:
     FieldSolutionID lastTimeAndAdaptiveSolution(const FieldInfo* fieldInfo, SolutionMode solutionType);
     BlockSolutionID lastTimeAndAdaptiveSolution(const Block *block, SolutionMode solutionType);
 
+    // replays manifest of stored solutions (or older runtime.xml)
     void loadRunTimeDetails();
+    static bool hasRunTimeDetails();
+    // writes XML description of stored solutions
+    void exportRunTimeDetailsXML(const QString &fn) const;
 
-    SolutionRunTimeDetails multiSolutionRunTimeDetail(FieldSolutionID solutionID) const { assert(m_multiSolutionRunTimeDetails.contains(solutionID)); return m_multiSolutionRunTimeDetails[solutionID]; }
+    SolutionRunTimeDetails multiSolutionRunTimeDetail(FieldSolutionID solutionID) const;
     void multiSolutionRunTimeDetailReplace(FieldSolutionID solutionID, SolutionRunTimeDetails runTime);
 
     inline bool isEmpty() const { return m_multiSolutions.isEmpty(); }
@@ -138,20 +236,141 @@ public:
 
     void printDebugCacheStatus();
 
+    // pinned solutions are never evicted from the cache (solutions shown by postprocessor)
+    void setPinnedSolutions(QList<FieldSolutionID> solutionIDs);
+
+    inline CacheStatistics cacheStatistics() const { return m_cacheStatistics; }
+    inline qint64 cacheMemorySize() const { return m_multiSolutionCacheMemorySize; }
+    inline int cacheCount() const { return m_multiSolutionCache.count(); }
+
+    // probes are evaluated right after the solution is added (while it is still in memory)
+    enum ProbeType
+    {
+        ProbeType_LocalValue = 0,
+        ProbeType_SurfaceIntegral = 1,
+        ProbeType_VolumeIntegral = 2
+    };
+
+    struct Probe
+    {
+        Probe(const FieldInfo *fieldInfo = NULL, ProbeType type = ProbeType_LocalValue,
+              const Point &point = Point(), const QList<int> &regions = QList<int>())
+            : fieldInfo(fieldInfo), type(type), point(point), regions(regions) {}
+
+        bool operator==(const Probe &probe) const;
+
+        const FieldInfo *fieldInfo;
+        ProbeType type;
+        // local value
+        Point point;
+        // edges or labels of the integral
+        QList<int> regions;
+    };
+
+    // one record per time step, later adaptivity steps override earlier ones
+    struct ProbeSeries
+    {
+        QVector<int> timeSteps;
+        QVector<double> times;
+        // scalar variables and integrals
+        QMap<QString, QVector<double> > scalars;
+        // vector variables
+        QMap<QString, QVector<Point> > vectors;
+    };
+
+    // returns id of the probe (existing probe is reused), ids do not change when other probes are removed
+    int addProbe(const Probe &probe);
+    // returns -1 if probe is not registered
+    int findProbe(const Probe &probe) const;
+    bool hasProbe(int id) const;
+    void removeProbe(int id);
+    // removes probes of the field (all probes if field is not given)
+    void removeProbes(const FieldInfo *fieldInfo = NULL);
+    Probe probe(int id) const;
+    ProbeSeries probeSeries(int id) const;
+
+    // waits for all pending writes of solutions to the disk
+    void flush();
+
+    // solution archive, entries are extracted on demand
+    void openArchive(const QString &fileName);
+    void saveArchive(const QString &fileName);
+
 private:
-    QList<FieldSolutionID> m_multiSolutions;
-    QMap<FieldSolutionID, SolutionRunTimeDetails> m_multiSolutionRunTimeDetails;
+    // blocks of the problem can be solved in parallel
+    mutable QMutex m_mutex;
+
+    SolutionStoreWriter *m_writer;
+    SolutionArchive *m_archive;
+
+    // extracts file from the archive to the cache directory (if needed)
+    void extractFromArchive(const QString &fileName);
+    // prints errors of the background writer
+    void printWriterErrors();
+
+    // stored solutions in order of insertion
+    QMap<qint64, FieldSolutionID> m_multiSolutions;
+    QMap<FieldSolutionID, qint64> m_multiSolutionOrder;
+    qint64 m_multiSolutionCounter;
+
+    // index of stored solutions: (field, solution mode) -> time step -> adaptivity steps
+    typedef QMap<int, QMap<int, bool> > TimeStepIndex;
+    QHash<QPair<const FieldInfo *, int>, TimeStepIndex> m_multiSolutionIndex;
+    // field -> time step -> number of stored solutions
+    QHash<const FieldInfo *, QMap<int, int> > m_multiSolutionTimeStepIndex;
+    // field -> sorted time steps (time levels)
+    QHash<const FieldInfo *, QVector<int> > m_multiSolutionTimeLevels;
+
+    void insertSolutionID(FieldSolutionID solutionID);
+    void removeSolutionID(FieldSolutionID solutionID);
+    // details are read from the manifest on first access (offsets come from the index)
+    mutable QMap<FieldSolutionID, SolutionRunTimeDetails> m_multiSolutionRunTimeDetails;
+    mutable QMap<FieldSolutionID, qint64> m_multiSolutionRunTimeOffsets;
+    SolutionRunTimeDetails runTimeDetails(FieldSolutionID solutionID) const;
+    bool containsRunTimeDetails(FieldSolutionID solutionID) const;
     QMap<FieldSolutionID, MultiArray<double> > m_multiSolutionCache;
+    // least recently used first
     QList<FieldSolutionID> m_multiSolutionCacheIDOrder;
+    QMap<FieldSolutionID, qint64> m_multiSolutionCacheMemorySizes;
+    qint64 m_multiSolutionCacheMemorySize;
+    QList<FieldSolutionID> m_multiSolutionCachePinned;
+    CacheStatistics m_cacheStatistics;
 
     void addSolution(FieldSolutionID solutionID, MultiArray<double> multiArray, SolutionRunTimeDetails runTime);
     void removeSolution(FieldSolutionID solutionID, bool saveRunTime = true);
 
     void insertMultiSolutionToCache(FieldSolutionID solutionID, MultiArray<double> multiArray);
+    void removeMultiSolutionFromCache(FieldSolutionID solutionID);
+
+    // estimated memory footprint of meshes, spaces and solutions (bytes)
+    qint64 multiArrayMemorySize(MultiArray<double> multiArray) const;
 
     QString baseStoreFileName(FieldSolutionID solutionID) const;
 
-    void saveRunTimeDetails();
+    // probes and their series (by id)
+    QMap<int, Probe> m_probes;
+    QMap<int, ProbeSeries> m_probeSeries;
+    int m_probeCounter;
+
+    // evaluates probes of the field, local values and integrals are calculated in one pass
+    void recordProbes(FieldSolutionID solutionID);
+    void recordProbe(int id, int timeStep, const QMap<QString, double> &scalars, const QMap<QString, Point> &vectors);
+    void removeProbeRecords(int timeStep);
+
+    // append-only manifest, later records override earlier ones
+    enum RunTimeRecord
+    {
+        RunTimeRecord_Add = 0,
+        RunTimeRecord_Replace = 1,
+        RunTimeRecord_Remove = 2
+    };
+
+    void appendRunTimeDetails(FieldSolutionID solutionID, RunTimeRecord record);
+    // fixed size entries (solution id, time step length, offset of the record in the manifest)
+    void appendRunTimeIndex(FieldSolutionID solutionID, RunTimeRecord record, qint64 offset);
+    // returns false if the index is missing or does not match the manifest
+    bool loadRunTimeIndex();
+    void loadRunTimeDetailsXML(const QString &fn);
 };
 
 #endif // SOLUTIONSTORE_H
@@ -481,8 +481,9 @@ void ProblemSolver<Scalar>::solveSimple(int timeStep, int adaptivityStep)
         bool matrixUnchanged = m_block->weakForm()->bdf2Table()->setOrderAndPreviousSteps(order, Agros2D::problem()->timeStepLengths());
         m_hermesSolverContainer->matrixUnchangedDueToBDF(matrixUnchanged);
 
-        // update timedep values
-        Module::updateTimeFunctions(Agros2D::problem()->actualTime());
+        // update timedep values (only fields of the block, other blocks could be solved concurrently)
+        foreach (Field* field, m_block->fields())
+            Module::updateTimeFunctions(Agros2D::problem()->actualTime(), field->fieldInfo());
     }
 
     m_block->weakForm()->set_current_time(Agros2D::problem()->actualTime());
@@ -537,37 +538,71 @@ TimeStepInfo ProblemSolver<Scalar>::estimateTimeStepLength(int timeStep, int ada
     // todo: ensure this in gui
     assert(Agros2D::problem()->config()->value(ProblemConfig::TimeOrder).toInt() >= 2);
 
+    int ndof = Hermes::Hermes2D::Space<Scalar>::get_num_dofs(actualSpaces());
+    Scalar *solutionVector = m_hermesSolverContainer->slnVector();
+
+    // history of accepted steps is not valid for the changed spaces (even with the same number of DOFs)
+    bool spacesChanged = (m_previousSolutionSpaces.size() != actualSpaces().size());
+    for (int i = 0; !spacesChanged && (i < actualSpaces().size()); i++)
+        if (m_previousSolutionSpaces[i].get() != actualSpaces()[i].get())
+            spacesChanged = true;
+
+    if (!m_previousSolutionVectors.isEmpty() && (spacesChanged || (m_previousSolutionVectors.last().second.size() != ndof)))
+        m_previousSolutionVectors.clear();
+
     // todo: in the first step, I am acualy using order 1 and thus I am unable to decrease it!
     // this is not good, since the second step is not calculated (and the error of the first is not being checked)
-    if (timeStep == 1)
+    // predictor needs at least a linear extrapolation
+    if ((timeStep == 1) || (m_previousSolutionVectors.size() < 2))
     {
         m_averageErrorToLenghtRatio = 0.;
+        storeSolutionVector(solutionVector, ndof);
         return TimeStepInfo(Agros2D::problem()->actualTimeStepLength());
     }
 
+    // predictor: polynomial extrapolation of the previous accepted steps to the actual time
+    // the difference between the predictor and the (corrector) solution estimates the local error without a second solve
     int previouslyUsedOrder = min(timeStep, Agros2D::problem()->config()->value(ProblemConfig::TimeOrder).toInt());
-    bool matrixUnchanged = m_block->weakForm()->bdf2Table()->setOrderAndPreviousSteps(previouslyUsedOrder - 1, Agros2D::problem()->timeStepLengths());
-    // using different order
-    assert(matrixUnchanged == false);
-    m_hermesSolverContainer->matrixUnchangedDueToBDF(matrixUnchanged);
-    m_block->weakForm()->set_current_time(Agros2D::problem()->actualTime());
-    m_block->weakForm()->updateExtField();
+    int numPoints = min(previouslyUsedOrder + 1, m_previousSolutionVectors.size());
+    int first = m_previousSolutionVectors.size() - numPoints;
 
-    // solutions obtained by time method of higher order in the original calculation
-    Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<Scalar> > timeReferenceSolution;
-    if(timeStep > 0)
-        timeReferenceSolution = referenceCalculation.solutions();
-    Scalar *solutionVector = solveOneProblem(actualSpaces(), adaptivityStep, timeReferenceSolution);
+    double actualTime = Agros2D::problem()->actualTime();
+    QVector<Scalar> predictorVector(ndof, 0.0);
+    for (int i = first; i < m_previousSolutionVectors.size(); i++)
+    {
+        // Lagrange basis evaluated at the actual time
+        double coefficient = 1.0;
+        for (int j = first; j < m_previousSolutionVectors.size(); j++)
+            if (j != i)
+                coefficient *= (actualTime - m_previousSolutionVectors[j].first) / (m_previousSolutionVectors[i].first - m_previousSolutionVectors[j].first);
+
+        const Scalar *previousVector = m_previousSolutionVectors[i].second.constData();
+        for (int k = 0; k < ndof; k++)
+            predictorVector[k] += coefficient * previousVector[k];
+    }
 
     Hermes::vector<Hermes::Hermes2D::MeshSharedPtr> meshes = spacesMeshes(actualSpaces());
     Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<Scalar> > solutions = createSolutions<Scalar>(meshes);
-    Solution<Scalar>::vector_to_solutions(solutionVector, actualSpaces(), solutions);
+    Solution<Scalar>::vector_to_solutions(predictorVector.data(), actualSpaces(), solutions);
 
     // error calculation
     DefaultErrorCalculator<double, HERMES_H1_NORM> errorCalculator(RelativeErrorToGlobalNorm, solutions.size());
     // calculate error the total error estimate.
     errorCalculator.calculate_errors(referenceCalculation.solutions(), solutions, false);
-    double error = errorCalculator.get_total_error_squared();
+
+    // Milne's device: local error of the corrector is C / (C* - C) * (corrector - predictor)
+    // C = -1 / (p + 1) is the error constant of BDF of order p (constant steps)
+    // C* is the error constant of the extrapolation through p + 1 points, i.e. prod (t - t_j) / ((p + 1)! h^(p + 1))
+    int order = numPoints - 1;
+    double h = Agros2D::problem()->actualTimeStepLength();
+    double errorConstantCorrector = -1.0 / (order + 1);
+    double errorConstantPredictor = 1.0;
+    for (int j = first; j < m_previousSolutionVectors.size(); j++)
+        errorConstantPredictor *= (actualTime - m_previousSolutionVectors[j].first) / (h * (j - first + 1));
+
+    // error is squared
+    double errorConstant = errorConstantCorrector / (errorConstantPredictor - errorConstantCorrector);
+    double error = errorConstant * errorConstant * errorCalculator.get_total_error_squared();
 
     // update
     double actualRatio = error / Agros2D::problem()->actualTimeStepLength();
@@ -618,10 +653,25 @@ TimeStepInfo ProblemSolver<Scalar>::estimateTimeStepLength(int timeStep, int ada
                                arg(m_averageErrorToLenghtRatio));
     if(refuseThisStep)
         Agros2D::log()->printMessage(m_solverID, "Transient step refused");
+    else
+        storeSolutionVector(solutionVector, ndof);
 
     return TimeStepInfo(nextTimeStepLength, refuseThisStep);
 }
 
+template <typename Scalar>
+void ProblemSolver<Scalar>::storeSolutionVector(const Scalar *solutionVector, int ndof)
+{
+    m_previousSolutionVectors.append(QPair<double, QVector<Scalar> >(Agros2D::problem()->actualTime(), QVector<Scalar>(ndof)));
+    memcpy(m_previousSolutionVectors.last().second.data(), solutionVector, ndof * sizeof(Scalar));
+    m_previousSolutionSpaces = actualSpaces();
+
+    // predictor of order p needs p + 1 previous steps
+    int timeOrder = Agros2D::problem()->config()->value(ProblemConfig::TimeOrder).toInt();
+    while (m_previousSolutionVectors.size() > timeOrder + 1)
+        m_previousSolutionVectors.removeFirst();
+}
+
 template <typename Scalar>
 void ProblemSolver<Scalar>::createInitialSpace()
 {
@@ -748,9 +798,9 @@ void ProblemSolver<Scalar>::solveReferenceAndProject(int timeStep, int adaptivit
         throw(AgrosSolverException(QObject::tr("DOF is zero")));
     }
 
-    // update timedep values
+    // update timedep values (only fields of the block, other blocks could be solved concurrently)
     foreach (Field* field, m_block->fields())
-        Module::updateTimeFunctions(Agros2D::problem()->actualTime());
+        Module::updateTimeFunctions(Agros2D::problem()->actualTime(), field->fieldInfo());
     m_block->updateExactSolutionFunctions();
 
     // todo: delete? delam to pro referencni... (zkusit)
@@ -165,6 +165,11 @@ private:
 
     // to be used in advanced time step adaptivity
     double m_averageErrorToLenghtRatio;
+    // solution vectors of the accepted time steps (time, vector), used by the time error estimate
+    QList<QPair<double, QVector<Scalar> > > m_previousSolutionVectors;
+    // spaces of the history (kept alive, new spaces of adaptivity invalidate the history)
+    Hermes::vector<Hermes::Hermes2D::SpaceSharedPtr<Scalar> > m_previousSolutionSpaces;
+    void storeSolutionVector(const Scalar *solutionVector, int ndof);
 
     void initSelectors(Hermes::vector<QSharedPointer<Hermes::Hermes2D::RefinementSelectors::Selector<Scalar> > >& selectors);
 
@@ -33,7 +33,7 @@
 
 #include "qcustomplot/qcustomplot.h"
 
-Log::Log()
+Log::Log() : m_mutex(QMutex::Recursive)
 {
     qRegisterMetaType<QVector<double> >("QVector<double>");
     qRegisterMetaType<SolverAgros::Phase>("SolverAgros::Phase");
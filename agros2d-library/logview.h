@@ -34,17 +34,18 @@ class AGROS_LIBRARY_API Log: public QObject
 public:
     Log();
 
-    inline void printHeading(const QString &message) { emit headingMsg(message); }
-    inline void printMessage(const QString &module, const QString &message) { emit messageMsg(module, message); }
-    inline void printError(const QString &module, const QString &message) { emit errorMsg(module, message); }
-    inline void printWarning(const QString &module, const QString &message) { emit warningMsg(module, message); }
-    inline void printDebug(const QString &module, const QString &message) { emit debugMsg(module, message); }
+    // messages could come from concurrently solved blocks
+    inline void printHeading(const QString &message) { QMutexLocker locker(&m_mutex); emit headingMsg(message); }
+    inline void printMessage(const QString &module, const QString &message) { QMutexLocker locker(&m_mutex); emit messageMsg(module, message); }
+    inline void printError(const QString &module, const QString &message) { QMutexLocker locker(&m_mutex); emit errorMsg(module, message); }
+    inline void printWarning(const QString &module, const QString &message) { QMutexLocker locker(&m_mutex); emit warningMsg(module, message); }
+    inline void printDebug(const QString &module, const QString &message) { QMutexLocker locker(&m_mutex); emit debugMsg(module, message); }
 
-    inline void updateNonlinearChartInfo(SolverAgros::Phase phase, const QVector<double> steps, const QVector<double> relativeChangeOfSolutions) { emit updateNonlinearChart(phase, steps, relativeChangeOfSolutions); }
-    inline void updateAdaptivityChartInfo(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep) { emit updateAdaptivityChart(fieldInfo, timeStep, adaptivityStep); }
-    inline void updateTransientChartInfo(double actualTime) { emit updateTransientChart(actualTime); }
+    inline void updateNonlinearChartInfo(SolverAgros::Phase phase, const QVector<double> steps, const QVector<double> relativeChangeOfSolutions) { QMutexLocker locker(&m_mutex); emit updateNonlinearChart(phase, steps, relativeChangeOfSolutions); }
+    inline void updateAdaptivityChartInfo(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep) { QMutexLocker locker(&m_mutex); emit updateAdaptivityChart(fieldInfo, timeStep, adaptivityStep); }
+    inline void updateTransientChartInfo(double actualTime) { QMutexLocker locker(&m_mutex); emit updateTransientChart(actualTime); }
 
-    inline void addIcon(const QIcon &icn, const QString &label) { emit addIconImg(icn, label); }
+    inline void addIcon(const QIcon &icn, const QString &label) { QMutexLocker locker(&m_mutex); emit addIconImg(icn, label); }
 
 signals:
     void headingMsg(const QString &message);
@@ -58,6 +59,9 @@ signals:
     void updateTransientChart(double actualTime);
 
     void addIconImg(const QIcon &icn, const QString &label);
+
+private:
+    QMutex m_mutex;
 };
 
 class AGROS_LIBRARY_API LogWidget : public QWidget
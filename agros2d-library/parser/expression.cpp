@@ -0,0 +1,630 @@
+// This file is part of Agros2D.
+//
+// Agros2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Agros2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Agros2D.  If not, see <http://www.gnu.org/licenses/>.
+//
+// hp-FEM group (http://hpfem.org/)
+// University of Nevada, Reno (UNR) and University of West Bohemia, Pilsen
+// Email: agros2d@googlegroups.com, home page: http://hpfem.org/agros2d/
+
+#include "expression.h"
+#include "lex.h"
+
+// evaluation stack is allocated on the stack of the calling thread
+const int EXPRESSION_STACK_SIZE = 32;
+// number of points evaluated by one pass of the program
+const int EXPRESSION_BATCH_SIZE = 64;
+
+struct ExpressionFunction
+{
+    const char *name;
+    CompiledExpression::OpCode opCode;
+    int arguments; // -1 ... variable number of arguments (at least two)
+};
+
+// functions from Python math module and builtins
+static const ExpressionFunction expressionFunctions[] =
+{
+    { "sin", CompiledExpression::OpCode_Sin, 1 },
+    { "cos", CompiledExpression::OpCode_Cos, 1 },
+    { "tan", CompiledExpression::OpCode_Tan, 1 },
+    { "asin", CompiledExpression::OpCode_Asin, 1 },
+    { "acos", CompiledExpression::OpCode_Acos, 1 },
+    { "atan", CompiledExpression::OpCode_Atan, 1 },
+    { "atan2", CompiledExpression::OpCode_Atan2, 2 },
+    { "sinh", CompiledExpression::OpCode_Sinh, 1 },
+    { "cosh", CompiledExpression::OpCode_Cosh, 1 },
+    { "tanh", CompiledExpression::OpCode_Tanh, 1 },
+    { "asinh", CompiledExpression::OpCode_Asinh, 1 },
+    { "acosh", CompiledExpression::OpCode_Acosh, 1 },
+    { "atanh", CompiledExpression::OpCode_Atanh, 1 },
+    { "exp", CompiledExpression::OpCode_Exp, 1 },
+    { "log", CompiledExpression::OpCode_Log, 1 },
+    { "log", CompiledExpression::OpCode_LogBase, 2 },
+    { "log10", CompiledExpression::OpCode_Log10, 1 },
+    { "sqrt", CompiledExpression::OpCode_Sqrt, 1 },
+    { "pow", CompiledExpression::OpCode_Power, 2 },
+    { "abs", CompiledExpression::OpCode_Abs, 1 },
+    { "fabs", CompiledExpression::OpCode_Abs, 1 },
+    { "floor", CompiledExpression::OpCode_Floor, 1 },
+    { "ceil", CompiledExpression::OpCode_Ceil, 1 },
+    { "degrees", CompiledExpression::OpCode_Degrees, 1 },
+    { "radians", CompiledExpression::OpCode_Radians, 1 },
+    { "hypot", CompiledExpression::OpCode_Hypot, 2 },
+    { "fmod", CompiledExpression::OpCode_Fmod, 2 },
+    { "min", CompiledExpression::OpCode_Min, -1 },
+    { "max", CompiledExpression::OpCode_Max, -1 },
+    { NULL, CompiledExpression::OpCode_Number, 0 }
+};
+
+// recursive descent parser with Python operator precedence, builds syntax tree and folds constants
+class ExpressionParser
+{
+public:
+    ExpressionParser(const QString &expression, const QStringList &variables)
+        : m_expression(expression), m_variables(variables), m_position(0)
+    {
+        LexicalAnalyser lex;
+        lex.setExpression(expression);
+
+        // split signed numbers, sign is an operator ("-2**2" is "-(2**2)" in Python)
+        foreach (Token token, lex.tokens())
+        {
+            QString text = token.toString();
+            if ((token.type() == ParserTokenType_NUMBER) && (text.startsWith("-") || text.startsWith("+")))
+            {
+                m_tokens.append(Token(ParserTokenType_OPERATOR, text.left(1), 0, token.position()));
+                m_tokens.append(Token(ParserTokenType_NUMBER, text.mid(1), 0, token.position() + 1));
+            }
+            else
+            {
+                m_tokens.append(token);
+            }
+        }
+    }
+
+    void compile(CompiledExpression *compiled)
+    {
+        int root = comparison();
+        if (m_position < m_tokens.count())
+            error("Unexpected symbol");
+
+        if (depth(root) > EXPRESSION_STACK_SIZE)
+            error("Expression is too complex");
+
+        generate(compiled->m_program, root);
+    }
+
+private:
+    struct Node
+    {
+        Node(CompiledExpression::OpCode opCode = CompiledExpression::OpCode_Number, double value = 0.0, bool isInteger = false)
+            : opCode(opCode), value(value), index(0), isInteger(isInteger), left(-1), right(-1) {}
+
+        CompiledExpression::OpCode opCode;
+        double value;
+        int index;
+        bool isInteger;
+        int left;
+        int right;
+    };
+
+    QString m_expression;
+    QStringList m_variables;
+    QList<Token> m_tokens;
+    int m_position;
+
+    QList<Node> m_nodes;
+
+    void error(const QString &message)
+    {
+        if (m_position < m_tokens.count())
+            throw ParserException(QString("%1 '%2' in expression '%3'").arg(message).arg(m_tokens[m_position].toString()).arg(m_expression),
+                                  m_expression, m_tokens[m_position].position(), m_tokens[m_position].toString());
+        else
+            throw ParserException(QString("%1 in expression '%2'").arg(message).arg(m_expression),
+                                  m_expression, m_expression.length(), "");
+    }
+
+    bool isOperator(const QString &op)
+    {
+        return (m_position < m_tokens.count())
+                && (m_tokens[m_position].type() == ParserTokenType_OPERATOR)
+                && (m_tokens[m_position].toString() == op);
+    }
+
+    void expect(const QString &op)
+    {
+        if (!isOperator(op))
+            error(QString("Expected '%1' instead of").arg(op));
+        m_position++;
+    }
+
+    int addNode(const Node &node)
+    {
+        m_nodes.append(node);
+        return m_nodes.count() - 1;
+    }
+
+    int addOperator(CompiledExpression::OpCode opCode, int left, int right = -1)
+    {
+        const Node &a = m_nodes[left];
+
+        // constant folding
+        if ((a.opCode == CompiledExpression::OpCode_Number) && ((right == -1) || (m_nodes[right].opCode == CompiledExpression::OpCode_Number)))
+        {
+            const Node b = (right == -1) ? Node() : m_nodes[right];
+
+            // Python 2 integer arithmetic
+            bool isInteger = false;
+            double value = 0.0;
+            if (a.isInteger && (right == -1 || b.isInteger))
+            {
+                switch (opCode)
+                {
+                case CompiledExpression::OpCode_Negate:
+                case CompiledExpression::OpCode_Abs:
+                case CompiledExpression::OpCode_Add:
+                case CompiledExpression::OpCode_Subtract:
+                case CompiledExpression::OpCode_Multiply:
+                case CompiledExpression::OpCode_Min:
+                case CompiledExpression::OpCode_Max:
+                case CompiledExpression::OpCode_Equal:
+                case CompiledExpression::OpCode_NotEqual:
+                case CompiledExpression::OpCode_Less:
+                case CompiledExpression::OpCode_Greater:
+                case CompiledExpression::OpCode_LessEqual:
+                case CompiledExpression::OpCode_GreaterEqual:
+                    isInteger = true;
+                    break;
+                case CompiledExpression::OpCode_Divide:
+                    if (b.value == 0.0)
+                        error("Division by zero");
+                    isInteger = true;
+                    value = floor(a.value / b.value);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (!(isInteger && opCode == CompiledExpression::OpCode_Divide))
+                value = CompiledExpression::apply(opCode, a.value, b.value);
+
+            if (!std::isfinite(value))
+                error("Invalid operation");
+
+            Node node(CompiledExpression::OpCode_Number, value, isInteger);
+            return addNode(node);
+        }
+
+        Node node(opCode);
+        node.left = left;
+        node.right = right;
+        return addNode(node);
+    }
+
+    // comparison := additive [('==' | '!=' | '<' | '>' | '<=' | '>=') additive]
+    int comparison()
+    {
+        int left = additive();
+
+        static const char *operators[] = { "==", "!=", "<", ">", "<=", ">=" };
+        static const CompiledExpression::OpCode opCodes[] = { CompiledExpression::OpCode_Equal, CompiledExpression::OpCode_NotEqual,
+                                                             CompiledExpression::OpCode_Less, CompiledExpression::OpCode_Greater,
+                                                             CompiledExpression::OpCode_LessEqual, CompiledExpression::OpCode_GreaterEqual };
+
+        for (int i = 0; i < 6; i++)
+        {
+            if (isOperator(operators[i]))
+            {
+                m_position++;
+                left = addOperator(opCodes[i], left, additive());
+
+                // chained comparison (a < b < c) is left to Python
+                for (int j = 0; j < 6; j++)
+                    if (isOperator(operators[j]))
+                        error("Chained comparison");
+
+                break;
+            }
+        }
+
+        return left;
+    }
+
+    // additive := term (('+' | '-') term)*
+    int additive()
+    {
+        int left = term();
+        while (isOperator("+") || isOperator("-"))
+        {
+            CompiledExpression::OpCode opCode = isOperator("+") ? CompiledExpression::OpCode_Add : CompiledExpression::OpCode_Subtract;
+            m_position++;
+            left = addOperator(opCode, left, term());
+        }
+
+        return left;
+    }
+
+    // term := unary (('*' | '/') unary)*
+    int term()
+    {
+        int left = unary();
+        while (isOperator("*") || isOperator("/"))
+        {
+            CompiledExpression::OpCode opCode = isOperator("*") ? CompiledExpression::OpCode_Multiply : CompiledExpression::OpCode_Divide;
+            m_position++;
+            left = addOperator(opCode, left, unary());
+        }
+
+        return left;
+    }
+
+    // unary := ('+' | '-') unary | power
+    int unary()
+    {
+        if (isOperator("+"))
+        {
+            m_position++;
+            return unary();
+        }
+        if (isOperator("-"))
+        {
+            m_position++;
+            return addOperator(CompiledExpression::OpCode_Negate, unary());
+        }
+
+        return power();
+    }
+
+    // power := primary ['**' unary]
+    int power()
+    {
+        int left = primary();
+        if (isOperator("**"))
+        {
+            m_position++;
+            int right = unary();
+
+            // integer result only for literal exponent
+            const Node &a = m_nodes[left];
+            const Node &b = m_nodes[right];
+            if (a.opCode == CompiledExpression::OpCode_Number && b.opCode == CompiledExpression::OpCode_Number)
+            {
+                double value = CompiledExpression::apply(CompiledExpression::OpCode_Power, a.value, b.value);
+                if (!std::isfinite(value))
+                    error("Invalid operation");
+
+                return addNode(Node(CompiledExpression::OpCode_Number, value, a.isInteger && b.isInteger && b.value >= 0.0));
+            }
+
+            Node node(CompiledExpression::OpCode_Power);
+            node.left = left;
+            node.right = right;
+            return addNode(node);
+        }
+
+        return left;
+    }
+
+    // primary := number | variable | function '(' arguments ')' | '(' comparison ')'
+    int primary()
+    {
+        if (m_position >= m_tokens.count())
+            error("Unexpected end");
+
+        Token token = m_tokens[m_position];
+        QString text = token.toString();
+
+        if (token.type() == ParserTokenType_NUMBER)
+        {
+            m_position++;
+
+            bool isInteger = false;
+            double value = text.toInt(&isInteger);
+            if (!isInteger)
+                value = text.toDouble();
+
+            return addNode(Node(CompiledExpression::OpCode_Number, value, isInteger));
+        }
+
+        if (token.type() == ParserTokenType_VARIABLE)
+        {
+            m_position++;
+
+            int index = m_variables.indexOf(text);
+            if (index != -1)
+            {
+                Node node(CompiledExpression::OpCode_Variable);
+                node.index = index;
+                return addNode(node);
+            }
+
+            if (text == "pi")
+                return addNode(Node(CompiledExpression::OpCode_Number, M_PI));
+            if (text == "e")
+                return addNode(Node(CompiledExpression::OpCode_Number, M_E));
+
+            // user defined variables are known only to Python
+            m_position--;
+            error("Unknown variable");
+        }
+
+        if (token.type() == ParserTokenType_FUNCTION)
+        {
+            m_position++;
+            expect("(");
+
+            QList<int> arguments;
+            arguments.append(comparison());
+            while (isOperator(","))
+            {
+                m_position++;
+                arguments.append(comparison());
+            }
+
+            expect(")");
+
+            for (int i = 0; expressionFunctions[i].name; i++)
+            {
+                const ExpressionFunction &function = expressionFunctions[i];
+                if (text != function.name)
+                    continue;
+
+                if (function.arguments == -1 && arguments.count() >= 2)
+                {
+                    int left = arguments[0];
+                    for (int j = 1; j < arguments.count(); j++)
+                        left = addOperator(function.opCode, left, arguments[j]);
+
+                    return left;
+                }
+
+                if (function.arguments == 1 && arguments.count() == 1)
+                {
+                    int node = addOperator(function.opCode, arguments[0]);
+                    if (function.opCode != CompiledExpression::OpCode_Abs || text == "fabs")
+                        m_nodes[node].isInteger = false;
+                    return node;
+                }
+
+                if (function.arguments == 2 && arguments.count() == 2)
+                {
+                    int node = addOperator(function.opCode, arguments[0], arguments[1]);
+                    m_nodes[node].isInteger = false;
+                    return node;
+                }
+            }
+
+            m_position--;
+            error("Unknown function");
+        }
+
+        if (isOperator("("))
+        {
+            m_position++;
+            int node = comparison();
+            expect(")");
+
+            return node;
+        }
+
+        error("Unexpected symbol");
+        return -1;
+    }
+
+    int depth(int node) const
+    {
+        const Node &n = m_nodes[node];
+        if (n.left == -1)
+            return 1;
+        if (n.right == -1)
+            return depth(n.left);
+
+        return qMax(depth(n.left), depth(n.right) + 1);
+    }
+
+    void generate(QVector<CompiledExpression::Instruction> &program, int node) const
+    {
+        const Node &n = m_nodes[node];
+        if (n.left != -1)
+            generate(program, n.left);
+        if (n.right != -1)
+            generate(program, n.right);
+
+        program.append(CompiledExpression::Instruction(n.opCode, n.value, n.index));
+    }
+};
+
+CompiledExpression *CompiledExpression::compile(const QString &expression, const QStringList &variables)
+{
+    CompiledExpression *compiled = new CompiledExpression();
+
+    try
+    {
+        ExpressionParser parser(expression, variables);
+        parser.compile(compiled);
+    }
+    catch (ParserException &)
+    {
+        delete compiled;
+        return NULL;
+    }
+
+    return compiled;
+}
+
+bool CompiledExpression::evaluate(const double *variables, double &result) const
+{
+    double stack[EXPRESSION_STACK_SIZE];
+    int top = -1;
+
+    for (int i = 0; i < m_program.size(); i++)
+    {
+        const Instruction &instruction = m_program[i];
+
+        switch (instruction.opCode)
+        {
+        case OpCode_Number:
+            stack[++top] = instruction.value;
+            break;
+        case OpCode_Variable:
+            stack[++top] = variables[instruction.index];
+            break;
+        default:
+            if (isUnary(instruction.opCode))
+            {
+                stack[top] = apply(instruction.opCode, stack[top]);
+            }
+            else
+            {
+                top--;
+                stack[top] = apply(instruction.opCode, stack[top], stack[top + 1]);
+            }
+        }
+    }
+
+    result = stack[0];
+    return std::isfinite(result);
+}
+
+bool CompiledExpression::evaluate(int n, const double * const *variables, const int *increments, double *result) const
+{
+    double stack[EXPRESSION_STACK_SIZE][EXPRESSION_BATCH_SIZE];
+    bool isFinite = true;
+
+    for (int offset = 0; offset < n; offset += EXPRESSION_BATCH_SIZE)
+    {
+        int count = qMin(EXPRESSION_BATCH_SIZE, n - offset);
+        int top = -1;
+
+        for (int i = 0; i < m_program.size(); i++)
+        {
+            const Instruction &instruction = m_program[i];
+
+            switch (instruction.opCode)
+            {
+            case OpCode_Number:
+                top++;
+                for (int k = 0; k < count; k++)
+                    stack[top][k] = instruction.value;
+                break;
+            case OpCode_Variable:
+            {
+                top++;
+                const double *variable = variables[instruction.index];
+                int increment = increments[instruction.index];
+                for (int k = 0; k < count; k++)
+                    stack[top][k] = variable[(offset + k) * increment];
+                break;
+            }
+            // most frequent operators without dispatch in the inner loop
+            case OpCode_Negate:
+                for (int k = 0; k < count; k++)
+                    stack[top][k] = -stack[top][k];
+                break;
+            case OpCode_Add:
+                top--;
+                for (int k = 0; k < count; k++)
+                    stack[top][k] += stack[top + 1][k];
+                break;
+            case OpCode_Subtract:
+                top--;
+                for (int k = 0; k < count; k++)
+                    stack[top][k] -= stack[top + 1][k];
+                break;
+            case OpCode_Multiply:
+                top--;
+                for (int k = 0; k < count; k++)
+                    stack[top][k] *= stack[top + 1][k];
+                break;
+            case OpCode_Divide:
+                top--;
+                for (int k = 0; k < count; k++)
+                    stack[top][k] /= stack[top + 1][k];
+                break;
+            default:
+                if (isUnary(instruction.opCode))
+                {
+                    for (int k = 0; k < count; k++)
+                        stack[top][k] = apply(instruction.opCode, stack[top][k]);
+                }
+                else
+                {
+                    top--;
+                    for (int k = 0; k < count; k++)
+                        stack[top][k] = apply(instruction.opCode, stack[top][k], stack[top + 1][k]);
+                }
+            }
+        }
+
+        for (int k = 0; k < count; k++)
+        {
+            result[offset + k] = stack[0][k];
+            if (!std::isfinite(stack[0][k]))
+                isFinite = false;
+        }
+    }
+
+    return isFinite;
+}
+
+double CompiledExpression::apply(OpCode opCode, double a, double b)
+{
+    switch (opCode)
+    {
+    case OpCode_Negate: return -a;
+    case OpCode_Sin: return sin(a);
+    case OpCode_Cos: return cos(a);
+    case OpCode_Tan: return tan(a);
+    case OpCode_Asin: return asin(a);
+    case OpCode_Acos: return acos(a);
+    case OpCode_Atan: return atan(a);
+    case OpCode_Sinh: return sinh(a);
+    case OpCode_Cosh: return cosh(a);
+    case OpCode_Tanh: return tanh(a);
+    case OpCode_Asinh: return asinh(a);
+    case OpCode_Acosh: return acosh(a);
+    case OpCode_Atanh: return atanh(a);
+    case OpCode_Exp: return exp(a);
+    case OpCode_Log: return log(a);
+    case OpCode_Log10: return log10(a);
+    case OpCode_Sqrt: return sqrt(a);
+    case OpCode_Abs: return fabs(a);
+    case OpCode_Floor: return floor(a);
+    case OpCode_Ceil: return ceil(a);
+    case OpCode_Degrees: return a * 180.0 / M_PI;
+    case OpCode_Radians: return a * M_PI / 180.0;
+    case OpCode_Add: return a + b;
+    case OpCode_Subtract: return a - b;
+    case OpCode_Multiply: return a * b;
+    case OpCode_Divide: return a / b;
+    case OpCode_Power: return pow(a, b);
+    case OpCode_Equal: return (a == b) ? 1.0 : 0.0;
+    case OpCode_NotEqual: return (a != b) ? 1.0 : 0.0;
+    case OpCode_Less: return (a < b) ? 1.0 : 0.0;
+    case OpCode_Greater: return (a > b) ? 1.0 : 0.0;
+    case OpCode_LessEqual: return (a <= b) ? 1.0 : 0.0;
+    case OpCode_GreaterEqual: return (a >= b) ? 1.0 : 0.0;
+    case OpCode_Atan2: return atan2(a, b);
+    case OpCode_LogBase: return log(a) / log(b);
+    case OpCode_Hypot: return hypot(a, b);
+    case OpCode_Fmod: return fmod(a, b);
+    case OpCode_Min: return qMin(a, b);
+    case OpCode_Max: return qMax(a, b);
+    default:
+        assert(0);
+        return 0.0;
+    }
+}
@@ -0,0 +1,112 @@
+// This file is part of Agros2D.
+//
+// Agros2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Agros2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Agros2D.  If not, see <http://www.gnu.org/licenses/>.
+//
+// hp-FEM group (http://hpfem.org/)
+// University of Nevada, Reno (UNR) and University of West Bohemia, Pilsen
+// Email: agros2d@googlegroups.com, home page: http://hpfem.org/agros2d/
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include "util.h"
+
+class ExpressionParser;
+
+// bytecode of the math subset of Python expressions (operators, math functions, variables)
+// program is immutable after compilation, evaluation is thread-safe
+class AGROS_LIBRARY_API CompiledExpression
+{
+public:
+    enum OpCode
+    {
+        OpCode_Number,
+        OpCode_Variable,
+        // unary
+        OpCode_Negate,
+        OpCode_Sin,
+        OpCode_Cos,
+        OpCode_Tan,
+        OpCode_Asin,
+        OpCode_Acos,
+        OpCode_Atan,
+        OpCode_Sinh,
+        OpCode_Cosh,
+        OpCode_Tanh,
+        OpCode_Asinh,
+        OpCode_Acosh,
+        OpCode_Atanh,
+        OpCode_Exp,
+        OpCode_Log,
+        OpCode_Log10,
+        OpCode_Sqrt,
+        OpCode_Abs,
+        OpCode_Floor,
+        OpCode_Ceil,
+        OpCode_Degrees,
+        OpCode_Radians,
+        // binary
+        OpCode_Add,
+        OpCode_Subtract,
+        OpCode_Multiply,
+        OpCode_Divide,
+        OpCode_Power,
+        OpCode_Equal,
+        OpCode_NotEqual,
+        OpCode_Less,
+        OpCode_Greater,
+        OpCode_LessEqual,
+        OpCode_GreaterEqual,
+        OpCode_Atan2,
+        OpCode_LogBase,
+        OpCode_Hypot,
+        OpCode_Fmod,
+        OpCode_Min,
+        OpCode_Max
+    };
+
+    // returns NULL if expression cannot be compiled (unknown symbols, unsupported syntax)
+    // variables are bound to the position in the array passed to evaluate()
+    static CompiledExpression *compile(const QString &expression, const QStringList &variables);
+
+    // returns false if result is not finite (domain error, division by zero)
+    bool evaluate(const double *variables, double &result) const;
+    // evaluates n points at once, variable k is read from variables[k][i * increments[k]] (increment 0 for scalar)
+    // returns false if any of the results is not finite
+    bool evaluate(int n, const double * const *variables, const int *increments, double *result) const;
+
+    inline bool isConstant() const { return (m_program.size() == 1) && (m_program.first().opCode == OpCode_Number); }
+
+    static inline bool isUnary(OpCode opCode) { return (opCode >= OpCode_Negate) && (opCode < OpCode_Add); }
+    static double apply(OpCode opCode, double a, double b = 0.0);
+
+private:
+    struct Instruction
+    {
+        Instruction(OpCode opCode = OpCode_Number, double value = 0.0, int index = 0)
+            : opCode(opCode), value(value), index(index) {}
+
+        OpCode opCode;
+        double value;
+        int index;
+    };
+
+    CompiledExpression() {}
+
+    QVector<Instruction> m_program;
+
+    friend class ExpressionParser;
+};
+
+#endif // EXPRESSION_H
@@ -0,0 +1,104 @@
+// This file is part of Agros2D.
+//
+// Agros2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Agros2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Agros2D.  If not, see <http://www.gnu.org/licenses/>.
+//
+// hp-FEM group (http://hpfem.org/)
+// University of Nevada, Reno (UNR) and University of West Bohemia, Pilsen
+// Email: agros2d@googlegroups.com, home page: http://hpfem.org/agros2d/
+
+#include "edge_hash.h"
+
+#include "scenenode.h"
+#include "sceneedge.h"
+
+EdgeHash::EdgeHash(const QList<SceneEdge *> &edges) : m_edges(edges)
+{
+    Point min( numeric_limits<double>::max(),  numeric_limits<double>::max());
+    Point max(-numeric_limits<double>::max(), -numeric_limits<double>::max());
+
+    foreach (SceneEdge *edge, m_edges)
+    {
+        Point start(qMin(edge->nodeStart()->point().x, edge->nodeEnd()->point().x),
+                    qMin(edge->nodeStart()->point().y, edge->nodeEnd()->point().y));
+        Point end(qMax(edge->nodeStart()->point().x, edge->nodeEnd()->point().x),
+                  qMax(edge->nodeStart()->point().y, edge->nodeEnd()->point().y));
+
+        if (!edge->isStraight())
+        {
+            start = edge->center() - Point(edge->radius(), edge->radius());
+            end = edge->center() + Point(edge->radius(), edge->radius());
+        }
+
+        m_boundingBoxes.append(RectPoint(start, end));
+
+        min.x = qMin(min.x, start.x);
+        min.y = qMin(min.y, start.y);
+        max.x = qMax(max.x, end.x);
+        max.y = qMax(max.y, end.y);
+    }
+
+    if (m_edges.isEmpty())
+    {
+        min = Point();
+        max = Point();
+    }
+
+    // intersections are computed in floating point, boxes are slightly enlarged
+    double tolerance = qMax(max.x - min.x, max.y - min.y) * 1e-6 + EPS_ZERO;
+    for (int i = 0; i < m_boundingBoxes.count(); i++)
+    {
+        m_boundingBoxes[i].start = m_boundingBoxes[i].start - Point(tolerance, tolerance);
+        m_boundingBoxes[i].end = m_boundingBoxes[i].end + Point(tolerance, tolerance);
+    }
+    m_boundingBox = RectPoint(min - Point(tolerance, tolerance), max + Point(tolerance, tolerance));
+
+    // approximately one edge per cell
+    m_size = qBound(1, (int) ceil(sqrt((double) m_edges.count())), 64);
+    m_cellWidth = m_boundingBox.width() / m_size;
+    m_cellHeight = m_boundingBox.height() / m_size;
+
+    m_cells.resize(m_size * m_size);
+    for (int i = 0; i < m_boundingBoxes.count(); i++)
+    {
+        for (int y = cellY(m_boundingBoxes[i].start.y); y <= cellY(m_boundingBoxes[i].end.y); y++)
+            for (int x = cellX(m_boundingBoxes[i].start.x); x <= cellX(m_boundingBoxes[i].end.x); x++)
+                m_cells[y * m_size + x].append(i);
+    }
+}
+
+QList<SceneEdge *> EdgeHash::edges(const Point &start, const Point &end) const
+{
+    QList<SceneEdge *> out;
+
+    RectPoint segment(Point(qMin(start.x, end.x), qMin(start.y, end.y)),
+                      Point(qMax(start.x, end.x), qMax(start.y, end.y)));
+
+    if (!overlaps(segment, m_boundingBox))
+        return out;
+
+    QVarLengthArray<int, 64> candidates;
+    for (int y = cellY(segment.start.y); y <= cellY(segment.end.y); y++)
+        for (int x = cellX(segment.start.x); x <= cellX(segment.end.x); x++)
+            foreach (int i, m_cells[y * m_size + x])
+                if (overlaps(segment, m_boundingBoxes[i]))
+                    candidates.append(i);
+
+    // edge spanning more cells is found repeatedly
+    qSort(candidates.begin(), candidates.end());
+    for (int i = 0; i < candidates.size(); i++)
+        if (i == 0 || candidates[i] != candidates[i - 1])
+            out.append(m_edges[candidates[i]]);
+
+    return out;
+}
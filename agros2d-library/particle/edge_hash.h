@@ -0,0 +1,61 @@
+// This file is part of Agros2D.
+//
+// Agros2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Agros2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Agros2D.  If not, see <http://www.gnu.org/licenses/>.
+//
+// hp-FEM group (http://hpfem.org/)
+// University of Nevada, Reno (UNR) and University of West Bohemia, Pilsen
+// Email: agros2d@googlegroups.com, home page: http://hpfem.org/agros2d/
+
+#ifndef EDGEHASH_H
+#define EDGEHASH_H
+
+#include "util.h"
+#include "util/point.h"
+
+class SceneEdge;
+
+// uniform grid of the edge bounding boxes, arcs are bounded by the whole circle
+// structure is immutable after construction, queries are thread-safe
+class EdgeHash
+{
+public:
+    EdgeHash(const QList<SceneEdge *> &edges);
+
+    // edges whose bounding box overlaps the bounding box of the segment, in the order of the input list
+    // edges intersected by the segment are always included
+    QList<SceneEdge *> edges(const Point &start, const Point &end) const;
+
+private:
+    QList<SceneEdge *> m_edges;
+    QVector<RectPoint> m_boundingBoxes;
+
+    RectPoint m_boundingBox;
+    int m_size;
+    double m_cellWidth;
+    double m_cellHeight;
+
+    // indices of the edges in cells (row major)
+    QVector<QVector<int> > m_cells;
+
+    inline int cellX(double x) const { return qBound(0, (int) ((x - m_boundingBox.start.x) / m_cellWidth), m_size - 1); }
+    inline int cellY(double y) const { return qBound(0, (int) ((y - m_boundingBox.start.y) / m_cellHeight), m_size - 1); }
+
+    static inline bool overlaps(const RectPoint &rect1, const RectPoint &rect2)
+    {
+        return (rect1.start.x <= rect2.end.x) && (rect1.end.x >= rect2.start.x)
+                && (rect1.start.y <= rect2.end.y) && (rect1.end.y >= rect2.start.y);
+    }
+};
+
+#endif // EDGEHASH_H
@@ -1,106 +1,59 @@
 #include "mesh_hash.h"
 #include "hermes2d.h"
 
-MeshHashElement::MeshHashElement(Point p1, Point p2, int depth) : m_p1(p1), m_p2(p2), m_depth(depth)
+// cache of the hashes, mesh is identified by the pointer (kept alive by the cache) and its sequence number
+struct MeshHashCacheItem
 {
-    for(int i = 0; i < 2; i++)
-        for(int j = 0; j < 2; j++)
-            m_sons[i][j] = NULL;
-    m_active = true;
-}
+    Hermes::Hermes2D::MeshSharedPtr mesh;
+    int seq;
+    int numActiveElements;
+    QSharedPointer<MeshHash> meshHash;
+};
 
-MeshHashElement::~MeshHashElement()
-{
-    for(int i = 0; i < 2; i++)
-        for(int j = 0; j < 2; j++)
-            if(m_sons[i][j])
-                delete m_sons[i][j];
+static const int MESH_HASH_CACHE_SIZE = 4;
+static QMutex meshHashCacheMutex;
+static QList<MeshHashCacheItem> meshHashCache;
 
-}
-
-bool MeshHashElement::belongs(Hermes::Hermes2D::Element *element)
+QSharedPointer<MeshHash> MeshHash::meshHash(const Hermes::Hermes2D::MeshSharedPtr mesh)
 {
-    Point p1, p2;
-    MeshHash::elementBoundingBox(element, p1, p2);
-    return ((p1.x <= m_p2.x) && (p2.x >= m_p1.x) && (p1.y <= m_p2.y) && (p2.y >= m_p1.y));
-}
+    QMutexLocker locker(&meshHashCacheMutex);
 
-void MeshHashElement::insert(Hermes::Hermes2D::Element *element)
-{
-    if(m_active)
+    for (int i = 0; i < meshHashCache.size(); i++)
     {
-        if(! m_elements.contains(element))
-            m_elements.push_back(element);
-
-        if((m_elements.size() > MAX_ELEMENTS) && (m_depth < MAX_DEPTH))
+        const MeshHashCacheItem &item = meshHashCache.at(i);
+        if (item.mesh.get() == mesh.get())
         {
-            m_active = false;
-            double xx[3] = {m_p1.x, (m_p1.x + m_p2.x) / 2., m_p2.x};
-            double yy[3] = {m_p1.y, (m_p1.y + m_p2.y) / 2., m_p2.y};
-            for(int i = 0; i < 2; i++)
+            if ((item.seq == mesh->get_seq()) && (item.numActiveElements == mesh->get_num_active_elements()))
             {
-                double x0 = xx[i];
-                double x1 = xx[i+1];
-                for(int j = 0; j < 2; j++)
-                {
-                    double y0 = yy[j];
-                    double y1 = yy[j+1];
-
-                    assert(m_sons[i][j] == NULL);
-                    m_sons[i][j] = new MeshHashElement(Point(x0,y0), Point(x1,y1), m_depth + 1);
-
-                    for(int elem = 0; elem < m_elements.size(); elem++)
-                    {
-                        if(m_sons[i][j]->belongs(m_elements[elem]))
-                            m_sons[i][j]->insert(m_elements[elem]);
-                    }
-                }
+                // most recently used first
+                meshHashCache.move(i, 0);
+                return meshHashCache.first().meshHash;
             }
 
-            m_elements.clear();
-        }
-    }
-    else
-    {
-        for(int i = 0; i < 2; i++)
-        {
-            for(int j = 0; j < 2; j++)
-            {
-                assert(m_sons[i][j]);
-                if(m_sons[i][j]->belongs(element))
-                    m_sons[i][j]->insert(element);
-            }
+            // mesh has been changed
+            meshHashCache.removeAt(i);
+            break;
         }
     }
 
+    MeshHashCacheItem item;
+    item.mesh = mesh;
+    item.seq = mesh->get_seq();
+    item.numActiveElements = mesh->get_num_active_elements();
+    item.meshHash = QSharedPointer<MeshHash>(new MeshHash(mesh));
+
+    meshHashCache.prepend(item);
+    while (meshHashCache.size() > MESH_HASH_CACHE_SIZE)
+        meshHashCache.removeLast();
+
+    return item.meshHash;
 }
 
-Hermes::Hermes2D::Element* MeshHashElement::getElement(double x, double y)
+void MeshHash::clearCache()
 {
-    if(m_active)
-    {
-        double x_ref, y_ref;
-        foreach(Hermes::Hermes2D::Element* element, m_elements)
-        {
-            if(Hermes::Hermes2D::RefMap::is_element_on_physical_coordinates(element, x, y, &x_ref, &y_ref))
-                return element;
-        }
-        return NULL;
-    }
-    else
-    {
-        Hermes::Hermes2D::Element* element;
-        for(int i = 0; i < 2; i++)
-        {
-            for(int j = 0; j < 2; j++)
-            {
-                element = m_sons[i][j]->getElement(x,y);
-                if(element)
-                    return element;
-            }
-        }
-        return NULL;
-    }
+    QMutexLocker locker(&meshHashCacheMutex);
+
+    meshHashCache.clear();
 }
 
 void MeshHash::elementBoundingBox(Hermes::Hermes2D::Element *element, Point &p1, Point &p2)
@@ -131,120 +84,162 @@ void MeshHash::elementBoundingBox(Hermes::Hermes2D::Element *element, Point &p1,
     }
 }
 
-
-
 MeshHash::MeshHash(const Hermes::Hermes2D::MeshSharedPtr mesh)
 {
-    // find bounding box of the whole mesh
-    Point mesh_p1, mesh_p2;
-    bool first = true;
-    Hermes::Hermes2D::Node* n;
-    for_all_vertex_nodes(n, mesh)
+    // active elements and bounding box of the whole mesh
+    Point mesh_p1( numeric_limits<double>::max(),  numeric_limits<double>::max());
+    Point mesh_p2(-numeric_limits<double>::max(), -numeric_limits<double>::max());
+
+    Hermes::Hermes2D::Element *element;
+    Point p1, p2;
+    for_all_active_elements(element, mesh)
     {
-        if(first)
-        {
-            mesh_p1.x = mesh_p2.x = n->x;
-            mesh_p1.y = mesh_p2.y = n->y;
-            first = false;
-        }
-        else
-        {
-            if(n->x > mesh_p2.x)
-                mesh_p2.x = n->x;
-            if(n->x < mesh_p1.x)
-                mesh_p1.x = n->x;
-            if(n->y > mesh_p2.y)
-                mesh_p2.y = n->y;
-            if(n->y < mesh_p1.y)
-                mesh_p1.y = n->y;
-        }
-    }
+        elementBoundingBox(element, p1, p2);
 
-    // create grid
-    double interval_len_x = (mesh_p2.x - mesh_p1.x) / GRID_SIZE;
-    double interval_len_y = (mesh_p2.y - mesh_p1.y) / GRID_SIZE;
+        m_elements.append(element);
+        m_boundingBoxes.append(p1.x);
+        m_boundingBoxes.append(p1.y);
+        m_boundingBoxes.append(p2.x);
+        m_boundingBoxes.append(p2.y);
 
-    intervals_x[0] = mesh_p1.x;
-    intervals_y[0] = mesh_p1.y;
+        mesh_p1.x = qMin(mesh_p1.x, p1.x);
+        mesh_p1.y = qMin(mesh_p1.y, p1.y);
+        mesh_p2.x = qMax(mesh_p2.x, p2.x);
+        mesh_p2.y = qMax(mesh_p2.y, p2.y);
+    }
 
-    for(int i = 1; i < GRID_SIZE; i++)
+    if (m_elements.isEmpty())
     {
-        intervals_x[i] = intervals_x[i-1] + interval_len_x;
-        intervals_y[i] = intervals_y[i-1] + interval_len_y;
+        mesh_p1 = Point();
+        mesh_p2 = Point();
     }
 
-    intervals_x[GRID_SIZE] = mesh_p2.x;
-    intervals_y[GRID_SIZE] = mesh_p2.y;
-
-    for(int i = 0; i < GRID_SIZE; i++)
+    // approximately two elements per cell, cells follow the aspect ratio of the mesh
+    double width = qMax(mesh_p2.x - mesh_p1.x, EPS_ZERO);
+    double height = qMax(mesh_p2.y - mesh_p1.y, EPS_ZERO);
+    double cells = qMax(1.0, m_elements.count() / 2.0);
+
+    m_sizeX = qBound(1, (int) ceil(sqrt(cells * width / height)), 2048);
+    m_sizeY = qBound(1, (int) ceil(cells / m_sizeX), 2048);
+    m_start = mesh_p1;
+    m_end = mesh_p2;
+    m_cellWidth = width / m_sizeX;
+    m_cellHeight = height / m_sizeY;
+    m_tolerance = EPS_ZERO * qMax(width, height);
+
+    // two passes: count elements in the cells, then fill them
+    QVector<int> count(m_sizeX * m_sizeY + 1, 0);
+    for (int e = 0; e < m_elements.count(); e++)
     {
-        for(int j = 0; j < GRID_SIZE; j++)
-        {
-            m_grid[i][j] = new MeshHashElement(Point(intervals_x[i], intervals_y[j]), Point(intervals_x[i+1], intervals_y[j+1]));
-        }
+        const double *box = m_boundingBoxes.constData() + 4*e;
+        for (int j = cellY(box[1]); j <= cellY(box[3]); j++)
+            for (int i = cellX(box[0]); i <= cellX(box[2]); i++)
+                count[j * m_sizeX + i + 1]++;
     }
 
-    // assign elements
-    Hermes::Hermes2D::Element *element;
-    Point p1, p2;
-    int x_min, x_max, y_min, y_max;
-    for_all_active_elements(element, mesh)
+    m_cellStart.resize(m_sizeX * m_sizeY + 1);
+    m_cellStart[0] = 0;
+    for (int c = 1; c < count.size(); c++)
+        m_cellStart[c] = m_cellStart[c - 1] + count[c];
+
+    m_cellElements.resize(m_cellStart.last());
+    QVector<int> position = m_cellStart;
+    for (int e = 0; e < m_elements.count(); e++)
     {
-        elementBoundingBox(element, p1, p2);
-        x_min = 0;
-        while(intervals_x[x_min + 1] < p1.x)
-            x_min++;
+        const double *box = m_boundingBoxes.constData() + 4*e;
+        for (int j = cellY(box[1]); j <= cellY(box[3]); j++)
+            for (int i = cellX(box[0]); i <= cellX(box[2]); i++)
+                m_cellElements[position[j * m_sizeX + i]++] = e;
+    }
+}
 
-        x_max = GRID_SIZE - 1;
-        while(intervals_x[x_max] > p2.x)
-            x_max--;
+MeshHash::~MeshHash()
+{
+}
 
-        y_min = 0;
-        while(intervals_y[y_min + 1] < p1.y)
-            y_min++;
+Hermes::Hermes2D::Element* MeshHash::walk(double x, double y, Hermes::Hermes2D::Element *element) const
+{
+    double x_ref, y_ref;
 
-        y_max = GRID_SIZE - 1;
-        while(intervals_y[y_max] > p2.y)
-            y_max--;
+    for (int step = 0; step < MAX_WALK_STEPS; step++)
+    {
+        if (!element || !element->active)
+            return NULL;
 
-        assert((x_max >= x_min) && (y_max >= y_min));
+        // orientation of the vertices
+        int nvert = element->get_nvert();
+        double area = 0.0;
+        for (int i = 0; i < nvert; i++)
+        {
+            int j = (i + 1) % nvert;
+            area += element->vn[i]->x * element->vn[j]->y - element->vn[j]->x * element->vn[i]->y;
+        }
 
-        for(int i = x_min; i <= x_max; i++)
+        // edge with the point on the outer side (straight edges are assumed)
+        int outerEdge = -1;
+        double outerDistance = 0.0;
+        for (int i = 0; i < nvert; i++)
         {
-            for(int j = y_min; j <= y_max; j++)
+            int j = (i + 1) % nvert;
+            double cross = (element->vn[j]->x - element->vn[i]->x) * (y - element->vn[i]->y)
+                    - (element->vn[j]->y - element->vn[i]->y) * (x - element->vn[i]->x);
+            if (area < 0.0)
+                cross = -cross;
+
+            if (cross < outerDistance)
             {
-                assert(m_grid[i][j]->belongs(element));
-                m_grid[i][j]->insert(element);
+                outerDistance = cross;
+                outerEdge = i;
             }
         }
-    }
-}
 
-MeshHash::~MeshHash()
-{
-    for(int i = 0; i < GRID_SIZE; i++)
-    {
-        for(int j = 0; j < GRID_SIZE; j++)
+        if (outerEdge == -1)
         {
-            delete m_grid[i][j];
+            // curved element or point on the edge, exact test decides
+            if (Hermes::Hermes2D::RefMap::is_element_on_physical_coordinates(element, x, y, &x_ref, &y_ref))
+                return element;
+            else
+                return NULL;
         }
+
+        // neighbour across the edge (NULL on the boundary or across irregular edge)
+        element = element->get_neighbor(outerEdge);
     }
 
+    return NULL;
 }
 
-Hermes::Hermes2D::Element* MeshHash::getElement(double x, double y)
+Hermes::Hermes2D::Element* MeshHash::getElement(double x, double y, Hermes::Hermes2D::Element *start) const
 {
-    int i = 0;
-    while((i < GRID_SIZE) && (intervals_x[i+1] < x))
-        i++;
+    if (start)
+    {
+        double x_ref, y_ref;
+        if (Hermes::Hermes2D::RefMap::is_element_on_physical_coordinates(start, x, y, &x_ref, &y_ref))
+            return start;
 
-    int j = 0;
-    while((j < GRID_SIZE) && (intervals_y[j+1] < y))
-        j++;
+        // neighbouring points are usually found in a few steps
+        Hermes::Hermes2D::Element *element = walk(x, y, start);
+        if (element)
+            return element;
+    }
 
-    // this means that x or y is outside mesh, but it can hapen
-    if((i >= GRID_SIZE) || (j >= GRID_SIZE))
+    // outside of the mesh (or not a number)
+    if (!((x >= m_start.x - m_tolerance) && (x <= m_end.x + m_tolerance) &&
+          (y >= m_start.y - m_tolerance) && (y <= m_end.y + m_tolerance)))
         return NULL;
-    else
-        return m_grid[i][j]->getElement(x,y);
+
+    int cell = cellY(y) * m_sizeX + cellX(x);
+    double x_ref, y_ref;
+    for (int k = m_cellStart[cell]; k < m_cellStart[cell + 1]; k++)
+    {
+        int e = m_cellElements[k];
+        const double *box = m_boundingBoxes.constData() + 4*e;
+
+        if ((x >= box[0] - m_tolerance) && (x <= box[2] + m_tolerance) &&
+                (y >= box[1] - m_tolerance) && (y <= box[3] + m_tolerance) &&
+                Hermes::Hermes2D::RefMap::is_element_on_physical_coordinates(m_elements[e], x, y, &x_ref, &y_ref))
+            return m_elements[e];
+    }
+
+    return NULL;
 }
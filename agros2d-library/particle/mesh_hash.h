@@ -3,6 +3,7 @@
 
 #include "util.h"
 #include "util/global.h"
+#include "hermes2d.h"
 
 namespace Hermes
 {
@@ -12,31 +13,10 @@ class Element;
 }
 }
 
-class MeshHashElement
-{
-public:
-    MeshHashElement(Point p1, Point p2, int depth = 0);
-    ~MeshHashElement();
-    inline bool belongs(Point p) { return (p.x >= m_p1.x) && (p.x <= m_p2.x) && (p.y <= m_p1.y) && (p.y >= m_p2.y); }
-    bool belongs(Hermes::Hermes2D::Element* element);
-    void insert(Hermes::Hermes2D::Element* element);
-
-    Hermes::Hermes2D::Element* getElement(double x, double y);
-
-private:
-    Point m_p1, m_p2;
-    QList<Hermes::Hermes2D::Element*> m_elements;
-    MeshHashElement* m_sons[2][2];
-    int m_depth;
-
-    static const int MAX_ELEMENTS = 50;
-    static const int MAX_DEPTH = 10;
-    bool m_active;
-};
-
-#define GRID_SIZE  30
-
-class MeshHash
+// point location in the active elements of the mesh
+// flat grid of element indices (cells stored consecutively), size of the grid is derived from the number of elements
+// structure is immutable after construction, queries are thread-safe
+class AGROS_LIBRARY_API MeshHash
 {
 public:
     MeshHash(const Hermes::Hermes2D::MeshSharedPtr mesh);
@@ -46,14 +26,39 @@ public:
     // if we knew more about the shape of curvilinear element, this increase could be smaller
     static void elementBoundingBox(Hermes::Hermes2D::Element* element, Point& p1, Point& p2);
 
-    Hermes::Hermes2D::Element* getElement(double x, double y);
+    // returns NULL if the point is outside the mesh
+    // search starts by walking from the given element (typically the element of the previous point)
+    Hermes::Hermes2D::Element* getElement(double x, double y, Hermes::Hermes2D::Element *start = NULL) const;
+
+    // hash shared by the subsequent queries on the same mesh (last few meshes are kept alive by the cache)
+    static QSharedPointer<MeshHash> meshHash(const Hermes::Hermes2D::MeshSharedPtr mesh);
+    static void clearCache();
 
 private:
-    MeshHashElement* m_grid[GRID_SIZE][GRID_SIZE];
+    int m_sizeX;
+    int m_sizeY;
+    Point m_start;
+    double m_cellWidth;
+    double m_cellHeight;
 
-    double intervals_x[GRID_SIZE + 1];
-    double intervals_y[GRID_SIZE + 1];
-};
+    // bounding box of the mesh, points on the boundary are accepted within the tolerance
+    Point m_end;
+    double m_tolerance;
+
+    // elements of cell i are m_cellElements[m_cellStart[i]] ... m_cellElements[m_cellStart[i + 1] - 1]
+    QVector<int> m_cellStart;
+    QVector<int> m_cellElements;
+
+    // active elements and their bounding boxes (x1, y1, x2, y2)
+    QVector<Hermes::Hermes2D::Element *> m_elements;
+    QVector<double> m_boundingBoxes;
 
+    static const int MAX_WALK_STEPS = 8;
+
+    Hermes::Hermes2D::Element* walk(double x, double y, Hermes::Hermes2D::Element *element) const;
+
+    inline int cellX(double x) const { return qBound(0, (int) ((x - m_start.x) / m_cellWidth), m_sizeX - 1); }
+    inline int cellY(double y) const { return qBound(0, (int) ((y - m_start.y) / m_cellHeight), m_sizeY - 1); }
+};
 
 #endif // MESHHASH_H
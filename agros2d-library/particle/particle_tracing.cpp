@@ -40,29 +40,265 @@
 #include "hermes2d/solutionstore.h"
 #include "hermes2d/problem_config.h"
 
-ParticleTracing::ParticleTracing(QObject *parent)
-    : QObject(parent)
+#include "particle/mesh_hash.h"
+#include "particle/edge_hash.h"
+
+class ParticleTracingThread : public QThread
+{
+public:
+    ParticleTracingThread(ParticleTracing *particleTracing,
+                          const QList<Point3> &initialPositions, const QList<Point3> &initialVelocities,
+                          int first, int increment)
+        : QThread(), m_particleTracing(particleTracing),
+          m_initialPositions(initialPositions), m_initialVelocities(initialVelocities),
+          m_first(first), m_increment(increment), m_failedParticle(-1) {}
+
+    inline QList<int> particles() const { return m_particles; }
+    inline QList<QList<Point3> > positions() const { return m_positions; }
+    inline QList<QList<Point3> > velocities() const { return m_velocities; }
+    inline QList<QList<double> > times() const { return m_times; }
+
+    inline int failedParticle() const { return m_failedParticle; }
+    inline std::exception_ptr exception() const { return m_exception; }
+
+protected:
+    virtual void run()
+    {
+        // static assignment of the particles, results do not depend on the scheduling
+        for (int k = m_first; k < m_initialPositions.count(); k += m_increment)
+        {
+            try
+            {
+                m_particleTracing->computeTrajectoryParticle(m_initialPositions[k], m_initialVelocities[k]);
+            }
+            catch (...)
+            {
+                m_failedParticle = k;
+                m_exception = std::current_exception();
+
+                return;
+            }
+
+            m_particles.append(k);
+            m_positions.append(m_particleTracing->positions());
+            m_velocities.append(m_particleTracing->velocities());
+            m_times.append(m_particleTracing->times());
+        }
+    }
+
+private:
+    ParticleTracing *m_particleTracing;
+
+    QList<Point3> m_initialPositions;
+    QList<Point3> m_initialVelocities;
+    int m_first;
+    int m_increment;
+
+    QList<int> m_particles;
+    QList<QList<Point3> > m_positions;
+    QList<QList<Point3> > m_velocities;
+    QList<QList<double> > m_times;
+
+    int m_failedParticle;
+    std::exception_ptr m_exception;
+};
+
+ParticleTracingSettings::ParticleTracingSettings(ProblemSetting *setting, CoordinateType coordinateType, const RectPoint &boundingBox,
+                                                 const QList<SceneEdge *> &edges)
+    : coordinateType(coordinateType), boundingBox(boundingBox)
+{
+    mass = setting->value(ProblemSetting::View_ParticleMass).toDouble();
+    constant = setting->value(ProblemSetting::View_ParticleConstant).toDouble();
+    includeRelativisticCorrection = setting->value(ProblemSetting::View_ParticleIncludeRelativisticCorrection).toBool();
+
+    dragDensity = setting->value(ProblemSetting::View_ParticleDragDensity).toDouble();
+    dragCoefficient = setting->value(ProblemSetting::View_ParticleDragCoefficient).toDouble();
+    dragReferenceArea = setting->value(ProblemSetting::View_ParticleDragReferenceArea).toDouble();
+    customForce = Point3(setting->value(ProblemSetting::View_ParticleCustomForceX).toDouble(),
+                         setting->value(ProblemSetting::View_ParticleCustomForceY).toDouble(),
+                         setting->value(ProblemSetting::View_ParticleCustomForceZ).toDouble());
+
+    coefficientOfRestitution = setting->value(ProblemSetting::View_ParticleCoefficientOfRestitution).toDouble();
+    reflectOnDifferentMaterial = setting->value(ProblemSetting::View_ParticleReflectOnDifferentMaterial).toBool();
+    reflectOnBoundary = setting->value(ProblemSetting::View_ParticleReflectOnBoundary).toBool();
+
+    foreach (SceneEdge *edge, edges)
+    {
+        foreach (FieldInfo* fieldInfo, Agros2D::problem()->fieldInfos())
+        {
+            bool isBoundary = !edge->marker(fieldInfo)->isNone();
+
+            if ((coefficientOfRestitution < EPS_ZERO) || // no reflection
+                    (!isBoundary && !reflectOnDifferentMaterial) || // inner edge
+                    (isBoundary && !reflectOnBoundary)) // boundary
+                impactEdges.insert(edge);
+        }
+    }
+
+    butcherTableType = setting->value(ProblemSetting::View_ParticleButcherTableType).toInt();
+    maximumNumberOfSteps = setting->value(ProblemSetting::View_ParticleMaximumNumberOfSteps).toInt();
+
+    // default values are derived from the geometry
+    minimumStep = (setting->value(ProblemSetting::View_ParticleMinimumStep).toDouble() > 0.0)
+            ? setting->value(ProblemSetting::View_ParticleMinimumStep).toDouble() :
+              min(boundingBox.width(), boundingBox.height()) / 80.0;
+    maximumRelativeError = (setting->value(ProblemSetting::View_ParticleMaximumRelativeError).toDouble() > 0.0)
+            ? setting->value(ProblemSetting::View_ParticleMaximumRelativeError).toDouble() / 100 : 1e-6;
+}
+
+ParticleTracing::ParticleTracing(const ParticleTracingSettings &settings, const EdgeHash *edgeHash, QObject *parent)
+    : QObject(parent), m_settings(settings), m_edgeHash(edgeHash)
 {
     foreach (FieldInfo* fieldInfo, Agros2D::problem()->fieldInfos())
     {
         if(!fieldInfo->plugin()->hasForce(fieldInfo))
             continue;
 
+        m_fieldInfos.append(fieldInfo);
+
         // use solution on nearest time step, last adaptivity step possible and if exists, reference solution
         int timeStep = Agros2D::solutionStore()->lastTimeStep(fieldInfo, SolutionMode_Normal);
         int adaptivityStep = Agros2D::solutionStore()->lastAdaptiveStep(fieldInfo, SolutionMode_Normal, timeStep);
         SolutionMode solutionMode = SolutionMode_Finer;
 
         FieldSolutionID fsid(fieldInfo, timeStep, adaptivityStep, solutionMode);
-        Hermes::Hermes2D::MeshFunctionSharedPtr<double> sln = Agros2D::solutionStore()->multiArray(fsid).solutions().at(0);
+        MultiArray<double> ma = Agros2D::solutionStore()->multiArray(fsid);
+
+        // own copies of the solutions, evaluation of the point values is not thread-safe
+        Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > solutions;
+        for (int k = 0; k < ma.solutions().size(); k++)
+            solutions.push_back(Hermes::Hermes2D::MeshFunctionSharedPtr<double>(ma.solutions().at(k)->clone()));
 
-        m_solutionIDs[fieldInfo] = FieldSolutionID(fieldInfo, timeStep, adaptivityStep, solutionMode);
-        m_meshes[fieldInfo] = sln->get_mesh();
+        m_solutionIDs[fieldInfo] = fsid;
+        m_solutions[fieldInfo] = solutions;
+        m_meshHashes[fieldInfo] = new MeshHash(solutions.at(0)->get_mesh());
+
+        // materials of the Hermes element markers, labels without material are not meshed
+        QVector<SceneMaterial *> materials(Agros2D::scene()->labels->count() + 1, NULL);
+        for (int marker = 0; marker < materials.count(); marker++)
+        {
+            int label = fieldInfo->hermesMarkerToAgrosLabel(marker);
+            if (label >= 0)
+                materials[marker] = Agros2D::scene()->labels->at(label)->marker(fieldInfo);
+        }
+        m_materials[fieldInfo] = materials;
+
+        // time functions are global, they are not updated during the force evaluation
+        if (fieldInfo->analysisType() == AnalysisType_Transient)
+        {
+            QList<double> timeLevels = Agros2D::solutionStore()->timeLevels(fieldInfo);
+            Module::updateTimeFunctions(timeLevels[timeStep]);
+        }
     }
 }
 
 ParticleTracing::~ParticleTracing()
 {
+    foreach (MeshHash *meshHash, m_meshHashes)
+        delete meshHash;
+}
+
+void ParticleTracing::initialConditions(int numberOfParticles, QList<Point3> &initialPositions, QList<Point3> &initialVelocities)
+{
+    initialPositions.clear();
+    initialVelocities.clear();
+
+    for (int k = 0; k < numberOfParticles; k++)
+    {
+        // initial position
+        Point3 initialPosition;
+        initialPosition.x = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartX).toDouble();
+        initialPosition.y = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartY).toDouble();
+        initialPosition.z = 0.0;
+
+        // initial velocity
+        Point3 initialVelocity;
+        initialVelocity.x = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartVelocityX).toDouble();
+        initialVelocity.y = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartVelocityY).toDouble();
+        initialVelocity.z = 0.0;
+
+        // random point (generated sequentially, sequence does not depend on the threads)
+        if (k > 0)
+        {
+            Point3 dp(rand() * (Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble()) / RAND_MAX,
+                      rand() * (Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble()) / RAND_MAX,
+                      (Agros2D::problem()->config()->coordinateType() == CoordinateType_Planar) ? 0.0 : rand() * 2.0*M_PI / RAND_MAX);
+
+            initialPosition = Point3(-Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble() / 2,
+                                     -Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble() / 2,
+                                     (Agros2D::problem()->config()->coordinateType() == CoordinateType_Planar) ? 0.0 : -1.0*M_PI) + initialPosition + dp;
+        }
+
+        initialPositions.append(initialPosition);
+        initialVelocities.append(initialVelocity);
+    }
+}
+
+void ParticleTracing::computeTrajectoryParticles(const QList<Point3> &initialPositions, const QList<Point3> &initialVelocities,
+                                                 QList<QList<Point3> > &positions, QList<QList<Point3> > &velocities, QList<QList<double> > &times)
+{
+    assert(initialPositions.count() == initialVelocities.count());
+
+    positions.clear();
+    velocities.clear();
+    times.clear();
+
+    int numberOfThreads = qMax(1, qMin(initialPositions.count(), Agros2D::configComputer()->numberOfThreads));
+
+    // settings, edge hash, solutions and mesh locators are prepared in the calling thread
+    ParticleTracingSettings settings(Agros2D::problem()->setting(),
+                                     Agros2D::problem()->config()->coordinateType(),
+                                     Agros2D::scene()->boundingBox(),
+                                     Agros2D::scene()->edges->items());
+    EdgeHash edgeHash(Agros2D::scene()->edges->items());
+
+    // owned by the lists (released also when the constructor throws), threads are released first
+    QList<QSharedPointer<ParticleTracing> > particleTracings;
+    QList<QSharedPointer<ParticleTracingThread> > threads;
+    for (int i = 0; i < numberOfThreads; i++)
+    {
+        QSharedPointer<ParticleTracing> particleTracing(new ParticleTracing(settings, &edgeHash));
+        particleTracings.append(particleTracing);
+        threads.append(QSharedPointer<ParticleTracingThread>(new ParticleTracingThread(particleTracing.data(), initialPositions, initialVelocities, i, numberOfThreads)));
+    }
+
+    foreach (QSharedPointer<ParticleTracingThread> thread, threads)
+        thread->start();
+
+    QVector<QList<Point3> > positionsOrdered(initialPositions.count());
+    QVector<QList<Point3> > velocitiesOrdered(initialPositions.count());
+    QVector<QList<double> > timesOrdered(initialPositions.count());
+
+    // exception of the first failed particle is reported
+    int failedParticle = initialPositions.count();
+    std::exception_ptr exception;
+    foreach (QSharedPointer<ParticleTracingThread> thread, threads)
+    {
+        thread->wait();
+
+        if (thread->exception() && thread->failedParticle() < failedParticle)
+        {
+            failedParticle = thread->failedParticle();
+            exception = thread->exception();
+        }
+
+        for (int i = 0; i < thread->particles().count(); i++)
+        {
+            positionsOrdered[thread->particles().at(i)] = thread->positions().at(i);
+            velocitiesOrdered[thread->particles().at(i)] = thread->velocities().at(i);
+            timesOrdered[thread->particles().at(i)] = thread->times().at(i);
+        }
+    }
+
+    threads.clear();
+    particleTracings.clear();
+
+    if (exception)
+        std::rethrow_exception(exception);
+
+    positions = positionsOrdered.toList();
+    velocities = velocitiesOrdered.toList();
+    times = timesOrdered.toList();
 }
 
 void ParticleTracing::clear()
@@ -80,47 +316,27 @@ Point3 ParticleTracing::force(Point3 position,
                               Point3 velocity)
 {
     Point3 totalFieldForce;
-    foreach (FieldInfo* fieldInfo, Agros2D::problem()->fieldInfos())
+    foreach (FieldInfo* fieldInfo, m_fieldInfos)
     {
-        if(!fieldInfo->plugin()->hasForce(fieldInfo))
-            continue;
-
         Point3 fieldForce;
 
-        bool elementIsValid = false;
-        Hermes::Hermes2D::Element *activeElement = NULL;
-
-        // active element for current field
-        if (m_activeElement.contains(fieldInfo))
-            activeElement = m_activeElement[fieldInfo];
-
-        if (activeElement)
-        {
-            double x_reference;
-            double y_reference;
-            elementIsValid = Hermes::Hermes2D::RefMap::is_element_on_physical_coordinates(activeElement,
-                                                                                          position.x, position.y, &x_reference, &y_reference);
-        }
-
-        if (!elementIsValid)
-        {
-            m_activeElement[fieldInfo] = Hermes::Hermes2D::RefMap::element_on_physical_coordinates(true, m_meshes[fieldInfo],
-                                                                                                   position.x, position.y);
-        }
+        // active element for current field, search starts from the element of the previous evaluation
+        Hermes::Hermes2D::Element *activeElement = m_meshHashes[fieldInfo]->getElement(position.x, position.y,
+                                                                                         m_activeElement.value(fieldInfo, NULL));
+        m_activeElement[fieldInfo] = activeElement;
 
         if (activeElement)
         {
             // find material
-            SceneLabel *label = Agros2D::scene()->labels->at(atoi(fieldInfo->initialMesh()->get_element_markers_conversion().get_user_marker(activeElement->marker).marker.c_str()));
-            SceneMaterial* material = label->marker(fieldInfo);
+            SceneMaterial* material = m_materials[fieldInfo].at(activeElement->marker);
 
-            assert(!material->isNone());
+            assert(material && !material->isNone());
 
             try
             {
-                fieldForce = fieldInfo->plugin()->force(fieldInfo, m_solutionIDs[fieldInfo].timeStep, m_solutionIDs[fieldInfo].adaptivityStep, m_solutionIDs[fieldInfo].solutionMode,
+                fieldForce = fieldInfo->plugin()->force(fieldInfo, m_solutionIDs[fieldInfo].timeStep, m_solutions[fieldInfo],
                                                         activeElement, material, position, velocity)
-                        * Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleConstant).toDouble();
+                        * m_settings.constant;
             }
             catch (AgrosException e)
             {
@@ -131,20 +347,18 @@ Point3 ParticleTracing::force(Point3 position,
         totalFieldForce = totalFieldForce + fieldForce;
     }
     // custom force
-    Point3 forceCustom = Point3(Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleCustomForceX).toDouble(),
-                                Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleCustomForceY).toDouble(),
-                                Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleCustomForceZ).toDouble());
+    Point3 forceCustom = m_settings.customForce;
 
     // Drag force
-    Point3 velocityReal = (Agros2D::problem()->config()->coordinateType() == CoordinateType_Planar) ?
+    Point3 velocityReal = (m_settings.coordinateType == CoordinateType_Planar) ?
                 velocity : Point3(velocity.x, velocity.y, position.x * velocity.z);
     Point3 forceDrag;
     if (velocityReal.magnitude() > 0.0)
         forceDrag = velocityReal.normalizePoint() *
-                - 0.5 * Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleDragDensity).toDouble()
+                - 0.5 * m_settings.dragDensity
                 * velocityReal.magnitude() * velocityReal.magnitude()
-                * Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleDragCoefficient).toDouble()
-                * Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleDragReferenceArea).toDouble();
+                * m_settings.dragCoefficient
+                * m_settings.dragReferenceArea;
 
     // Total force
     Point3 totalForce = totalFieldForce + forceDrag + forceCustom;
@@ -159,8 +373,8 @@ bool ParticleTracing::newtonEquations(double step,
                                       Point3 *newvelocity)
 {
     // relativistic correction
-    double mass = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleMass).toDouble();
-    if (Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleIncludeRelativisticCorrection).toBool())
+    double mass = m_settings.mass;
+    if (m_settings.includeRelativisticCorrection)
     {
         if (velocity.magnitude() < SPEEDOFLIGHT)
             mass = mass / (sqrt(1.0 - (velocity.magnitude() * velocity.magnitude()) / (SPEEDOFLIGHT * SPEEDOFLIGHT)));
@@ -171,7 +385,7 @@ bool ParticleTracing::newtonEquations(double step,
     // Total acceleration
     Point3 totalAccel = force(position, velocity) / mass;
 
-    if (Agros2D::problem()->config()->coordinateType() == CoordinateType_Planar)
+    if (m_settings.coordinateType == CoordinateType_Planar)
     {
         // position
         *newposition = velocity * step;
@@ -195,7 +409,7 @@ bool ParticleTracing::newtonEquations(double step,
 
 void ParticleTracing::computeTrajectoryParticle(const Point3 initialPosition, const Point3 initialVelocity)
 {
-    Hermes::ButcherTable butcher((Hermes::ButcherTableType) Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleButcherTableType).toInt());
+    Hermes::ButcherTable butcher((Hermes::ButcherTableType) m_settings.butcherTableType);
     QVector<Point3> kp(butcher.get_size());
     QVector<Point3> kv(butcher.get_size());
 
@@ -213,20 +427,17 @@ void ParticleTracing::computeTrajectoryParticle(const Point3 initialPosition, co
     m_velocitiesList.append(velocity);
     m_timesList.append(0);
 
-    RectPoint bound = Agros2D::scene()->boundingBox();
+    RectPoint bound = m_settings.boundingBox;
 
-    double minStep = (Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleMinimumStep).toDouble() > 0.0)
-            ? Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleMinimumStep).toDouble() :
-              min(bound.width(), bound.height()) / 80.0;
-    double relErrorMin = (Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleMaximumRelativeError).toDouble() > 0.0)
-            ? Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleMaximumRelativeError).toDouble() / 100 : 1e-6;
+    double minStep = m_settings.minimumStep;
+    double relErrorMin = m_settings.maximumRelativeError;
     double relErrorMax = 1e-3;
     double dt = velocity.magnitude() > 0
             ? qMax(bound.width(), bound.height()) / velocity.magnitude() / 10 : 1e-11;
 
     bool stopComputation = false;
     int maxStepsGlobal = 0;
-    while (!stopComputation && (maxStepsGlobal < Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleMaximumNumberOfSteps).toInt() - 1))
+    while (!stopComputation && (maxStepsGlobal < m_settings.maximumNumberOfSteps - 1))
     {
         maxStepsGlobal++;
 
@@ -304,9 +515,9 @@ void ParticleTracing::computeTrajectoryParticle(const Point3 initialPosition, co
             break;
         }
 
-        // check crossing
+        // check crossing (only edges close to the step)
         QMap<SceneEdge *, Point> intersections;
-        foreach (SceneEdge *edge, Agros2D::scene()->edges->items())
+        foreach (SceneEdge *edge, m_edgeHash->edges(Point(position.x, position.y), Point(newPositionH.x, newPositionH.y)))
         {
             QList<Point> incts = intersection(Point(position.x, position.y), Point(newPositionH.x, newPositionH.y),
                                               Point(), 0.0, 0.0,
@@ -333,18 +544,7 @@ void ParticleTracing::computeTrajectoryParticle(const Point3 initialPosition, co
 
         if (crossingEdge && distance > EPS_ZERO)
         {
-            bool impact = false;
-            foreach (FieldInfo* fieldInfo, Agros2D::problem()->fieldInfos())
-            {
-                if ((Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleCoefficientOfRestitution).toDouble() < EPS_ZERO) || // no reflection
-                        (crossingEdge->marker(fieldInfo) == Agros2D::scene()->boundaries->getNone(fieldInfo)
-                         && !Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleReflectOnDifferentMaterial).toBool()) || // inner edge
-                        (crossingEdge->marker(fieldInfo) != Agros2D::scene()->boundaries->getNone(fieldInfo)
-                         && !Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleReflectOnBoundary).toBool())) // boundary
-                    impact = true;
-            }
-
-            if(impact)
+            if (m_settings.impactEdges.contains(crossingEdge))
             {
                 newPositionH.x = intersect.x;
                 newPositionH.y = intersect.y;
@@ -381,8 +581,8 @@ void ParticleTracing::computeTrajectoryParticle(const Point3 initialPosition, co
 
                 // velocity in the direction of output vector
                 Point3 oldv = newVelocityH;
-                newVelocityH.x = vectout.x * oldv.magnitude() * Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleCoefficientOfRestitution).toDouble();
-                newVelocityH.y = vectout.y * oldv.magnitude() * Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleCoefficientOfRestitution).toDouble();
+                newVelocityH.x = vectout.x * oldv.magnitude() * m_settings.coefficientOfRestitution;
+                newVelocityH.y = vectout.y * oldv.magnitude() * m_settings.coefficientOfRestitution;
 
                 // set new timestep
                 dt = dt * ratio;
@@ -399,7 +599,7 @@ void ParticleTracing::computeTrajectoryParticle(const Point3 initialPosition, co
         m_timesList.append(m_timesList.last() + dt);
         m_positionsList.append(position);
 
-        if (Agros2D::problem()->config()->coordinateType() == CoordinateType_Planar)
+        if (m_settings.coordinateType == CoordinateType_Planar)
             m_velocitiesList.append(velocity);
         else
             m_velocitiesList.append(Point3(velocity.x, velocity.y, position.x * velocity.z)); // v_phi = omega * r
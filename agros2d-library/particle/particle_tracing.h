@@ -30,19 +30,71 @@
 
 class FieldInfo;
 class SceneMaterial;
+class SceneEdge;
+class MeshHash;
+class EdgeHash;
+class ProblemSetting;
+
+// settings of the particle, forces and solver, converted once before the computation
+// integrator does not read the problem setting in the inner loop
+struct ParticleTracingSettings
+{
+    ParticleTracingSettings(ProblemSetting *setting, CoordinateType coordinateType, const RectPoint &boundingBox,
+                            const QList<SceneEdge *> &edges);
+
+    CoordinateType coordinateType;
+
+    // particle
+    double mass;
+    double constant;
+    bool includeRelativisticCorrection;
+
+    // forces
+    double dragDensity;
+    double dragCoefficient;
+    double dragReferenceArea;
+    Point3 customForce;
+
+    // reflection
+    double coefficientOfRestitution;
+    bool reflectOnDifferentMaterial;
+    bool reflectOnBoundary;
+    // edges stopping the particle, resolved from the boundaries of all fields
+    QSet<SceneEdge *> impactEdges;
+
+    // solver
+    int butcherTableType;
+    int maximumNumberOfSteps;
+    double minimumStep;
+    double maximumRelativeError;
+
+    // domain
+    RectPoint boundingBox;
+};
 
+// instance owns copies of the solutions and mesh locators, it can be used by one thread at a time
 class ParticleTracing : public QObject
 {
     Q_OBJECT
 
 public:
-    ParticleTracing(QObject *parent=0);
+    // edge hash is shared by the instances, it has to exist during the computation
+    ParticleTracing(const ParticleTracingSettings &settings, const EdgeHash *edgeHash, QObject *parent=0);
     ~ParticleTracing();
 
     void clear();
 
     void computeTrajectoryParticle(const Point3 initialPosition, const Point3 initialVelocity);
 
+    // initial conditions of the particles (setting of the problem), first particle starts in the given point
+    // other particles are dispersed randomly around it
+    static void initialConditions(int numberOfParticles, QList<Point3> &initialPositions, QList<Point3> &initialVelocities);
+
+    // trajectories of independent particles are computed concurrently, each thread has its own instance
+    // results are in the order of the initial conditions and do not depend on the number of threads
+    static void computeTrajectoryParticles(const QList<Point3> &initialPositions, const QList<Point3> &initialVelocities,
+                                           QList<QList<Point3> > &positions, QList<QList<Point3> > &velocities, QList<QList<double> > &times);
+
     inline QList<Point3> positions() const { return m_positionsList; }
     inline QList<Point3> velocities() const { return m_velocitiesList; }
     inline QList<double> times() const { return m_timesList; }
@@ -51,6 +103,9 @@ public:
     inline double velocityMax() const { return m_velocityMax; }
 
 private:
+    ParticleTracingSettings m_settings;
+    const EdgeHash *m_edgeHash;
+
     QList<Point3> m_positionsList;
     QList<Point3> m_velocitiesList;
     QList<double> m_timesList;
@@ -58,8 +113,13 @@ private:
     double m_velocityMin;
     double m_velocityMax;
 
+    // fields with force, in the order of the problem
+    QList<FieldInfo *> m_fieldInfos;
     QMap<FieldInfo *, FieldSolutionID> m_solutionIDs;
-    QMap<FieldInfo *, Hermes::Hermes2D::MeshSharedPtr> m_meshes;
+    QMap<FieldInfo *, Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > > m_solutions;
+    QMap<FieldInfo *, MeshHash *> m_meshHashes;
+    // materials indexed by the Hermes element marker
+    QMap<FieldInfo *, QVector<SceneMaterial *> > m_materials;
     QMap<FieldInfo *, Hermes::Hermes2D::Element *> m_activeElement;
 
     Point3 force(Point3 position, Point3 velocity);
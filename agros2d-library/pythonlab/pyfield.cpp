@@ -507,11 +507,25 @@ void PyField::removeMaterial(const std::string &name)
 void PyField::localValues(double x, double y, int timeStep, int adaptivityStep,
                           const std::string &solutionType, map<std::string, double> &results) const
 {
-    map<std::string, double> values;
+    vector<map<std::string, double> > values;
+    localValues(vector<double>(1, x), vector<double>(1, y), timeStep, adaptivityStep, solutionType, values);
+
+    results = values.front();
+}
+
+void PyField::localValues(const vector<double> &x, const vector<double> &y, int timeStep, int adaptivityStep,
+                          const std::string &solutionType, vector<map<std::string, double> > &results) const
+{
+    vector<map<std::string, double> > values;
+
+    if (x.size() != y.size())
+        throw invalid_argument(QObject::tr("Number of x and y coordinates must be the same.").toStdString());
 
     if (Agros2D::problem()->isSolved())
     {
-        Point point(x, y);
+        QList<Point> points;
+        for (int i = 0; i < x.size(); i++)
+            points.append(Point(x[i], y[i]));
 
         SolutionMode solutionMode = getSolutionMode(QString::fromStdString(solutionType));
 
@@ -519,24 +533,36 @@ void PyField::localValues(double x, double y, int timeStep, int adaptivityStep,
         timeStep = getTimeStep(timeStep, solutionMode);
         adaptivityStep = getAdaptivityStep(adaptivityStep, timeStep, solutionMode);
 
-        LocalValue *value = m_fieldInfo->plugin()->localValue(m_fieldInfo, timeStep, adaptivityStep, solutionMode, point);
-        QMapIterator<QString, LocalPointValue> it(value->values());
-        while (it.hasNext())
-        {
-            it.next();
+        std::string labelX = Agros2D::problem()->config()->labelX().toLower().toStdString();
+        std::string labelY = Agros2D::problem()->config()->labelY().toLower().toStdString();
 
-            Module::LocalVariable variable = m_fieldInfo->localVariable(it.key());
+        // all points in one pass
+        LocalValue *value = m_fieldInfo->plugin()->localValue(m_fieldInfo, timeStep, adaptivityStep, solutionMode, points);
+        QList<QMap<QString, LocalPointValue> > pointValues = value->pointValues();
+        for (int i = 0; i < pointValues.size(); i++)
+        {
+            map<std::string, double> pointResults;
 
-            if (variable.isScalar())
-            {
-                values[variable.shortname().toStdString()] = it.value().scalar;
-            }
-            else
+            QMapIterator<QString, LocalPointValue> it(pointValues[i]);
+            while (it.hasNext())
             {
-                values[variable.shortname().toStdString()] = it.value().vector.magnitude();
-                values[variable.shortname().toStdString() + Agros2D::problem()->config()->labelX().toLower().toStdString()] = it.value().vector.x;
-                values[variable.shortname().toStdString() + Agros2D::problem()->config()->labelY().toLower().toStdString()] = it.value().vector.y;
+                it.next();
+
+                Module::LocalVariable variable = m_fieldInfo->localVariable(it.key());
+
+                if (variable.isScalar())
+                {
+                    pointResults[variable.shortname().toStdString()] = it.value().scalar;
+                }
+                else
+                {
+                    pointResults[variable.shortname().toStdString()] = it.value().vector.magnitude();
+                    pointResults[variable.shortname().toStdString() + labelX] = it.value().vector.x;
+                    pointResults[variable.shortname().toStdString() + labelY] = it.value().vector.y;
+                }
             }
+
+            values.push_back(pointResults);
         }
         delete value;
     }
@@ -551,129 +577,198 @@ void PyField::localValues(double x, double y, int timeStep, int adaptivityStep,
 void PyField::surfaceIntegrals(const vector<int> &edges, int timeStep, int adaptivityStep,
                                const std::string &solutionType, map<std::string, double> &results) const
 {
-    map<std::string, double> values;
+    // one region, all edges if empty
+    vector<vector<int> > regions(1, edges);
+    if (edges.empty())
+        for (int i = 0; i < Agros2D::scene()->edges->length(); i++)
+            regions[0].push_back(i);
 
-    if (Agros2D::problem()->isSolved())
-    {
-        Agros2D::scene()->selectNone();
+    vector<map<std::string, double> > values;
+    surfaceIntegrals(regions, timeStep, adaptivityStep, solutionType, values);
 
-        if (!edges.empty())
-        {
-            for (vector<int>::const_iterator it = edges.begin(); it != edges.end(); ++it)
-            {
-                if ((*it >= 0) && (*it < Agros2D::scene()->edges->length()))
-                {
-                    Agros2D::scene()->edges->at(*it)->setSelected(true);
-                }
-                else
-                {
-                    throw out_of_range(QObject::tr("Edge index must be between 0 and '%1'.").arg(Agros2D::scene()->edges->length()-1).toStdString());
-                    results = values;
-                    return;
-                }
-            }
+    results = values[0];
+}
 
-            if (!silentMode() && !Agros2D::problem()->isSolving())
-                currentPythonEngineAgros()->sceneViewPost2D()->updateGL();
-        }
-        else
+void PyField::volumeIntegrals(const vector<int> &labels, int timeStep, int adaptivityStep,
+                              const std::string &solutionType, map<std::string, double> &results) const
+{
+    // one region, all labels with a material if empty
+    vector<vector<int> > regions(1, labels);
+    if (labels.empty())
+        for (int i = 0; i < Agros2D::scene()->labels->length(); i++)
+            if (Agros2D::scene()->labels->at(i)->marker(m_fieldInfo) != Agros2D::scene()->materials->getNone(m_fieldInfo))
+                regions[0].push_back(i);
+
+    vector<map<std::string, double> > values;
+    volumeIntegrals(regions, timeStep, adaptivityStep, solutionType, values);
+
+    results = values[0];
+}
+
+void PyField::surfaceIntegrals(const vector<vector<int> > &edges, int timeStep, int adaptivityStep,
+                               const std::string &solutionType, vector<map<std::string, double> > &results) const
+{
+    if (!Agros2D::problem()->isSolved())
+        throw logic_error(QObject::tr("Problem is not solved.").toStdString());
+
+    QList<QList<int> > regions;
+    for (vector<vector<int> >::const_iterator region = edges.begin(); region != edges.end(); ++region)
+    {
+        QList<int> regionEdges;
+        for (vector<int>::const_iterator it = region->begin(); it != region->end(); ++it)
         {
-            Agros2D::scene()->selectAll(SceneGeometryMode_OperateOnEdges);
+            if ((*it < 0) || (*it >= Agros2D::scene()->edges->length()))
+                throw out_of_range(QObject::tr("Edge index must be between 0 and '%1'.").arg(Agros2D::scene()->edges->length()-1).toStdString());
+
+            regionEdges.append(*it);
         }
+        regions.append(regionEdges);
+    }
 
-        SolutionMode solutionMode = getSolutionMode(QString::fromStdString(solutionType));
+    SolutionMode solutionMode = getSolutionMode(QString::fromStdString(solutionType));
 
-        // set time and adaptivity step if -1 (default parameter - last steps), check steps
-        timeStep = getTimeStep(timeStep, solutionMode);
-        adaptivityStep = getAdaptivityStep(adaptivityStep, timeStep, solutionMode);
+    // set time and adaptivity step if -1 (default parameter - last steps), check steps
+    timeStep = getTimeStep(timeStep, solutionMode);
+    adaptivityStep = getAdaptivityStep(adaptivityStep, timeStep, solutionMode);
 
-        IntegralValue *integral = m_fieldInfo->plugin()->surfaceIntegral(m_fieldInfo, timeStep, adaptivityStep, solutionMode);
-        QMapIterator<QString, double> it(integral->values());
-        while (it.hasNext())
-        {
-            it.next();
+    IntegralValue *integral = m_fieldInfo->plugin()->surfaceIntegral(m_fieldInfo, timeStep, adaptivityStep, solutionMode, regions);
+    vector<map<std::string, double> > values;
+    foreach (QMap<QString, double> regionValues, integral->regionValues())
+    {
+        map<std::string, double> regionResults;
+        for (QMap<QString, double>::const_iterator it = regionValues.constBegin(); it != regionValues.constEnd(); ++it)
+            regionResults[m_fieldInfo->surfaceIntegral(it.key()).shortname().toStdString()] = it.value();
+
+        values.push_back(regionResults);
+    }
+    delete integral;
+
+    results = values;
+}
+
+void PyField::volumeIntegrals(const vector<vector<int> > &labels, int timeStep, int adaptivityStep,
+                              const std::string &solutionType, vector<map<std::string, double> > &results) const
+{
+    if (!Agros2D::problem()->isSolved())
+        throw logic_error(QObject::tr("Problem is not solved.").toStdString());
 
-            Module::Integral integral = m_fieldInfo->surfaceIntegral(it.key());
+    QList<QList<int> > regions;
+    for (vector<vector<int> >::const_iterator region = labels.begin(); region != labels.end(); ++region)
+    {
+        QList<int> regionLabels;
+        for (vector<int>::const_iterator it = region->begin(); it != region->end(); ++it)
+        {
+            if ((*it < 0) || (*it >= Agros2D::scene()->labels->length()))
+                throw out_of_range(QObject::tr("Label index must be between 0 and '%1'.").arg(Agros2D::scene()->labels->length()-1).toStdString());
+            if (Agros2D::scene()->labels->at(*it)->marker(m_fieldInfo) == Agros2D::scene()->materials->getNone(m_fieldInfo))
+                throw out_of_range(QObject::tr("Label with index '%1' is 'none'.").arg(*it).toStdString());
 
-            values[integral.shortname().toStdString()] = it.value();
+            regionLabels.append(*it);
         }
-        delete integral;
+        regions.append(regionLabels);
     }
-    else
+
+    SolutionMode solutionMode = getSolutionMode(QString::fromStdString(solutionType));
+
+    // set time and adaptivity step if -1 (default parameter - last steps), check steps
+    timeStep = getTimeStep(timeStep, solutionMode);
+    adaptivityStep = getAdaptivityStep(adaptivityStep, timeStep, solutionMode);
+
+    IntegralValue *integral = m_fieldInfo->plugin()->volumeIntegral(m_fieldInfo, timeStep, adaptivityStep, solutionMode, regions);
+    vector<map<std::string, double> > values;
+    foreach (QMap<QString, double> regionValues, integral->regionValues())
     {
-        throw logic_error(QObject::tr("Problem is not solved.").toStdString());
+        map<std::string, double> regionResults;
+        for (QMap<QString, double>::const_iterator it = regionValues.constBegin(); it != regionValues.constEnd(); ++it)
+            regionResults[m_fieldInfo->volumeIntegral(it.key()).shortname().toStdString()] = it.value();
+
+        values.push_back(regionResults);
     }
+    delete integral;
 
     results = values;
 }
 
-void PyField::volumeIntegrals(const vector<int> &labels, int timeStep, int adaptivityStep,
-                              const std::string &solutionType, map<std::string, double> &results) const
+int PyField::addLocalValuesProbe(double x, double y)
 {
-    map<std::string, double> values;
+    return Agros2D::solutionStore()->addProbe(SolutionStore::Probe(m_fieldInfo, SolutionStore::ProbeType_LocalValue, Point(x, y)));
+}
 
-    if (Agros2D::problem()->isSolved())
+int PyField::addSurfaceIntegralsProbe(const vector<int> &edges)
+{
+    QList<int> regionEdges;
+    for (vector<int>::const_iterator it = edges.begin(); it != edges.end(); ++it)
     {
-        Agros2D::scene()->selectNone();
+        if ((*it < 0) || (*it >= Agros2D::scene()->edges->length()))
+            throw out_of_range(QObject::tr("Edge index must be between 0 and '%1'.").arg(Agros2D::scene()->edges->length()-1).toStdString());
 
-        if (!labels.empty())
-        {
-            for (vector<int>::const_iterator it = labels.begin(); it != labels.end(); ++it)
-            {
-                if ((*it >= 0) && (*it < Agros2D::scene()->labels->length()))
-                {
-                    if (Agros2D::scene()->labels->at(*it)->marker(m_fieldInfo) != Agros2D::scene()->materials->getNone(m_fieldInfo))
-                    {
-                        Agros2D::scene()->labels->at(*it)->setSelected(true);
-                    }
-                    else
-                    {
-                        throw out_of_range(QObject::tr("Label with index '%1' is 'none'.").arg(*it).toStdString());
-                    }
-                }
-                else
-                {
-                    throw out_of_range(QObject::tr("Label index must be between 0 and '%1'.").arg(Agros2D::scene()->labels->length()-1).toStdString());
-                    results = values;
-                    return;
-                }
-            }
+        regionEdges.append(*it);
+    }
 
-            if (!silentMode() && !Agros2D::problem()->isSolving())
-                currentPythonEngineAgros()->sceneViewPost2D()->updateGL();
-        }
-        else
-        {
-            Agros2D::scene()->selectAll(SceneGeometryMode_OperateOnLabels);
-        }
+    return Agros2D::solutionStore()->addProbe(SolutionStore::Probe(m_fieldInfo, SolutionStore::ProbeType_SurfaceIntegral, Point(), regionEdges));
+}
 
-        SolutionMode solutionMode = getSolutionMode(QString::fromStdString(solutionType));
+int PyField::addVolumeIntegralsProbe(const vector<int> &labels)
+{
+    QList<int> regionLabels;
+    for (vector<int>::const_iterator it = labels.begin(); it != labels.end(); ++it)
+    {
+        if ((*it < 0) || (*it >= Agros2D::scene()->labels->length()))
+            throw out_of_range(QObject::tr("Label index must be between 0 and '%1'.").arg(Agros2D::scene()->labels->length()-1).toStdString());
+        if (Agros2D::scene()->labels->at(*it)->marker(m_fieldInfo) == Agros2D::scene()->materials->getNone(m_fieldInfo))
+            throw out_of_range(QObject::tr("Label with index '%1' is 'none'.").arg(*it).toStdString());
 
-        // set time and adaptivity step if -1 (default parameter - last steps), check steps
-        timeStep = getTimeStep(timeStep, solutionMode);
-        adaptivityStep = getAdaptivityStep(adaptivityStep, timeStep, solutionMode);
+        regionLabels.append(*it);
+    }
 
-        IntegralValue *integral = m_fieldInfo->plugin()->volumeIntegral(m_fieldInfo, timeStep, adaptivityStep, solutionMode);
-        QMapIterator<QString, double> it(integral->values());
-        while (it.hasNext())
-        {
-            it.next();
+    return Agros2D::solutionStore()->addProbe(SolutionStore::Probe(m_fieldInfo, SolutionStore::ProbeType_VolumeIntegral, Point(), regionLabels));
+}
+
+void PyField::probeSeries(int id, vector<double> &times, map<std::string, vector<double> > &results) const
+{
+    if (!Agros2D::solutionStore()->hasProbe(id) || (Agros2D::solutionStore()->probe(id).fieldInfo != m_fieldInfo))
+        throw out_of_range(QObject::tr("Probe with id '%1' does not exist.").arg(id).toStdString());
 
-            Module::Integral integral = m_fieldInfo->volumeIntegral(it.key());
+    SolutionStore::Probe probe = Agros2D::solutionStore()->probe(id);
+    SolutionStore::ProbeSeries series = Agros2D::solutionStore()->probeSeries(id);
 
-            values[integral.shortname().toStdString()] = it.value();
+    times = series.times.toStdVector();
 
-        }
-        delete integral;
+    map<std::string, vector<double> > values;
+    for (QMap<QString, QVector<double> >::const_iterator it = series.scalars.constBegin(); it != series.scalars.constEnd(); ++it)
+    {
+        QString shortname;
+        if (probe.type == SolutionStore::ProbeType_LocalValue)
+            shortname = m_fieldInfo->localVariable(it.key()).shortname();
+        else if (probe.type == SolutionStore::ProbeType_SurfaceIntegral)
+            shortname = m_fieldInfo->surfaceIntegral(it.key()).shortname();
+        else
+            shortname = m_fieldInfo->volumeIntegral(it.key()).shortname();
+
+        values[shortname.toStdString()] = it.value().toStdVector();
     }
-    else
+
+    std::string labelX = Agros2D::problem()->config()->labelX().toLower().toStdString();
+    std::string labelY = Agros2D::problem()->config()->labelY().toLower().toStdString();
+    for (QMap<QString, QVector<Point> >::const_iterator it = series.vectors.constBegin(); it != series.vectors.constEnd(); ++it)
     {
-        throw logic_error(QObject::tr("Problem is not solved.").toStdString());
+        std::string shortname = m_fieldInfo->localVariable(it.key()).shortname().toStdString();
+        foreach (Point vector, it.value())
+        {
+            values[shortname].push_back(vector.magnitude());
+            values[shortname + labelX].push_back(vector.x);
+            values[shortname + labelY].push_back(vector.y);
+        }
     }
 
     results = values;
 }
 
+void PyField::removeProbes()
+{
+    Agros2D::solutionStore()->removeProbes(m_fieldInfo);
+}
+
 void PyField::initialMeshInfo(map<std::string, int> &info) const
 {
     if (!Agros2D::problem()->isMeshed())
@@ -136,10 +136,25 @@ class PyField
         // local values, integrals
         void localValues(double x, double y, int timeStep, int adaptivityStep,
                          const std::string &solutionType, map<std::string, double> &results) const;
+        // local values in many points in one pass (empty results for points outside of the mesh)
+        void localValues(const vector<double> &x, const vector<double> &y, int timeStep, int adaptivityStep,
+                         const std::string &solutionType, vector<map<std::string, double> > &results) const;
         void surfaceIntegrals(const vector<int> &edges, int timeStep, int adaptivityStep,
                               const std::string &solutionType, map<std::string, double> &results) const;
         void volumeIntegrals(const vector<int> &labels, int timeStep, int adaptivityStep,
                              const std::string &solutionType, map<std::string, double> &results) const;
+        // integrals over many sets of edges (labels), one pass over the mesh, selection is not changed
+        void surfaceIntegrals(const vector<vector<int> > &edges, int timeStep, int adaptivityStep,
+                              const std::string &solutionType, vector<map<std::string, double> > &results) const;
+        void volumeIntegrals(const vector<vector<int> > &labels, int timeStep, int adaptivityStep,
+                             const std::string &solutionType, vector<map<std::string, double> > &results) const;
+
+        // probes recorded during the solve
+        int addLocalValuesProbe(double x, double y);
+        int addSurfaceIntegralsProbe(const vector<int> &edges);
+        int addVolumeIntegralsProbe(const vector<int> &labels);
+        void probeSeries(int id, vector<double> &times, map<std::string, vector<double> > &results) const;
+        void removeProbes();
 
         // mesh info
         void initialMeshInfo(map<std::string, int> &info) const;
@@ -26,57 +26,68 @@ void PyParticleTracing::solve()
     if (!Agros2D::problem()->isSolved())
         throw invalid_argument(QObject::tr("Problem is not solved.").toStdString());
 
-    // initial position
-    Point3 initialPosition;
-    initialPosition.x = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartX).toDouble();
-    initialPosition.y = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartY).toDouble();
-    initialPosition.z = 0.0;
+    QList<Point3> initialPositions;
+    QList<Point3> initialVelocities;
+    ParticleTracing::initialConditions(Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleNumberOfParticles).toInt(),
+                                       initialPositions, initialVelocities);
 
-    // initial velocity
-    Point3 initialVelocity;
-    initialVelocity.x = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartVelocityX).toDouble();
-    initialVelocity.y = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartVelocityY).toDouble();
-    initialVelocity.z = 0.0;
-
-    ParticleTracing particleTracing;
-    particleTracing.computeTrajectoryParticle(initialPosition, initialVelocity);
-
-    m_positions = particleTracing.positions();
-    m_velocities = particleTracing.velocities();
-    m_times = particleTracing.times();
+    // trajectories are computed on the threads
+    ParticleTracing::computeTrajectoryParticles(initialPositions, initialVelocities,
+                                                m_positions, m_velocities, m_times);
 }
 
 void PyParticleTracing::positions(vector<double> &x,
                                   vector<double> &y,
-                                  vector<double> &z) const
+                                  vector<double> &z,
+                                  int particle) const
 {
-    for (int i = 0; i < length(); i++)
+    checkParticle(particle);
+
+    for (int i = 0; i < length(particle); i++)
     {
-        x.push_back(m_positions[i].x);
-        y.push_back(m_positions[i].y);
-        z.push_back(m_positions[i].z);
+        x.push_back(m_positions[particle][i].x);
+        y.push_back(m_positions[particle][i].y);
+        z.push_back(m_positions[particle][i].z);
     }
 }
 
 void PyParticleTracing::velocities(vector<double> &x,
                                    vector<double> &y,
-                                   vector<double> &z) const
+                                   vector<double> &z,
+                                   int particle) const
 {
-    for (int i = 0; i < length(); i++)
+    checkParticle(particle);
+
+    for (int i = 0; i < length(particle); i++)
     {
-        x.push_back(m_velocities[i].x);
-        y.push_back(m_velocities[i].y);
-        z.push_back(m_velocities[i].z);
+        x.push_back(m_velocities[particle][i].x);
+        y.push_back(m_velocities[particle][i].y);
+        z.push_back(m_velocities[particle][i].z);
     }
 }
 
-void PyParticleTracing::times(vector<double> &time) const
+void PyParticleTracing::times(vector<double> &time, int particle) const
+{
+    checkParticle(particle);
+
+    for (int i = 0; i < length(particle); i++)
+        time.push_back(m_times[particle][i]);
+}
+
+int PyParticleTracing::length(int particle) const
+{
+    checkParticle(particle);
+
+    return m_positions[particle].length();
+}
+
+void PyParticleTracing::checkParticle(int particle) const
 {
     if (m_times.isEmpty())
         throw logic_error(QObject::tr("Trajectories of particles are not solved.").toStdString());
 
-    for (int i = 0; i < length(); i++)
-        time.push_back(m_times[i]);
+    if (particle < 0 || particle >= m_times.count())
+        throw out_of_range(QObject::tr("Particle index must be between 0 and '%1'.").arg(m_times.count() - 1).toStdString());
 }
 
 void PyParticleTracing::getInitialPosition(vector<double> &position) const
@@ -121,18 +121,20 @@ public:
     inline int getNumShowParticlesAxi() const { return Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleNumShowParticlesAxi).toInt(); }
     void setNumShowParticlesAxi(int particles);
 
-    // solve
+    // solve (all particles)
     void solve();
-    void positions(vector<double> &x, vector<double> &y, vector<double> &z) const;
-    void velocities(vector<double> &x, vector<double> &y, vector<double> &z) const;
-    void times(vector<double> &time) const;
-    inline int length() const { return m_positions.length(); }
+    void positions(vector<double> &x, vector<double> &y, vector<double> &z, int particle = 0) const;
+    void velocities(vector<double> &x, vector<double> &y, vector<double> &z, int particle = 0) const;
+    void times(vector<double> &time, int particle = 0) const;
+    int length(int particle = 0) const;
 
 private:
-    // position and velocity
-    QList<Point3> m_positions;
-    QList<Point3> m_velocities;
-    QList<double> m_times;
+    // position and velocity of the particles
+    QList<QList<Point3> > m_positions;
+    QList<QList<Point3> > m_velocities;
+    QList<QList<double> > m_times;
+
+    void checkParticle(int particle) const;
 };
 
 #endif // PYTHONLABPARTICLETRACING_H
@@ -22,6 +22,8 @@
 #include "logview.h"
 #include "hermes2d/plugin_interface.h"
 #include "hermes2d/module.h"
+#include "hermes2d/solutionstore.h"
+#include "util/constants.h"
 #ifdef _MSC_VER
 # ifdef _DEBUG
 #  undef _DEBUG
@@ -769,6 +771,17 @@ void memoryUsage(std::vector<int> &time, std::vector<int> &usage)
     usage = Agros2D::memoryMonitor()->memoryUsage().toVector().toStdVector();
 }
 
+void cacheStatistics(std::map<std::string, double> &info)
+{
+    SolutionStore::CacheStatistics statistics = Agros2D::solutionStore()->cacheStatistics();
+
+    info["hits"] = statistics.hits;
+    info["misses"] = statistics.misses;
+    info["evictions"] = statistics.evictions;
+    info["count"] = Agros2D::solutionStore()->cacheCount();
+    info["size"] = Agros2D::solutionStore()->cacheMemorySize() / 1024.0 / 1024.0;
+}
+
 // ************************************************************************************
 
 void PyOptions::setNumberOfThreads(int threads)
@@ -779,10 +792,18 @@ void PyOptions::setNumberOfThreads(int threads)
     Agros2D::configComputer()->numberOfThreads = threads;
 }
 
+void PyOptions::setNumberOfParallelBlocks(int blocks)
+{
+    if (blocks < 1 || blocks > omp_get_max_threads())
+        throw out_of_range(QObject::tr("Number of parallel blocks is out of range (1 - %1).").arg(omp_get_max_threads()).toStdString());
+
+    Agros2D::configComputer()->numberOfParallelBlocks = blocks;
+}
+
 void PyOptions::setCacheSize(int size)
 {
-    if (size < 2 || size > 50)
-        throw out_of_range(QObject::tr("Cache size is out of range (2 - 50).").toStdString());
+    if (size < CACHE_SIZE_MIN || size > CACHE_SIZE_MAX)
+        throw out_of_range(QObject::tr("Cache size is out of range (%1 - %2 MB).").arg(CACHE_SIZE_MIN).arg(CACHE_SIZE_MAX).toStdString());
 
     Agros2D::configComputer()->cacheSize = size;
 }
@@ -126,6 +126,7 @@ inline std::string getScriptFromModel() { return createPythonFromModel().toStdSt
 
 int appTime();
 void memoryUsage(std::vector<int> &time, std::vector<int> &usage);
+void cacheStatistics(std::map<std::string, double> &info);
 
 struct PyOptions
 {
@@ -133,7 +134,11 @@ struct PyOptions
     inline int getNumberOfThreads() const { return Agros2D::configComputer()->numberOfThreads; }
     void setNumberOfThreads(int threads);
 
-    // cache size
+    // number of blocks solved concurrently
+    inline int getNumberOfParallelBlocks() const { return Agros2D::configComputer()->numberOfParallelBlocks; }
+    void setNumberOfParallelBlocks(int blocks);
+
+    // cache size (MB)
     inline int getCacheSize() const { return Agros2D::configComputer()->cacheSize; }
     void setCacheSize(int size);
 
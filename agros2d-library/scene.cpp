@@ -51,7 +51,6 @@
 #include "hermes2d/solutionstore.h"
 #include "hermes2d/plugin_interface.h"
 
-#include "../3rdparty/quazip/JlCompress.h"
 
 #include "../resources_source/classes/problem_a2d_31_xml.h"
 
@@ -2353,7 +2352,8 @@ void Scene::readSolutionFromFile(const QString &fileName)
     {
         Agros2D::log()->printMessage(tr("Problem"), tr("Loading solution from disk"));
 
-        JlCompress::extractDir(solutionFile, cacheProblemDir());
+        // solutions are read from the archive on demand
+        Agros2D::solutionStore()->openArchive(solutionFile);
 
         // read mesh file
         if (QFile::exists(QString("%1/initial.msh").arg(cacheProblemDir())))
@@ -2395,8 +2395,10 @@ void Scene::writeSolutionToFile(const QString &fileName)
 
     QFileInfo fileInfo(fileName);
     QString solutionFN = QString("%1/%2.sol").arg(fileInfo.absolutePath()).arg(fileInfo.baseName());
-    if (QFile(solutionFN).open(QIODevice::WriteOnly))
-        JlCompress::compressDir(solutionFN, cacheProblemDir());
+    // opening of the file would create an empty archive
+    bool writable = QFile::exists(solutionFN) ? QFileInfo(solutionFN).isWritable() : QFileInfo(fileInfo.absolutePath()).isWritable();
+    if (writable)
+        Agros2D::solutionStore()->saveArchive(solutionFN);
     else
         Agros2D::log()->printError(tr("Solver"), tr("Access denied '%1'").arg(solutionFN));
 }
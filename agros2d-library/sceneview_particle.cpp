@@ -1126,67 +1126,45 @@ void SceneViewParticleTracing::processParticleTracing()
         m_velocityMin =  numeric_limits<double>::max();
         m_velocityMax = -numeric_limits<double>::max();
 
-        for (int k = 0; k < Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleNumberOfParticles).toInt(); k++)
+        QList<Point3> initialPositions;
+        QList<Point3> initialVelocities;
+        ParticleTracing::initialConditions(Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleNumberOfParticles).toInt(),
+                                           initialPositions, initialVelocities);
+
+        try
         {
-            // position and velocity cache
-            ParticleTracing particleTracing;
-            try
-            {
-                // initial position
-                Point3 initialPosition;
-                initialPosition.x = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartX).toDouble();
-                initialPosition.y = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartY).toDouble();
-                initialPosition.z = 0.0;
-
-                // initial velocity
-                Point3 initialVelocity;
-                initialVelocity.x = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartVelocityX).toDouble();
-                initialVelocity.y = Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartVelocityY).toDouble();
-                initialVelocity.z = 0.0;
-
-                // random point
-                if (k > 0)
-                {
-                    Point3 dp(rand() * (Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble()) / RAND_MAX,
-                              rand() * (Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble()) / RAND_MAX,
-                              (Agros2D::problem()->config()->coordinateType() == CoordinateType_Planar) ? 0.0 : rand() * 2.0*M_PI / RAND_MAX);
+            // trajectories are computed on the threads
+            ParticleTracing::computeTrajectoryParticles(initialPositions, initialVelocities,
+                                                        m_positionsList, m_velocitiesList, m_timesList);
+        }
+        catch (AgrosException& e)
+        {
+            Agros2D::log()->printWarning(tr("Particle tracing"), tr("Particle tracing failed (%1)").append(e.what()));
+            clearParticleLists();
 
-                    initialPosition = Point3(-Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble() / 2,
-                                             -Agros2D::problem()->setting()->value(ProblemSetting::View_ParticleStartingRadius).toDouble() / 2,
-                                             (Agros2D::problem()->config()->coordinateType() == CoordinateType_Planar) ? 0.0 : -1.0*M_PI) + initialPosition + dp;
-                }
+            return;
+        }
+        catch (...)
+        {
+            Agros2D::log()->printWarning(tr("Particle tracing"), tr("Catched unknown exception in particle tracing"));
+            clearParticleLists();
 
-                particleTracing.computeTrajectoryParticle(initialPosition, initialVelocity);
-            }
-            catch (AgrosException& e)
-            {
-                Agros2D::log()->printWarning(tr("Particle tracing"), tr("Particle tracing failed (%1)").append(e.what()));
-                m_velocityMin = 0.0;
-                m_velocityMax = 0.0;
+            return;
+        }
 
-                return;
-            }
-            catch (...)
+        for (int k = 0; k < m_velocitiesList.count(); k++)
+        {
+            // velocity min and max value
+            foreach (Point3 velocity, m_velocitiesList[k])
             {
-                Agros2D::log()->printWarning(tr("Particle tracing"), tr("Catched unknown exception in particle tracing"));
-                m_velocityMin = 0.0;
-                m_velocityMax = 0.0;
-
-                return;
+                if (velocity.magnitude() < m_velocityMin) m_velocityMin = velocity.magnitude();
+                if (velocity.magnitude() > m_velocityMax) m_velocityMax = velocity.magnitude();
             }
 
-            m_positionsList.append(particleTracing.positions());
-            m_velocitiesList.append(particleTracing.velocities());
-            m_timesList.append(particleTracing.times());
-
-            // velocity min and max value
-            if (particleTracing.velocityMin() < m_velocityMin) m_velocityMin = particleTracing.velocityMin();
-            if (particleTracing.velocityMax() > m_velocityMax) m_velocityMax = particleTracing.velocityMax();
-
             Agros2D::log()->printMessage(tr("Particle Tracing"), tr("Particle %1: %2 steps, final time %3 s").
                                          arg(k + 1).
-                                         arg(particleTracing.times().count()).
-                                         arg(particleTracing.times().last()));
+                                         arg(m_timesList[k].count()).
+                                         arg(m_timesList[k].last()));
         }
     }
     Agros2D::log()->printDebug(tr("Particle Tracing"), tr("Total cpu time %1 ms").arg(cpuTime.elapsed()));
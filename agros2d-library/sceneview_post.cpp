@@ -52,12 +52,145 @@
 
 #include "pythonlab/pythonengine.h"
 
+// hidden or invalid view is released
+template <typename View>
+static void releaseView(View **view, QString *viewKey)
+{
+    if (*view)
+    {
+        delete *view;
+        *view = NULL;
+    }
+    viewKey->clear();
+}
+
+// processing of one view in the background, output is assigned to the view in the main thread (finish)
+// solutions are cloned, the thread does not share their state with the main thread
+class PostHermesThread : public QThread
+{
+public:
+    PostHermesThread(Hermes::Hermes2D::Views::Linearizer *linearizer, Hermes::Hermes2D::MeshFunctionSharedPtr<double> solution,
+                     Hermes::Hermes2D::Views::Linearizer **view, QString *viewKey, const QString &key,
+                     const QString &errorTitle, const QString &errorMessage)
+        : QThread(), m_linearizer(linearizer), m_vectorizer(NULL), m_orderizer(NULL),
+          m_linearizerView(view), m_vectorizerView(NULL), m_orderizerView(NULL),
+          m_viewKey(viewKey), m_key(key), m_errorTitle(errorTitle), m_errorMessage(errorMessage)
+    {
+        m_solutions[0] = Hermes::Hermes2D::MeshFunctionSharedPtr<double>(solution->clone());
+    }
+
+    PostHermesThread(Hermes::Hermes2D::Views::Vectorizer *vectorizer,
+                     Hermes::Hermes2D::MeshFunctionSharedPtr<double> solutionX, Hermes::Hermes2D::MeshFunctionSharedPtr<double> solutionY,
+                     Hermes::Hermes2D::Views::Vectorizer **view, QString *viewKey, const QString &key,
+                     const QString &errorTitle, const QString &errorMessage)
+        : QThread(), m_linearizer(NULL), m_vectorizer(vectorizer), m_orderizer(NULL),
+          m_linearizerView(NULL), m_vectorizerView(view), m_orderizerView(NULL),
+          m_viewKey(viewKey), m_key(key), m_errorTitle(errorTitle), m_errorMessage(errorMessage)
+    {
+        m_solutions[0] = Hermes::Hermes2D::MeshFunctionSharedPtr<double>(solutionX->clone());
+        m_solutions[1] = Hermes::Hermes2D::MeshFunctionSharedPtr<double>(solutionY->clone());
+    }
+
+    PostHermesThread(Hermes::Hermes2D::Views::Orderizer *orderizer, Hermes::Hermes2D::SpaceSharedPtr<double> space,
+                     Hermes::Hermes2D::Views::Orderizer **view, QString *viewKey, const QString &key,
+                     const QString &errorTitle, const QString &errorMessage)
+        : QThread(), m_linearizer(NULL), m_vectorizer(NULL), m_orderizer(orderizer),
+          m_linearizerView(NULL), m_vectorizerView(NULL), m_orderizerView(view), m_space(space),
+          m_viewKey(viewKey), m_key(key), m_errorTitle(errorTitle), m_errorMessage(errorMessage) {}
+
+    // replaces the view by the new output (main thread)
+    void finish()
+    {
+        bool failed = !m_error.isEmpty();
+
+        if (m_linearizerView)
+        {
+            if (*m_linearizerView)
+                delete *m_linearizerView;
+            *m_linearizerView = failed ? NULL : m_linearizer;
+            if (failed)
+                delete m_linearizer;
+        }
+        if (m_vectorizerView)
+        {
+            if (*m_vectorizerView)
+                delete *m_vectorizerView;
+            *m_vectorizerView = failed ? NULL : m_vectorizer;
+            if (failed)
+                delete m_vectorizer;
+        }
+        if (m_orderizerView)
+        {
+            if (*m_orderizerView)
+                delete *m_orderizerView;
+            *m_orderizerView = failed ? NULL : m_orderizer;
+            if (failed)
+                delete m_orderizer;
+        }
+
+        if (failed)
+        {
+            m_viewKey->clear();
+            Agros2D::log()->printError(m_errorTitle, m_errorMessage.arg(m_error));
+        }
+        else
+        {
+            *m_viewKey = m_key;
+        }
+    }
+
+protected:
+    virtual void run()
+    {
+        try
+        {
+            if (m_linearizer)
+            {
+                m_linearizer->process_solution(m_solutions[0], Hermes::Hermes2D::H2D_FN_VAL_0);
+            }
+            else if (m_vectorizer)
+            {
+                int items[2] = { Hermes::Hermes2D::H2D_FN_VAL_0, Hermes::Hermes2D::H2D_FN_VAL_0 };
+                m_vectorizer->process_solution(m_solutions, items);
+            }
+            else if (m_orderizer)
+            {
+                m_orderizer->process_space(m_space);
+            }
+        }
+        catch (Hermes::Exceptions::Exception &e)
+        {
+            m_error = QString(e.what());
+        }
+    }
+
+private:
+    Hermes::Hermes2D::Views::Linearizer *m_linearizer;
+    Hermes::Hermes2D::Views::Vectorizer *m_vectorizer;
+    Hermes::Hermes2D::Views::Orderizer *m_orderizer;
+
+    Hermes::Hermes2D::Views::Linearizer **m_linearizerView;
+    Hermes::Hermes2D::Views::Vectorizer **m_vectorizerView;
+    Hermes::Hermes2D::Views::Orderizer **m_orderizerView;
+
+    Hermes::Hermes2D::MeshFunctionSharedPtr<double> m_solutions[2];
+    Hermes::Hermes2D::SpaceSharedPtr<double> m_space;
+
+    QString *m_viewKey;
+    QString m_key;
+
+    QString m_errorTitle;
+    QString m_errorMessage;
+    QString m_error;
+};
+
 PostHermes::PostHermes() :
     m_activeViewField(NULL),
     m_activeTimeStep(NOT_FOUND_SO_FAR),
     m_activeAdaptivityStep(NOT_FOUND_SO_FAR),
     m_activeSolutionMode(SolutionMode_Undefined),
     m_isProcessed(false),
+    m_isRefreshPending(false),
     m_linInitialMeshView(NULL),
     m_linSolutionMeshView(NULL),
     m_orderView(NULL),
@@ -78,29 +211,57 @@ PostHermes::~PostHermes()
     clear();
 }
 
+void PostHermes::addThread(PostHermesThread *thread)
+{
+    m_threads.append(thread);
+}
+
+void PostHermes::runThreads()
+{
+    // views are processed one after another (linearizers use all cores themselves)
+    // events are processed meanwhile (repaint), user input is postponed
+    QEventLoop loop;
+    foreach (PostHermesThread *thread, m_threads)
+    {
+        connect(thread, SIGNAL(finished()), &loop, SLOT(quit()));
+        thread->start();
+
+        while (!thread->isFinished())
+            loop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+
+    // outputs are assigned when all views are finished
+    foreach (PostHermesThread *thread, m_threads)
+    {
+        thread->wait();
+        thread->finish();
+
+        delete thread;
+    }
+    m_threads.clear();
+}
+
 void PostHermes::processInitialMesh()
 {
     if (Agros2D::problem()->isMeshed() && (m_activeViewField) && (Agros2D::problem()->setting()->value(ProblemSetting::View_ShowInitialMeshView).toBool()))
     {
-        Agros2D::log()->printMessage(tr("Mesh View"), tr("Initial mesh with %1 elements").arg(m_activeViewField->initialMesh()->get_num_active_elements()));
+        QString key = m_activeViewField->fieldId();
+        if (m_linInitialMeshView && (m_initialMeshKey == key))
+            return;
 
-        if (m_linInitialMeshView)
-            delete m_linInitialMeshView;
-        m_linInitialMeshView = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
+        Agros2D::log()->printMessage(tr("Mesh View"), tr("Initial mesh with %1 elements").arg(m_activeViewField->initialMesh()->get_num_active_elements()));
 
         // init linearizer for initial mesh
-        try
-        {
-            m_linInitialMeshView->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(1));
-            m_linInitialMeshView->process_solution(Hermes::Hermes2D::MeshFunctionSharedPtr<double>(new Hermes::Hermes2D::ZeroSolution<double>(m_activeViewField->initialMesh())));
-        }
-        catch (Hermes::Exceptions::Exception& e)
-        {
-            delete m_linInitialMeshView;
-            m_linInitialMeshView = NULL;
+        Hermes::Hermes2D::Views::Linearizer *linearizer = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
+        linearizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(1));
 
-            Agros2D::log()->printError("Mesh View", QObject::tr("Linearizer (initial mesh) processing failed: %1").arg(e.what()));
-        }
+        addThread(new PostHermesThread(linearizer, Hermes::Hermes2D::MeshFunctionSharedPtr<double>(new Hermes::Hermes2D::ZeroSolution<double>(m_activeViewField->initialMesh())),
+                                       &m_linInitialMeshView, &m_initialMeshKey, key,
+                                       "Mesh View", QObject::tr("Linearizer (initial mesh) processing failed: %1")));
+    }
+    else
+    {
+        releaseView(&m_linInitialMeshView, &m_initialMeshKey);
     }
 }
 
@@ -110,27 +271,26 @@ void PostHermes::processSolutionMesh()
     {
         int comp = Agros2D::problem()->setting()->value(ProblemSetting::View_OrderComponent).toInt() - 1;
 
+        FieldSolutionID fsid(activeViewField(), activeTimeStep(), activeAdaptivityStep(), activeAdaptivitySolutionType());
+        QString key = QString("%1|%2").arg(fsid.toString()).arg(comp);
+        if (m_linSolutionMeshView && (m_solutionMeshKey == key))
+            return;
+
         Agros2D::log()->printMessage(tr("Mesh View"), tr("Solution mesh with %1 elements").arg(activeMultiSolutionArray().solutions().at(comp)->get_mesh()->get_num_active_elements()));
 
         // init linearizer for solution mesh
         const Hermes::Hermes2D::MeshSharedPtr mesh = activeMultiSolutionArray().solutions().at(comp)->get_mesh();
 
-        if (m_linSolutionMeshView)
-            delete m_linSolutionMeshView;
-        m_linSolutionMeshView = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
+        Hermes::Hermes2D::Views::Linearizer *linearizer = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
+        linearizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(1));
 
-        try
-        {
-            m_linSolutionMeshView->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(1));
-            m_linSolutionMeshView->process_solution(Hermes::Hermes2D::MeshFunctionSharedPtr<double>(new Hermes::Hermes2D::ZeroSolution<double>(mesh)));
-        }
-        catch (Hermes::Exceptions::Exception& e)
-        {
-            delete m_linSolutionMeshView;
-            m_linSolutionMeshView = NULL;
-
-            Agros2D::log()->printError("Mesh View", QObject::tr("Linearizer (solution mesh) processing failed: %1").arg(e.what()));
-        }
+        addThread(new PostHermesThread(linearizer, Hermes::Hermes2D::MeshFunctionSharedPtr<double>(new Hermes::Hermes2D::ZeroSolution<double>(mesh)),
+                                       &m_linSolutionMeshView, &m_solutionMeshKey, key,
+                                       "Mesh View", QObject::tr("Linearizer (solution mesh) processing failed: %1")));
+    }
+    else
+    {
+        releaseView(&m_linSolutionMeshView, &m_solutionMeshKey);
     }
 }
 
@@ -139,25 +299,22 @@ void PostHermes::processOrder()
     // init linearizer for order view
     if ((Agros2D::problem()->isSolved()) && (m_activeViewField) && (Agros2D::problem()->setting()->value(ProblemSetting::View_ShowOrderView).toBool()))
     {
-        Agros2D::log()->printMessage(tr("Mesh View"), tr("Polynomial order"));
-
         int comp = Agros2D::problem()->setting()->value(ProblemSetting::View_OrderComponent).toInt() - 1;
 
-        if (m_orderView)
-            delete m_orderView;
-        m_orderView = new Hermes::Hermes2D::Views::Orderizer();
+        FieldSolutionID fsid(activeViewField(), activeTimeStep(), activeAdaptivityStep(), activeAdaptivitySolutionType());
+        QString key = QString("%1|%2").arg(fsid.toString()).arg(comp);
+        if (m_orderView && (m_orderKey == key))
+            return;
 
-        try
-        {
-            m_orderView->process_space(activeMultiSolutionArray().spaces().at(comp));
-        }
-        catch (Hermes::Exceptions::Exception& e)
-        {
-            delete m_orderView;
-            m_orderView = NULL;
+        Agros2D::log()->printMessage(tr("Mesh View"), tr("Polynomial order"));
 
-            Agros2D::log()->printError("Order View", QObject::tr("Orderizer processing failed: %1").arg(e.what()));
-        }
+        addThread(new PostHermesThread(new Hermes::Hermes2D::Views::Orderizer(), activeMultiSolutionArray().spaces().at(comp),
+                                       &m_orderView, &m_orderKey, key,
+                                       "Order View", QObject::tr("Orderizer processing failed: %1")));
+    }
+    else
+    {
+        releaseView(&m_orderView, &m_orderKey);
     }
 }
 
@@ -165,37 +322,29 @@ void PostHermes::processRangeContour()
 {
     if (Agros2D::problem()->isSolved() && m_activeViewField && (Agros2D::problem()->setting()->value(ProblemSetting::View_ShowContourView).toBool()))
     {
-        bool contains = false;
-        foreach (Module::LocalVariable variable, m_activeViewField->viewScalarVariables())
-        {
-            if (variable.id() == Agros2D::problem()->setting()->value(ProblemSetting::View_ContourVariable).toString())
-            {
-                contains = true;
-                break;
-            }
-        }
+        QString variableName = Agros2D::problem()->setting()->value(ProblemSetting::View_ContourVariable).toString();
+        bool deform = m_activeViewField->hasDeformableShape() && Agros2D::problem()->setting()->value(ProblemSetting::View_DeformContour).toBool();
 
-        Agros2D::log()->printMessage(tr("Post View"), tr("Contour view (%1)").arg(Agros2D::problem()->setting()->value(ProblemSetting::View_ContourVariable).toString()));
+        FieldSolutionID fsid(activeViewField(), activeTimeStep(), activeAdaptivityStep(), activeAdaptivitySolutionType());
+        QString key = QString("%1|%2|%3").arg(fsid.toString()).arg(variableName).arg(deform);
+        if (m_linContourView && (m_contourKey == key))
+            return;
+
+        Agros2D::log()->printMessage(tr("Post View"), tr("Contour view (%1)").arg(variableName));
 
-        QString variableName = Agros2D::problem()->setting()->value(ProblemSetting::View_ContourVariable).toString();
         Module::LocalVariable variable = m_activeViewField->localVariable(variableName);
 
         Hermes::Hermes2D::MeshFunctionSharedPtr<double> slnContourView;
         if (variable.isScalar())
-            slnContourView = viewScalarFilter(m_activeViewField->localVariable(Agros2D::problem()->setting()->value(ProblemSetting::View_ContourVariable).toString()),
-                                              PhysicFieldVariableComp_Scalar);
+            slnContourView = viewScalarFilter(variable, PhysicFieldVariableComp_Scalar);
         else
-            slnContourView = viewScalarFilter(m_activeViewField->localVariable(Agros2D::problem()->setting()->value(ProblemSetting::View_ContourVariable).toString()),
-                                              PhysicFieldVariableComp_Magnitude);
+            slnContourView = viewScalarFilter(variable, PhysicFieldVariableComp_Magnitude);
 
         // new linearizer
-        if (m_linContourView)
-            delete m_linContourView;
-        m_linContourView = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
-
+        Hermes::Hermes2D::Views::Linearizer *linearizer = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
 
         // deformed shape
-        if (m_activeViewField->hasDeformableShape() && Agros2D::problem()->setting()->value(ProblemSetting::View_DeformContour).toBool())
+        if (deform)
         {
             Hermes::Hermes2D::MagFilter<double> *filter = new Hermes::Hermes2D::MagFilter<double>(Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> >(activeMultiSolutionArray().solutions().at(0),
                                                                                                                                                                    activeMultiSolutionArray().solutions().at(1)));
@@ -205,62 +354,70 @@ void PostHermes::processRangeContour()
                 RectPoint rect = Agros2D::scene()->boundingBox();
                 double dmult = qMax(rect.width(), rect.height()) / filter->get_approx_max_value() / 15.0;
 
-                m_linContourView->set_displacement(activeMultiSolutionArray().solutions().at(0),
-                                                  activeMultiSolutionArray().solutions().at(1),
-                                                  dmult);
+                // own copies, the view is processed in the background
+                linearizer->set_displacement(Hermes::Hermes2D::MeshFunctionSharedPtr<double>(activeMultiSolutionArray().solutions().at(0)->clone()),
+                                             Hermes::Hermes2D::MeshFunctionSharedPtr<double>(activeMultiSolutionArray().solutions().at(1)->clone()),
+                                             dmult);
             }
             delete filter;
         }
         else
         {
-            m_linContourView->set_displacement(NULL, NULL);
+            linearizer->set_displacement(NULL, NULL);
         }
 
-        // process solution.
-        try
-        {
-            // m_linContourView.set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(2));
-            m_linContourView->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionAdaptive(Hermes::Hermes2D::Views::HERMES_EPS_VERYHIGH));
-            m_linContourView->process_solution(slnContourView, Hermes::Hermes2D::H2D_FN_VAL_0);
-        }
-        catch (Hermes::Exceptions::Exception& e)
-        {
-            delete m_linContourView;
-            m_linContourView = NULL;
+        // process solution
+        // linearizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(2));
+        linearizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionAdaptive(Hermes::Hermes2D::Views::HERMES_EPS_VERYHIGH));
 
-            Agros2D::log()->printError("Mesh View", QObject::tr("Linearizer (contour view) processing failed: %1").arg(e.what()));
-        }
+        addThread(new PostHermesThread(linearizer, slnContourView,
+                                       &m_linContourView, &m_contourKey, key,
+                                       "Mesh View", QObject::tr("Linearizer (contour view) processing failed: %1")));
+    }
+    else
+    {
+        releaseView(&m_linContourView, &m_contourKey);
     }
 }
 
-void PostHermes::processRangeScalar()
+QString PostHermes::scalarViewKey()
 {
     if ((Agros2D::problem()->isSolved()) && (m_activeViewField)
             && ((Agros2D::problem()->setting()->value(ProblemSetting::View_ShowScalarView).toBool())
                 || (((SceneViewPost3DMode) Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarView3DMode).toInt()) == SceneViewPost3DMode_ScalarView3D)))
     {
-        bool contains = false;
-        foreach (Module::LocalVariable variable, m_activeViewField->viewScalarVariables())
-        {
-            if (variable.id() == Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariable).toString())
-            {
-                contains = true;
-                break;
-            }
-        }
+        QString variableName = Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariable).toString();
+        PhysicFieldVariableComp comp = (PhysicFieldVariableComp) Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariableComp).toInt();
+        bool deform = m_activeViewField->hasDeformableShape() && Agros2D::problem()->setting()->value(ProblemSetting::View_DeformScalar).toBool();
 
-        Agros2D::log()->printMessage(tr("Post View"), tr("Scalar view (%1)").arg(Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariable).toString()));
+        FieldSolutionID fsid(activeViewField(), activeTimeStep(), activeAdaptivityStep(), activeAdaptivitySolutionType());
+        return QString("%1|%2|%3|%4").arg(fsid.toString()).arg(variableName).arg(comp).arg(deform);
+    }
 
-        Hermes::Hermes2D::MeshFunctionSharedPtr<double> slnScalarView = viewScalarFilter(m_activeViewField->localVariable(Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariable).toString()),
-                                                                                         (PhysicFieldVariableComp) Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariableComp).toInt());
+    return QString();
+}
+
+void PostHermes::processRangeScalar()
+{
+    QString key = scalarViewKey();
+    if (!key.isEmpty())
+    {
+        QString variableName = Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariable).toString();
+        PhysicFieldVariableComp comp = (PhysicFieldVariableComp) Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarVariableComp).toInt();
+        bool deform = m_activeViewField->hasDeformableShape() && Agros2D::problem()->setting()->value(ProblemSetting::View_DeformScalar).toBool();
+
+        if (m_linScalarView && (m_scalarKey == key))
+            return;
+
+        Agros2D::log()->printMessage(tr("Post View"), tr("Scalar view (%1)").arg(variableName));
+
+        Hermes::Hermes2D::MeshFunctionSharedPtr<double> slnScalarView = viewScalarFilter(m_activeViewField->localVariable(variableName), comp);
 
         // new linearizer
-        if (m_linScalarView)
-            delete m_linScalarView;
-        m_linScalarView = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
+        Hermes::Hermes2D::Views::Linearizer *linearizer = new Hermes::Hermes2D::Views::Linearizer(Hermes::Hermes2D::OpenGL);
 
         // deformed shape
-        if (m_activeViewField->hasDeformableShape() && Agros2D::problem()->setting()->value(ProblemSetting::View_DeformScalar).toBool())
+        if (deform)
         {
             Hermes::Hermes2D::MagFilter<double> *filter = new Hermes::Hermes2D::MagFilter<double>(Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> >(activeMultiSolutionArray().solutions().at(0),
                                                                                                                                                                    activeMultiSolutionArray().solutions().at(1)));
@@ -270,37 +427,29 @@ void PostHermes::processRangeScalar()
                 RectPoint rect = Agros2D::scene()->boundingBox();
                 double dmult = qMax(rect.width(), rect.height()) / filter->get_approx_max_value() / 15.0;
 
-                m_linScalarView->set_displacement(activeMultiSolutionArray().solutions().at(0),
-                                                  activeMultiSolutionArray().solutions().at(1),
-                                                  dmult);
+                // own copies, the view is processed in the background
+                linearizer->set_displacement(Hermes::Hermes2D::MeshFunctionSharedPtr<double>(activeMultiSolutionArray().solutions().at(0)->clone()),
+                                             Hermes::Hermes2D::MeshFunctionSharedPtr<double>(activeMultiSolutionArray().solutions().at(1)->clone()),
+                                             dmult);
             }
             delete filter;
         }
         else
         {
-            m_linScalarView->set_displacement(NULL, NULL);
+            linearizer->set_displacement(NULL, NULL);
         }
 
         // process solution
-        try
-        {
-            m_linScalarView->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionAdaptive(Hermes::Hermes2D::Views::HERMES_EPS_HIGH));
-            // m_linScalarView->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(2)); // 13x times slower
-            m_linScalarView->process_solution(slnScalarView, Hermes::Hermes2D::H2D_FN_VAL_0);
-
-            if (Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarRangeAuto).toBool())
-            {
-                Agros2D::problem()->setting()->setValue(ProblemSetting::View_ScalarRangeMin, m_linScalarView->get_min_value());
-                Agros2D::problem()->setting()->setValue(ProblemSetting::View_ScalarRangeMax, m_linScalarView->get_max_value());
-            }
-        }
-        catch (Hermes::Exceptions::Exception &e)
-        {
-            delete m_linScalarView;
-            m_linScalarView = NULL;
+        linearizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionAdaptive(Hermes::Hermes2D::Views::HERMES_EPS_HIGH));
+        // linearizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(2)); // 13x times slower
 
-            Agros2D::log()->printError("Mesh View", QObject::tr("Linearizer (scalar view) processing failed: %1").arg(e.what()));
-        }
+        addThread(new PostHermesThread(linearizer, slnScalarView,
+                                       &m_linScalarView, &m_scalarKey, key,
+                                       "Mesh View", QObject::tr("Linearizer (scalar view) processing failed: %1")));
+    }
+    else
+    {
+        releaseView(&m_linScalarView, &m_scalarKey);
     }
 }
 
@@ -308,31 +457,27 @@ void PostHermes::processRangeVector()
 {
     if ((Agros2D::problem()->isSolved()) && (m_activeViewField) && (Agros2D::problem()->setting()->value(ProblemSetting::View_ShowVectorView).toBool()))
     {
-        bool contains = false;
-        foreach (Module::LocalVariable variable, m_activeViewField->viewVectorVariables())
-        {
-            if (variable.id() == Agros2D::problem()->setting()->value(ProblemSetting::View_VectorVariable).toString())
-            {
-                contains = true;
-                break;
-            }
-        }
+        QString variableName = Agros2D::problem()->setting()->value(ProblemSetting::View_VectorVariable).toString();
+        bool deform = m_activeViewField->hasDeformableShape() && Agros2D::problem()->setting()->value(ProblemSetting::View_DeformVector).toBool();
 
-        Agros2D::log()->printMessage(tr("Post View"), tr("Vector view (%1)").arg(Agros2D::problem()->setting()->value(ProblemSetting::View_VectorVariable).toString()));
+        FieldSolutionID fsid(activeViewField(), activeTimeStep(), activeAdaptivityStep(), activeAdaptivitySolutionType());
+        QString key = QString("%1|%2|%3").arg(fsid.toString()).arg(variableName).arg(deform);
+        if (m_vecVectorView && (m_vectorKey == key))
+            return;
+
+        Agros2D::log()->printMessage(tr("Post View"), tr("Vector view (%1)").arg(variableName));
 
-        Hermes::Hermes2D::MeshFunctionSharedPtr<double> slnVectorXView = viewScalarFilter(m_activeViewField->localVariable(Agros2D::problem()->setting()->value(ProblemSetting::View_VectorVariable).toString()),
+        Hermes::Hermes2D::MeshFunctionSharedPtr<double> slnVectorXView = viewScalarFilter(m_activeViewField->localVariable(variableName),
                                                                                           PhysicFieldVariableComp_X);
 
-        Hermes::Hermes2D::MeshFunctionSharedPtr<double> slnVectorYView = viewScalarFilter(m_activeViewField->localVariable(Agros2D::problem()->setting()->value(ProblemSetting::View_VectorVariable).toString()),
+        Hermes::Hermes2D::MeshFunctionSharedPtr<double> slnVectorYView = viewScalarFilter(m_activeViewField->localVariable(variableName),
                                                                                           PhysicFieldVariableComp_Y);
 
         // new vectorizer
-        if (m_vecVectorView)
-            delete m_vecVectorView;
-        m_vecVectorView = new Hermes::Hermes2D::Views::Vectorizer(Hermes::Hermes2D::OpenGL);
+        Hermes::Hermes2D::Views::Vectorizer *vectorizer = new Hermes::Hermes2D::Views::Vectorizer(Hermes::Hermes2D::OpenGL);
 
         // deformed shape
-        if (m_activeViewField->hasDeformableShape() && Agros2D::problem()->setting()->value(ProblemSetting::View_DeformVector).toBool())
+        if (deform)
         {
             Hermes::Hermes2D::MagFilter<double> *filter = new Hermes::Hermes2D::MagFilter<double>(Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> >(activeMultiSolutionArray().solutions().at(0),
                                                                                                                                                                    activeMultiSolutionArray().solutions().at(1)));
@@ -341,34 +486,29 @@ void PostHermes::processRangeVector()
                 RectPoint rect = Agros2D::scene()->boundingBox();
                 double dmult = qMax(rect.width(), rect.height()) / filter->get_approx_max_value() / 15.0;
 
-                m_vecVectorView->set_displacement(activeMultiSolutionArray().solutions().at(0),
-                                                 activeMultiSolutionArray().solutions().at(1),
-                                                 dmult);
+                // own copies, the view is processed in the background
+                vectorizer->set_displacement(Hermes::Hermes2D::MeshFunctionSharedPtr<double>(activeMultiSolutionArray().solutions().at(0)->clone()),
+                                             Hermes::Hermes2D::MeshFunctionSharedPtr<double>(activeMultiSolutionArray().solutions().at(1)->clone()),
+                                             dmult);
             }
             delete filter;
         }
         else
         {
-            m_vecVectorView->set_displacement(NULL, NULL);
+            vectorizer->set_displacement(NULL, NULL);
         }
 
         // process solution
-        Hermes::Hermes2D::MeshFunctionSharedPtr<double> slns[2] = { slnVectorXView, slnVectorYView };
-        int items[2] = { Hermes::Hermes2D::H2D_FN_VAL_0, Hermes::Hermes2D::H2D_FN_VAL_0 };
-
-        try
-        {
-            m_vecVectorView->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionAdaptive(Hermes::Hermes2D::Views::HERMES_EPS_VERYHIGH));
-            // m_vecVectorView->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(2));
-            m_vecVectorView->process_solution(slns, items);
-        }
-        catch (Hermes::Exceptions::Exception &e)
-        {
-            delete m_vecVectorView;
-            m_vecVectorView = NULL;
+        vectorizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionAdaptive(Hermes::Hermes2D::Views::HERMES_EPS_VERYHIGH));
+        // vectorizer->set_criterion(Hermes::Hermes2D::Views::LinearizerCriterionFixed(2));
 
-            Agros2D::log()->printError("Mesh View", QObject::tr("Vectorizer processing failed: %1").arg(e.what()));
-        }
+        addThread(new PostHermesThread(vectorizer, slnVectorXView, slnVectorYView,
+                                       &m_vecVectorView, &m_vectorKey, key,
+                                       "Mesh View", QObject::tr("Vectorizer processing failed: %1")));
+    }
+    else
+    {
+        releaseView(&m_vecVectorView, &m_vectorKey);
     }
 }
 
@@ -376,44 +516,31 @@ void PostHermes::clearView()
 {
     m_isProcessed = false;
 
-    if (m_linInitialMeshView)
-    {
-        delete m_linInitialMeshView;
-        m_linInitialMeshView = NULL;
-    }
-    if (m_linSolutionMeshView)
-    {
-        delete m_linSolutionMeshView;
-        m_linSolutionMeshView = NULL;
-    }
-    if (m_orderView)
-    {
-        delete m_orderView;
-        m_orderView = NULL;
-    }
+    releaseView(&m_linInitialMeshView, &m_initialMeshKey);
+    releaseView(&m_linSolutionMeshView, &m_solutionMeshKey);
+    releaseView(&m_orderView, &m_orderKey);
 
-    if (m_linContourView)
-    {
-        delete m_linContourView;
-        m_linContourView = NULL;
-    }
-    if (m_linScalarView)
-    {
-        delete m_linScalarView;
-        m_linScalarView = NULL;
-    }
+    releaseView(&m_linContourView, &m_contourKey);
+    releaseView(&m_linScalarView, &m_scalarKey);
 
-    if (m_vecVectorView)
-    {
-        delete m_vecVectorView;
-        m_vecVectorView = NULL;
-    }
+    releaseView(&m_vecVectorView, &m_vectorKey);
 }
 
 void PostHermes::refresh()
 {
+    // events are processed while the views are computed, nested refresh is done afterwards
+    if (!m_threads.isEmpty())
+    {
+        m_isRefreshPending = true;
+        return;
+    }
+
     Agros2D::problem()->setIsPostprocessingRunning();
-    clearView();
+    m_isProcessed = false;
+
+    // views with unchanged input are kept (palette, camera, ...)
+    if (!Agros2D::problem()->isMeshed())
+        clearView();
 
     if (Agros2D::problem()->isMeshed())
         processMeshed();
@@ -421,14 +548,32 @@ void PostHermes::refresh()
     if (Agros2D::problem()->isSolved())
         processSolved();
 
+    runThreads();
+
+    // range of the shown scalar view of the current variable
+    QString scalarKey = scalarViewKey();
+    if (m_linScalarView && !scalarKey.isEmpty() && (m_scalarKey == scalarKey)
+            && Agros2D::problem()->setting()->value(ProblemSetting::View_ScalarRangeAuto).toBool())
+    {
+        Agros2D::problem()->setting()->setValue(ProblemSetting::View_ScalarRangeMin, m_linScalarView->get_min_value());
+        Agros2D::problem()->setting()->setValue(ProblemSetting::View_ScalarRangeMax, m_linScalarView->get_max_value());
+    }
+
     m_isProcessed = true;
     emit processed();
     Agros2D::problem()->setIsPostprocessingRunning(false);
+
+    if (m_isRefreshPending)
+    {
+        m_isRefreshPending = false;
+        refresh();
+    }
 }
 
 void PostHermes::clear()
 {
     clearView();
+    unpinActiveSolution();
 
     m_activeViewField = NULL;
     m_activeTimeStep = NOT_FOUND_SO_FAR;
@@ -438,6 +583,9 @@ void PostHermes::clear()
 
 void PostHermes::problemMeshed()
 {
+    // new mesh, cached views are not valid
+    clearView();
+
     if (!m_activeViewField)
     {
         setActiveViewField(Agros2D::problem()->fieldInfos().begin().value());
@@ -455,6 +603,9 @@ void PostHermes::problemMeshed()
 
 void PostHermes::problemSolved()
 {
+    // new solution, cached views are not valid
+    clearView();
+
     if (!m_activeViewField)
     {
         setActiveViewField(Agros2D::problem()->fieldInfos().begin().value());
@@ -489,6 +640,9 @@ void PostHermes::processSolved()
     FieldSolutionID fsid(activeViewField(), activeTimeStep(), activeAdaptivityStep(), activeAdaptivitySolutionType());
     if (Agros2D::solutionStore()->contains(fsid))
     {
+        // keep displayed solution in the cache
+        Agros2D::solutionStore()->setPinnedSolutions(QList<FieldSolutionID>() << fsid);
+
         MultiArray<double> ma = Agros2D::solutionStore()->multiArray(fsid);
         if (ma.spaces().empty())
             return;
@@ -542,6 +696,8 @@ void PostHermes::setActiveViewField(FieldInfo* fieldInfo)
     // check for different field
     if (previousActiveViewField != fieldInfo)
     {
+        unpinActiveSolution();
+
         setActiveTimeStep(NOT_FOUND_SO_FAR);
         setActiveAdaptivityStep(NOT_FOUND_SO_FAR);
         setActiveAdaptivitySolutionType(SolutionMode_Normal);
@@ -562,15 +718,35 @@ void PostHermes::setActiveViewField(FieldInfo* fieldInfo)
 
 void PostHermes::setActiveTimeStep(int ts)
 {
+    if (m_activeTimeStep != ts)
+        unpinActiveSolution();
+
     m_activeTimeStep = ts;
     Agros2D::problem()->setActualTimePostprocessing(Agros2D::problem()->timeStepToTime(ts));
 }
 
 void PostHermes::setActiveAdaptivityStep(int as)
 {
+    if (m_activeAdaptivityStep != as)
+        unpinActiveSolution();
+
     m_activeAdaptivityStep = as;
 }
 
+void PostHermes::setActiveAdaptivitySolutionType(SolutionMode st)
+{
+    if (m_activeSolutionMode != st)
+        unpinActiveSolution();
+
+    m_activeSolutionMode = st;
+}
+
+void PostHermes::unpinActiveSolution()
+{
+    // pinned again by processSolved()
+    Agros2D::solutionStore()->setPinnedSolutions(QList<FieldSolutionID>());
+}
+
 MultiArray<double> PostHermes::activeMultiSolutionArray()
 {
     FieldSolutionID fsid(activeViewField(), activeTimeStep(), activeAdaptivityStep(), activeAdaptivitySolutionType());
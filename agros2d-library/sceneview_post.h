@@ -28,6 +28,7 @@ template <typename Scalar> class MultiArray;
 
 class ParticleTracing;
 class FieldInfo;
+class PostHermesThread;
 
 class PostHermes : public QObject
 {
@@ -67,7 +68,7 @@ public:
     void setActiveAdaptivityStep(int as);
 
     inline SolutionMode activeAdaptivitySolutionType() const { return m_activeSolutionMode; }
-    void setActiveAdaptivitySolutionType(SolutionMode st) { m_activeSolutionMode = st; }
+    void setActiveAdaptivitySolutionType(SolutionMode st);
 
     MultiArray<double> activeMultiSolutionArray();
 
@@ -83,6 +84,25 @@ public slots:
 
 private:
     bool m_isProcessed;
+    bool m_isRefreshPending;
+
+    // views are computed in the background, results are assigned when all threads finish
+    QList<PostHermesThread *> m_threads;
+
+    // inputs of the current views (solution, variable, component, deformation)
+    // view is not recomputed if its input did not change
+    QString m_initialMeshKey;
+    QString m_solutionMeshKey;
+    QString m_orderKey;
+    QString m_contourKey;
+    QString m_scalarKey;
+    QString m_vectorKey;
+
+    void addThread(PostHermesThread *thread);
+    void runThreads();
+
+    // empty if the scalar view is not shown
+    QString scalarViewKey();
 
     // initial mesh
     Hermes::Hermes2D::Views::Linearizer *m_linInitialMeshView;
@@ -111,6 +131,8 @@ private:
 private slots:
     void processMeshed();
     void processSolved();
+    // displayed solution is not kept in the cache anymore
+    void unpinActiveSolution();
 
     void processInitialMesh();
     void processSolutionMesh();
@@ -54,13 +54,16 @@ void Config::load()
     dumpFormat = (Hermes::Algebra::MatrixExportFormat) settings.value("Solution/FormatMatrixAndRHS", EXPORT_FORMAT_PLAIN_ASCII).toInt();
 
     // cache size
-    cacheSize = settings.value("Solution/CacheSize", CACHE_SIZE).toInt();
+    cacheSize = settings.value("Solution/CacheSizeMB", CACHE_SIZE).toInt();
 
     // number of threads
     numberOfThreads = settings.value("Parallel/NumberOfThreads", omp_get_max_threads()).toInt();
     if (numberOfThreads > omp_get_max_threads())
         numberOfThreads = omp_get_max_threads();    
     Hermes::HermesCommonApi.set_integral_param_value(Hermes::numThreads, numberOfThreads);
+    numberOfParallelBlocks = settings.value("Parallel/NumberOfParallelBlocks", omp_get_max_threads()).toInt();
+    if (numberOfParallelBlocks > omp_get_max_threads())
+        numberOfParallelBlocks = omp_get_max_threads();
 }
 
 void Config::save()
@@ -81,9 +84,10 @@ void Config::save()
     settings.setValue("Solution/FormatMatrixAndRHS", dumpFormat);
 
     // cache size
-    settings.setValue("Solution/CacheSize", cacheSize);
+    settings.setValue("Solution/CacheSizeMB", cacheSize);
 
     // number of threads
     settings.setValue("Parallel/NumberOfThreads", numberOfThreads);
+    settings.setValue("Parallel/NumberOfParallelBlocks", numberOfParallelBlocks);
     Hermes::HermesCommonApi.set_integral_param_value(Hermes::numThreads, numberOfThreads);
 }
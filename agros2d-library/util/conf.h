@@ -43,11 +43,13 @@ public:
     bool saveMatrixRHS;
     Hermes::Algebra::MatrixExportFormat dumpFormat;
 
-    // cache
+    // cache (MB)
     int cacheSize;
 
     // number of threads
     int numberOfThreads;
+    // maximum number of independent blocks solved concurrently (threads are split between blocks)
+    int numberOfParallelBlocks;
 
     void load();
     void save();
@@ -61,8 +61,12 @@ const int PALETTESTEPSMAX = PALETTEENTRIES;
 // command argument
 const QString COMMANDS_BUILD_PLUGIN = "./agros2d_plugin_compiler.sh %1";
 
-// cache size
-const int CACHE_SIZE = 10;
+// cache size (MB)
+const int CACHE_SIZE = 512;
+const int CACHE_SIZE_MIN = 16;
+const int CACHE_SIZE_MAX = 65536;
+// maximum number of solutions waiting to be written to the disk
+const int SOLUTION_STORE_WRITE_QUEUE_SIZE = 4;
 
 // solver cache
 const bool USER_SOLVER_CACHE = false;
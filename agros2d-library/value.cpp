@@ -24,6 +24,7 @@
 #include "pythonlab/pythonengine_agros.h"
 #include "hermes2d/problem_config.h"
 #include "parser/lex.h"
+#include "parser/expression.h"
 
 Value::Value(double value)
     : m_isEvaluated(true), m_isTimeDependent(false), m_isCoordinateDependent(false), m_time(0.0), m_point(Point()), m_table(DataTable()), m_problem(Agros2D::problem())
@@ -87,6 +88,7 @@ Value& Value::operator =(const Value &origin)
     m_point = origin.m_point;
     m_isTimeDependent = origin.m_isTimeDependent;
     m_isCoordinateDependent = origin.m_isCoordinateDependent;
+    m_expression = origin.m_expression;
     m_table = origin.m_table;
 
     evaluateAndSave();
@@ -121,6 +123,11 @@ bool Value::hasTable() const
     return (!m_table.isEmpty());
 }
 
+bool Value::isUniform() const
+{
+    return (!m_isCoordinateDependent && !(m_problem->isNonlinear() && hasTable()));
+}
+
 bool Value::evaluateAtPoint(const Point &point)
 {
     m_point = point;
@@ -145,12 +152,6 @@ void Value::setNumber(double value)
     setText(QString::number(value));
 }
 
-double Value::number() const
-{
-    assert(m_isEvaluated);
-    return m_number;
-}
-
 double Value::numberAtPoint(const Point &point) const
 {
     double result;
@@ -181,6 +182,16 @@ double Value::numberAtTimeAndPoint(double time, const Point &point) const
     return result;
 }
 
+void Value::numberAtPoints(int n, const double *x, const double *y, double *result) const
+{
+    evaluate(0, n, x, y, result);
+}
+
+void Value::numberAtTimeAndPoints(double time, int n, const double *x, const double *y, double *result) const
+{
+    evaluate(time, n, x, y, result);
+}
+
 double Value::numberFromTable(double key) const
 {
     if (m_problem->isNonlinear() && hasTable())
@@ -215,6 +226,8 @@ void Value::setText(const QString &str)
     m_isTimeDependent = false;
     m_isCoordinateDependent = false;
 
+    m_expression.clear();
+
     LexicalAnalyser lex;
 
     // ToDo: Improve
@@ -247,6 +260,18 @@ void Value::setText(const QString &str)
         }
     }
 
+    // compile expression, variables are passed in order time, x (r), y (z)
+    QStringList variables;
+    variables << "time";
+    if (m_problem->config()->coordinateType() == CoordinateType_Planar)
+        variables << "x" << "y";
+    else
+        variables << "r" << "z";
+
+    CompiledExpression *expression = CompiledExpression::compile(m_text, variables);
+    if (expression)
+        m_expression = QSharedPointer<CompiledExpression>(expression);
+
     evaluateAndSave();
 }
 
@@ -290,6 +315,37 @@ bool Value::evaluate(double time, const Point &point, double& result) const
     return evaluateExpression(m_text, time, point, result);
 }
 
+void Value::evaluate(double time, int n, const double *x, const double *y, double *result) const
+{
+    // constant
+    if (m_isEvaluated && !m_isCoordinateDependent && !m_isTimeDependent)
+    {
+        for (int i = 0; i < n; i++)
+            result[i] = m_number;
+
+        return;
+    }
+
+    if (!m_expression.isNull())
+    {
+        const double *variables[3] = { &time, x, y };
+        const int increments[3] = { 0, 1, 1 };
+
+        if (m_expression->evaluate(n, variables, increments, result))
+            return;
+
+        // domain error - Python reports it
+        for (int i = 0; i < n; i++)
+            if (!std::isfinite(result[i]))
+                evaluate(time, Point(x[i], y[i]), result[i]);
+
+        return;
+    }
+
+    for (int i = 0; i < n; i++)
+        evaluate(time, Point(x[i], y[i]), result[i]);
+}
+
 bool Value::evaluateAndSave()
 {
     m_isEvaluated = false;
@@ -299,6 +355,16 @@ bool Value::evaluateAndSave()
 
 bool Value::evaluateExpression(const QString &expression, double time, const Point &point, double &evaluationResult) const
 {
+    // compiled expression (without Python, thread-safe)
+    if (!m_expression.isNull())
+    {
+        double variables[3] = { time, point.x, point.y };
+        if (m_expression->evaluate(variables, evaluationResult))
+            return true;
+
+        // domain error - Python reports it
+    }
+
     // speed up - int number
     bool isInt = false;
     double numInt = expression.toInt(&isInt);
@@ -29,6 +29,7 @@
 class DataTable;
 class FieldInfo;
 class Problem;
+class CompiledExpression;
 
 class AGROS_LIBRARY_API Value
 {
@@ -49,10 +50,13 @@ public:
 
     // expression
     void setNumber(double value);
-    double number() const;
+    inline double number() const { assert(m_isEvaluated); return m_number; }
     double numberAtPoint(const Point &point) const;
     double numberAtTime(double time) const;
     double numberAtTimeAndPoint(double time, const Point &point) const;
+    // evaluates n points (x[i], y[i]) at once, results are written to the array
+    void numberAtPoints(int n, const double *x, const double *y, double *result) const;
+    void numberAtTimeAndPoints(double time, int n, const double *x, const double *y, double *result) const;
 
     bool isNumber();
     inline bool isTimeDependent() const { return m_isTimeDependent; }
@@ -70,6 +74,8 @@ public:
     Hermes::Ord derivativeFromTable(Hermes::Ord ord) const;
 
     bool hasTable() const;
+    // value is the same in all points of the element (no space dependence, table not used in the actual problem)
+    bool isUniform() const;
 
     void setText(const QString &str);
     inline QString text() const { return m_text; }
@@ -93,11 +99,15 @@ private:
     bool m_isTimeDependent;
     bool m_isCoordinateDependent;
 
+    // compiled expression (NULL if expression has to be evaluated by Python)
+    QSharedPointer<CompiledExpression> m_expression;
+
     // table
     DataTable m_table;
 
     // evaluate
     bool evaluate(double time, const Point &point, double& result) const;
+    void evaluate(double time, int n, const double *x, const double *y, double *result) const;
     bool evaluateAndSave();
     bool evaluateExpression(const QString &expression, double time, const Point &point, double& evaluationResult) const ;
 
@@ -65,15 +65,23 @@ public:
 
     // local values
     virtual LocalValue *localValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType, const Point &point) { assert(0); return NULL; }
+    virtual LocalValue *localValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType, const QList<Point> &points) { assert(0); return NULL; }
     // surface integrals
     virtual IntegralValue *surfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType) { assert(0); return NULL; }
+    virtual IntegralValue *surfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                           const QList<QList<int> > &edges) { assert(0); return NULL; }
     // volume integrals
     virtual IntegralValue *volumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType) { assert(0); return NULL; }
+    virtual IntegralValue *volumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                          const QList<QList<int> > &labels) { assert(0); return NULL; }
 
     // force calculation
     virtual Point3 force(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
                          Hermes::Hermes2D::Element *element, SceneMaterial *material,
                          const Point3 &point, const Point3 &velocity) { assert(0); return Point3(); }
+    virtual Point3 force(const FieldInfo *fieldInfo, int timeStep, const Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > &solutions,
+                         Hermes::Hermes2D::Element *element, SceneMaterial *material,
+                         const Point3 &point, const Point3 &velocity) { assert(0); return Point3(); }
     virtual bool hasForce(const FieldInfo *fieldInfo) { return false; }
 
     // localization
@@ -44,6 +44,9 @@ public:
 
         {{#VARIABLE_SOURCE}}
         const Value *{{VARIABLE_SHORT}} = material->valueNakedPtr(QLatin1String("{{VARIABLE}}"));{{/VARIABLE_SOURCE}}
+        {{#POINT_VALUE}}
+        QVarLengthArray<double, 64> {{VARIABLE_SHORT}}_values(n);
+        {{VARIABLE_SHORT}}->{{POINT_VALUE_METHOD}}n, e->x, e->y, {{VARIABLE_SHORT}}_values.data());{{/POINT_VALUE}}
 
         Scalar result = Scalar(0);
         for (int i = 0; i < n; i++)
@@ -45,16 +45,9 @@ bool hasForce{{CLASS}}(const FieldInfo *fieldInfo)
 Point3 force{{CLASS}}(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
                       Hermes::Hermes2D::Element *element, SceneMaterial *material, const Point3 &point, const Point3 &velocity)
 {
-    int numberOfSolutions = fieldInfo->numberOfSolutions();
-
     FieldSolutionID fsid(fieldInfo, timeStep, adaptivityStep, solutionType);
     MultiArray<double> ma = Agros2D::solutionStore()->multiArray(fsid);
 
-    {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = material->valueNakedPtr(QLatin1String("{{MATERIAL_VARIABLE}}"));
-    {{/VARIABLE_MATERIAL}}
-
-    Point3 res;
-
     if (Agros2D::problem()->isSolved())
     {
         // update time functions
@@ -63,31 +56,39 @@ Point3 force{{CLASS}}(const FieldInfo *fieldInfo, int timeStep, int adaptivitySt
             QList<double> timeLevels = Agros2D::solutionStore()->timeLevels(fieldInfo);
             Module::updateTimeFunctions(timeLevels[timeStep]);
         }
+    }
+
+    return force{{CLASS}}(fieldInfo, timeStep, ma.solutions(), element, material, point, velocity);
+}
 
+Point3 force{{CLASS}}(const FieldInfo *fieldInfo, int timeStep, const Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > &solutions,
+                      Hermes::Hermes2D::Element *element, SceneMaterial *material, const Point3 &point, const Point3 &velocity)
+{
+    int numberOfSolutions = fieldInfo->numberOfSolutions();
+
+    {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = material->valueNakedPtr(QLatin1String("{{MATERIAL_VARIABLE}}"));
+    {{/VARIABLE_MATERIAL}}
+
+    Point3 res;
+
+    if (Agros2D::problem()->isSolved())
+    {
         // set variables
         double x = point.x;
         double y = point.y;
 
-        double *value = new double[numberOfSolutions];
-        double *dudx = new double[numberOfSolutions];
-        double *dudy = new double[numberOfSolutions];
+        // scratch on the stack, no allocation per call
+        QVarLengthArray<double, 8> value(numberOfSolutions);
+        QVarLengthArray<double, 8> dudx(numberOfSolutions);
+        QVarLengthArray<double, 8> dudy(numberOfSolutions);
 
         for (int k = 0; k < numberOfSolutions; k++)
         {
             // point values
-            // point values
-            Hermes::Hermes2D::Func<double> *values = ma.solutions().at(k)->get_pt_value(point.x, point.y, true, element);
+            Hermes::Hermes2D::Func<double> *values = solutions.at(k)->get_pt_value(point.x, point.y, true, element);
             if (!values)
-            {
                 throw AgrosException(QObject::tr("Point [%1, %2] does not lie in any element").arg(x).arg(y));
 
-                delete [] value;
-                delete [] dudx;
-                delete [] dudy;
-
-                return res;
-            }
-
             double val;
             if ((fieldInfo->analysisType() == AnalysisType_Transient) && timeStep == 0)
                 // const solution at first time step
@@ -100,8 +101,6 @@ Point3 force{{CLASS}}(const FieldInfo *fieldInfo, int timeStep, int adaptivitySt
             dudx[k] = values->dx[0];
             dudy[k] = values->dy[0];
 
-            // values->free_fn();
-            // values->free_ord();
             delete values;
         }
 
@@ -114,10 +113,6 @@ Point3 force{{CLASS}}(const FieldInfo *fieldInfo, int timeStep, int adaptivitySt
             res.z = {{EXPRESSION_Z}};
         }
         {{/VARIABLE_SOURCE}}
-
-        delete [] value;
-        delete [] dudx;
-        delete [] dudy;
     }
 
     return res;
@@ -30,6 +30,8 @@ bool hasForce{{CLASS}}(const FieldInfo *fieldInfo);
 
 Point3 force{{CLASS}}(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
                       Hermes::Hermes2D::Element *element, SceneMaterial *material, const Point3 &point, const Point3 &velocity = Point3());
+Point3 force{{CLASS}}(const FieldInfo *fieldInfo, int timeStep, const Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > &solutions,
+                      Hermes::Hermes2D::Element *element, SceneMaterial *material, const Point3 &point, const Point3 &velocity = Point3());
 
 
 #endif // {{ID}}_FORCE_H
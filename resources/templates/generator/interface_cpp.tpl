@@ -157,16 +157,33 @@ LocalValue *{{CLASS}}Interface::localValue(const FieldInfo *fieldInfo, int timeS
     return new {{CLASS}}LocalValue(fieldInfo, timeStep, adaptivityStep, solutionType, point);
 }
 
+LocalValue *{{CLASS}}Interface::localValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType, const QList<Point> &points)
+{
+    return new {{CLASS}}LocalValue(fieldInfo, timeStep, adaptivityStep, solutionType, points);
+}
+
 IntegralValue *{{CLASS}}Interface::surfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType)
 {
     return new {{CLASS}}SurfaceIntegral(fieldInfo, timeStep, adaptivityStep, solutionType);
 }
 
+IntegralValue *{{CLASS}}Interface::surfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                                   const QList<QList<int> > &edges)
+{
+    return new {{CLASS}}SurfaceIntegral(fieldInfo, timeStep, adaptivityStep, solutionType, edges);
+}
+
 IntegralValue *{{CLASS}}Interface::volumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType)
 {
     return new {{CLASS}}VolumeIntegral(fieldInfo, timeStep, adaptivityStep, solutionType);
 }
 
+IntegralValue *{{CLASS}}Interface::volumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                                  const QList<QList<int> > &labels)
+{
+    return new {{CLASS}}VolumeIntegral(fieldInfo, timeStep, adaptivityStep, solutionType, labels);
+}
+
 Point3 {{CLASS}}Interface::force(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
                                  Hermes::Hermes2D::Element *element, SceneMaterial *material,
                                  const Point3 &point, const Point3 &velocity)
@@ -174,6 +191,13 @@ Point3 {{CLASS}}Interface::force(const FieldInfo *fieldInfo, int timeStep, int a
     return force{{CLASS}}(fieldInfo, timeStep, adaptivityStep, solutionType, element, material, point, velocity);
 }
 
+Point3 {{CLASS}}Interface::force(const FieldInfo *fieldInfo, int timeStep, const Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > &solutions,
+                                 Hermes::Hermes2D::Element *element, SceneMaterial *material,
+                                 const Point3 &point, const Point3 &velocity)
+{
+    return force{{CLASS}}(fieldInfo, timeStep, solutions, element, material, point, velocity);
+}
+
 bool {{CLASS}}Interface::hasForce(const FieldInfo *fieldInfo)
 {
     return hasForce{{CLASS}}(fieldInfo);
@@ -31,6 +31,8 @@
 
 #include "hermes2d/plugin_interface.h"
 
+#include "particle/mesh_hash.h"
+
 {{CLASS}}LocalValue::{{CLASS}}LocalValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
                                          const Point &point)
     : LocalValue(fieldInfo, timeStep, adaptivityStep, solutionType, point)
@@ -38,11 +40,21 @@
     calculate();
 }
 
+{{CLASS}}LocalValue::{{CLASS}}LocalValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                         const QList<Point> &points)
+    : LocalValue(fieldInfo, timeStep, adaptivityStep, solutionType, points)
+{
+    calculate();
+}
+
 void {{CLASS}}LocalValue::calculate()
 {
     int numberOfSolutions = m_fieldInfo->numberOfSolutions();
 
     m_values.clear();
+    m_pointValues.clear();
+    for (int i = 0; i < m_points.size(); i++)
+        m_pointValues.append(QMap<QString, LocalPointValue>());
 
     FieldSolutionID fsid(m_fieldInfo, m_timeStep, m_adaptivityStep, m_solutionType);
     MultiArray<double> ma = Agros2D::solutionStore()->multiArray(fsid);
@@ -55,36 +67,107 @@ void {{CLASS}}LocalValue::calculate()
 
     if (Agros2D::problem()->isSolved())
     {
-        double x = m_point.x;
-        double y = m_point.y;
-
-        Hermes::Hermes2D::Element *e = Hermes::Hermes2D::RefMap::element_on_physical_coordinates(false, m_fieldInfo->initialMesh(),
-                                                                                                 m_point.x, m_point.y);
-        if (e)
+        bool isInitialCondition = ((m_fieldInfo->analysisType() == AnalysisType_Transient) && m_timeStep == 0);
+
+        // materials indexed by the element marker, resolved once for all points
+        int num = Agros2D::scene()->labels->count();
+        QVector<SceneMaterial *> materials(num + 1, NULL);
+        {{#VARIABLE_MATERIAL}}QVector<const Value *> materials_{{MATERIAL_VARIABLE}}(num + 1, NULL);
+        {{/VARIABLE_MATERIAL}}
+        for (int labelNum = 0; labelNum < num; labelNum++)
         {
-            // find marker
-            SceneLabel *label = Agros2D::scene()->labels->at(atoi(m_fieldInfo->initialMesh()->get_element_markers_conversion().get_user_marker(e->marker).marker.c_str()));
-            SceneMaterial *material = label->marker(m_fieldInfo);
+            SceneLabel *label = Agros2D::scene()->labels->at(labelNum);
+            if (!label->hasMarker(m_fieldInfo) || label->marker(m_fieldInfo)->isNone())
+                continue;
 
-            int elementMarker = e->marker;
+            Hermes::Hermes2D::Mesh::MarkersConversion::IntValid marker = m_fieldInfo->initialMesh()->get_element_markers_conversion().get_internal_marker(QString::number(labelNum).toStdString());
+            if (!marker.valid)
+                continue;
+            assert(marker.marker <= num);
 
-            {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = material->valueNakedPtr(QLatin1String("{{MATERIAL_VARIABLE}}"));
+            materials[marker.marker] = label->marker(m_fieldInfo);
+            {{#VARIABLE_MATERIAL}}materials_{{MATERIAL_VARIABLE}}[marker.marker] = materials[marker.marker]->valueNakedPtr(QLatin1String("{{MATERIAL_VARIABLE}}"));
             {{/VARIABLE_MATERIAL}}
-            {{#SPECIAL_FUNCTION_SOURCE}}
-            QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}> {{SPECIAL_FUNCTION_NAME}};
-            if(m_fieldInfo->functionUsedInAnalysis("{{SPECIAL_FUNCTION_ID}}"))
-                {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));
-            {{/SPECIAL_FUNCTION_SOURCE}}
+        }
 
-            double *value = new double[numberOfSolutions];
-            double *dudx = new double[numberOfSolutions];
-            double *dudy = new double[numberOfSolutions];
+        {{#SPECIAL_FUNCTION_SOURCE}}
+        QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}> {{SPECIAL_FUNCTION_NAME}};
+        if(m_fieldInfo->functionUsedInAnalysis("{{SPECIAL_FUNCTION_ID}}"))
+            {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));
+        {{/SPECIAL_FUNCTION_SOURCE}}
 
-            for (int k = 0; k < numberOfSolutions; k++)
+        // components share the mesh in most cases, elements are located once per distinct mesh
+        QList<Hermes::Hermes2D::MeshSharedPtr> meshes;
+        QVarLengthArray<int, 8> meshIndex(numberOfSolutions);
+        for (int k = 0; k < numberOfSolutions; k++)
+        {
+            Hermes::Hermes2D::MeshSharedPtr mesh = ma.solutions().at(k)->get_mesh();
+
+            meshIndex[k] = -1;
+            for (int m = 0; m < meshes.size(); m++)
+                if (meshes[m].get() == mesh.get())
+                    meshIndex[k] = m;
+
+            if (meshIndex[k] == -1)
+            {
+                meshes.append(mesh);
+                meshIndex[k] = meshes.size() - 1;
+            }
+        }
+
+        // more points are located by the mesh hash walking from the element of the previous point
+        // (hash is shared by the subsequent batched calls on the same mesh), single point uses the hash grid of the mesh
+        QList<QSharedPointer<MeshHash> > meshHashes;
+        if (m_points.size() > 1)
+            for (int m = 0; m < meshes.size(); m++)
+                meshHashes.append(MeshHash::meshHash(meshes[m]));
+
+        // last found elements, neighbouring points often lie in the same element
+        QVarLengthArray<Hermes::Hermes2D::Element *, 8> elements(meshes.size());
+        for (int m = 0; m < meshes.size(); m++)
+            elements[m] = NULL;
+
+        // scratch on the stack, no allocation per point
+        QVarLengthArray<double, 8> value(numberOfSolutions);
+        QVarLengthArray<double, 8> dudx(numberOfSolutions);
+        QVarLengthArray<double, 8> dudy(numberOfSolutions);
+
+        for (int i = 0; i < m_points.size(); i++)
+        {
+            double x = m_points[i].x;
+            double y = m_points[i].y;
+
+            bool isInside = true;
+            for (int m = 0; m < meshes.size(); m++)
             {
-                if ((m_fieldInfo->analysisType() == AnalysisType_Transient) && m_timeStep == 0)
+                if (!meshHashes.isEmpty())
+                    elements[m] = meshHashes[m]->getElement(x, y, elements[m]);
+                else
+                    elements[m] = Hermes::Hermes2D::RefMap::element_on_physical_coordinates(true, meshes[m], x, y);
+
+                if (!elements[m])
                 {
+                    isInside = false;
+                    break;
+                }
+            }
+
+            if (!isInside)
+                continue;
 
+            // find marker
+            int elementMarker = elements[0]->marker;
+            SceneMaterial *material = materials[elementMarker];
+            if (!material)
+                continue;
+
+            {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = materials_{{MATERIAL_VARIABLE}}[elementMarker];
+            {{/VARIABLE_MATERIAL}}
+
+            for (int k = 0; k < numberOfSolutions; k++)
+            {
+                if (isInitialCondition)
+                {
                     // set variables
                     value[k] = m_fieldInfo->value(FieldInfo::TransientInitialCondition).toDouble();
                     dudx[k] = 0;
@@ -92,30 +175,28 @@ void {{CLASS}}LocalValue::calculate()
                 }
                 else
                 {
-                    // point values
-                    Hermes::Hermes2D::Func<double> *values = ma.solutions().at(k)->get_pt_value(m_point.x, m_point.y, true);
+                    // point values, element is already known
+                    Hermes::Hermes2D::Func<double> *values = ma.solutions().at(k)->get_pt_value(x, y, true, elements[meshIndex[k]]);
 
                     // set variables
                     value[k] = values->val[0];
                     dudx[k] = values->dx[0];
                     dudy[k] = values->dy[0];
 
-                    // values->free_fn();
-                    // values->free_ord();
                     delete values;
                 }
             }
 
             // expressions
+            QMap<QString, LocalPointValue> &pointValues = m_pointValues[i];
             {{#VARIABLE_SOURCE}}
             if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}})
                     && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
-                m_values[QLatin1String("{{VARIABLE}}")] = LocalPointValue({{EXPRESSION_SCALAR}}, Point({{EXPRESSION_VECTORX}}, {{EXPRESSION_VECTORY}}), material);
+                pointValues[QLatin1String("{{VARIABLE}}")] = LocalPointValue({{EXPRESSION_SCALAR}}, Point({{EXPRESSION_VECTORX}}, {{EXPRESSION_VECTORY}}), material);
             {{/VARIABLE_SOURCE}}
-
-            delete [] value;
-            delete [] dudx;
-            delete [] dudy;
         }
+
+        if (!m_pointValues.isEmpty())
+            m_values = m_pointValues.first();
     }
 }
@@ -34,6 +34,8 @@ class {{CLASS}}LocalValue : public LocalValue
 public:
     {{CLASS}}LocalValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
                         const Point &point);
+    {{CLASS}}LocalValue(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                        const QList<Point> &points);
 
     void calculate();
 };
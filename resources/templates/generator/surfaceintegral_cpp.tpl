@@ -34,30 +34,33 @@
 class {{CLASS}}SurfaceIntegralCalculator : public Hermes::Hermes2D::PostProcessing::SurfaceIntegralCalculator<double>
 {
 public:
-    {{CLASS}}SurfaceIntegralCalculator(const FieldInfo *fieldInfo, Hermes::Hermes2D::MeshFunctionSharedPtr<double> source_function, int number_of_integrals)
-        : Hermes::Hermes2D::PostProcessing::SurfaceIntegralCalculator<double>(source_function, number_of_integrals), m_fieldInfo(fieldInfo)
+    {{CLASS}}SurfaceIntegralCalculator(const FieldInfo *fieldInfo, Hermes::Hermes2D::MeshFunctionSharedPtr<double> source_function, const QList<int> &edges)
+        : Hermes::Hermes2D::PostProcessing::SurfaceIntegralCalculator<double>(source_function, {{INTEGRAL_COUNT}} * edges.count()), m_fieldInfo(fieldInfo)
     {
+        initMarkerTables(edges);
     }
 
-    {{CLASS}}SurfaceIntegralCalculator(const FieldInfo *fieldInfo, Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > source_functions, int number_of_integrals)
-        : Hermes::Hermes2D::PostProcessing::SurfaceIntegralCalculator<double>(source_functions, number_of_integrals), m_fieldInfo(fieldInfo)
+    {{CLASS}}SurfaceIntegralCalculator(const FieldInfo *fieldInfo, Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > source_functions, const QList<int> &edges)
+        : Hermes::Hermes2D::PostProcessing::SurfaceIntegralCalculator<double>(source_functions, {{INTEGRAL_COUNT}} * edges.count()), m_fieldInfo(fieldInfo)
     {
+        initMarkerTables(edges);
     }
 
     virtual void integral(int n, double* wt, Hermes::Hermes2D::Func<double> **fns, Hermes::Hermes2D::Geom<double> *e, double* result)
     {
-        SceneLabel *label = Agros2D::scene()->labels->at(atoi(m_fieldInfo->initialMesh()->get_element_markers_conversion().get_user_marker(e->elem_marker).marker.c_str()));
-        SceneMaterial *material = label->marker(m_fieldInfo);
-
         double *x = e->x;
         double *y = e->y;
 
-        {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = material->valueNakedPtr(QLatin1String("{{MATERIAL_VARIABLE}}"));
+        int labelIndex = m_fieldInfo->hermesMarkerToAgrosLabel(e->elem_marker);
+        {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = m_material_{{MATERIAL_VARIABLE}} ? m_material_{{MATERIAL_VARIABLE}}[labelIndex] : NULL;
         {{/VARIABLE_MATERIAL}}
+        // partial sums of the edge
+        double *edgeResult = result + m_markerSlot[e->edge_marker] * {{INTEGRAL_COUNT}};
 
-        double **value = new double*[source_functions.size()];
-        double **dudx = new double*[source_functions.size()];
-        double **dudy = new double*[source_functions.size()];
+        // scratch on the stack, no allocation per element
+        QVarLengthArray<double *, 8> value(source_functions.size());
+        QVarLengthArray<double *, 8> dudx(source_functions.size());
+        QVarLengthArray<double *, 8> dudy(source_functions.size());
 
         for (int i = 0; i < source_functions.size(); i++)
         {
@@ -71,26 +74,52 @@ public:
         if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
         {
             for (int i = 0; i < n; i++)
-                result[{{POSITION}}] += wt[i] * ({{EXPRESSION}});
+                edgeResult[{{POSITION}}] += wt[i] * ({{EXPRESSION}});
         }
         {{/VARIABLE_SOURCE}}
-
-        delete [] value;
-        delete [] dudx;
-        delete [] dudy;
     }
 
     virtual void order(Hermes::Hermes2D::Func<Hermes::Ord> **fns, Hermes::Ord* result)
     {
         {{#VARIABLE_SOURCE}}
         if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
-            result[{{POSITION}}] = Hermes::Ord(20);
+            result[{{POSITION}}] = {{EXPRESSION_ORDER}};
         {{/VARIABLE_SOURCE}}
+
+        // the order does not depend on the edge
+        for (int slot = 1; slot < m_slotsCount; slot++)
+            for (int i = 0; i < {{INTEGRAL_COUNT}}; i++)
+                result[slot * {{INTEGRAL_COUNT}} + i] = result[i];
     }
 
 private:
     // field info
     const FieldInfo *m_fieldInfo;
+
+    // material values of the labels (tables of the field, indexed by the label)
+    {{#VARIABLE_MATERIAL}}const Value **m_material_{{MATERIAL_VARIABLE}};
+    {{/VARIABLE_MATERIAL}}
+    // boundary marker -> slot (integrals of every integrated edge are stored separately, number_of_integrals = count * edges)
+    QVector<int> m_markerSlot;
+    int m_slotsCount;
+
+    void initMarkerTables(const QList<int> &edges)
+    {
+        {{#VARIABLE_MATERIAL}}m_material_{{MATERIAL_VARIABLE}} = m_fieldInfo->hasValuePointerTable(QLatin1String("{{MATERIAL_VARIABLE}}")) ? m_fieldInfo->valuePointerTable(QLatin1String("{{MATERIAL_VARIABLE}}")) : NULL;
+        {{/VARIABLE_MATERIAL}}
+
+        m_slotsCount = edges.count();
+        for (int i = 0; i < edges.count(); i++)
+        {
+            Hermes::Hermes2D::Mesh::MarkersConversion::IntValid marker = m_fieldInfo->initialMesh()->get_boundary_markers_conversion().get_internal_marker(QString::number(edges[i]).toStdString());
+            if (!marker.valid)
+                continue;
+
+            while (marker.marker >= m_markerSlot.size())
+                m_markerSlot.append(-1);
+            m_markerSlot[marker.marker] = i;
+        }
+    }
 };
 
 {{CLASS}}SurfaceIntegral::{{CLASS}}SurfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType)
@@ -99,10 +128,33 @@ private:
     calculate();
 }
 
+{{CLASS}}SurfaceIntegral::{{CLASS}}SurfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                                   const QList<QList<int> > &regions)
+    : IntegralValue(fieldInfo, timeStep, adaptivityStep, solutionType)
+{
+    calculate(regions);
+}
+
 void {{CLASS}}SurfaceIntegral::calculate()
 {
     m_values.clear();
 
+    // selected edges
+    QList<int> edges;
+    for (int i = 0; i < Agros2D::scene()->edges->count(); i++)
+        if (Agros2D::scene()->edges->at(i)->isSelected())
+            edges.append(i);
+
+    calculate(QList<QList<int> >() << edges);
+    m_values = m_regionValues.first();
+}
+
+void {{CLASS}}SurfaceIntegral::calculate(const QList<QList<int> > &regions)
+{
+    m_regionValues.clear();
+    for (int i = 0; i < regions.size(); i++)
+        m_regionValues.append(QMap<QString, double>());
+
     FieldSolutionID fsid(m_fieldInfo, m_timeStep, m_adaptivityStep, m_solutionType);
     MultiArray<double> ma = Agros2D::solutionStore()->multiArray(fsid);
 
@@ -115,33 +167,56 @@ void {{CLASS}}SurfaceIntegral::calculate()
             Module::updateTimeFunctions(timeLevels[m_timeStep]);
         }
 
-        Hermes::vector<std::string> boundaryMarkers;
-        Hermes::vector<std::string> internalMarkers;
-        for (int i = 0; i < Agros2D::scene()->edges->count(); i++)
+        int edgesCount = Agros2D::scene()->edges->count();
+
+        // edges of all regions are integrated in one pass
+        QSet<int> edgesSet;
+        foreach (QList<int> region, regions)
+            foreach (int edge, region)
+                edgesSet.insert(edge);
+
+        QList<int> edges = edgesSet.toList();
+        qSort(edges);
+
+        Hermes::vector<std::string> markers;
+        foreach (int edge, edges)
+            markers.push_back(QString::number(edge).toStdString());
+
+        if (markers.size() > 0)
         {
-            SceneEdge *edge = Agros2D::scene()->edges->at(i);
-            if (edge->isSelected())
+            // only the requested edges have their partial sums
+            {{CLASS}}SurfaceIntegralCalculator calc(m_fieldInfo, ma.solutions(), edges);
+            double *values = calc.calculate(markers);
+
+            // slots of the edges, internal edges are integrated from both sides
+            QVector<int> edgeSlot(edgesCount, -1);
+            QVector<double> edgeCoefficient(edgesCount, 1.0);
+            for (int j = 0; j < edges.count(); j++)
             {
-                if (edge->marker(m_fieldInfo)->isNone())
-                    internalMarkers.push_back(QString::number(i).toStdString());
-                else
-                    boundaryMarkers.push_back(QString::number(i).toStdString());
+                edgeSlot[edges[j]] = j;
+                edgeCoefficient[edges[j]] = Agros2D::scene()->edges->at(edges[j])->marker(m_fieldInfo)->isNone() ? 0.5 : 1.0;
             }
-        }
 
-        if (internalMarkers.size() > 0 || boundaryMarkers.size() > 0)
-        {
-            {{CLASS}}SurfaceIntegralCalculator calc(m_fieldInfo, ma.solutions(), {{INTEGRAL_COUNT}});
-            double *internalValues = calc.calculate(internalMarkers);
-            double *boundaryValues = calc.calculate(boundaryMarkers);
-
-            {{#VARIABLE_SOURCE}}
-            if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
-                m_values[QLatin1String("{{VARIABLE}}")] = 0.5 * internalValues[{{POSITION}}] + boundaryValues[{{POSITION}}];
-            {{/VARIABLE_SOURCE}}
+            // sum of the partial integrals of the edges
+            for (int i = 0; i < regions.size(); i++)
+            {
+                if (regions[i].isEmpty())
+                    continue;
+
+                QSet<int> regionEdges = regions[i].toSet();
+
+                {{#VARIABLE_SOURCE}}
+                if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
+                {
+                    double value = 0.0;
+                    foreach (int edge, regionEdges)
+                        value += edgeCoefficient[edge] * values[edgeSlot[edge] * {{INTEGRAL_COUNT}} + {{POSITION}}];
+                    m_regionValues[i][QLatin1String("{{VARIABLE}}")] = value;
+                }
+                {{/VARIABLE_SOURCE}}
+            }
 
-            ::free(internalValues);
-            ::free(boundaryValues);
+            ::free(values);
         }
     }
 }
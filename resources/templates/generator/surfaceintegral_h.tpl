@@ -32,9 +32,14 @@ class FieldInfo;
 class {{CLASS}}SurfaceIntegral : public IntegralValue
 {
 public:
+    // integrals over the selected edges
     {{CLASS}}SurfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType);
+    // integrals over the regions (sets of edges)
+    {{CLASS}}SurfaceIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                             const QList<QList<int> > &regions);
 
     void calculate();
+    void calculate(const QList<QList<int> > &regions);
 };
 
 #endif // {{ID}}_SURFACEINTEGRAL_H
@@ -37,6 +37,7 @@ public:
     {{CLASS}}VolumetricIntegralEggShellCalculator(const FieldInfo *fieldInfo, Hermes::Hermes2D::MeshFunctionSharedPtr<double> source_function, int number_of_integrals)
         : Hermes::Hermes2D::PostProcessing::VolumetricIntegralCalculator<double>(source_function, number_of_integrals), m_fieldInfo(fieldInfo)
     {
+        initMarkerTables();
         {{#SPECIAL_FUNCTION_SOURCE}}
         {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));{{/SPECIAL_FUNCTION_SOURCE}}
     }
@@ -44,19 +45,18 @@ public:
     {{CLASS}}VolumetricIntegralEggShellCalculator(const FieldInfo *fieldInfo, Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > source_functions, int number_of_integrals)
         : Hermes::Hermes2D::PostProcessing::VolumetricIntegralCalculator<double>(source_functions, number_of_integrals), m_fieldInfo(fieldInfo)
     {
+        initMarkerTables();
         {{#SPECIAL_FUNCTION_SOURCE}}
         {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));{{/SPECIAL_FUNCTION_SOURCE}}
     }
 
     virtual void integral(int n, double* wt, Hermes::Hermes2D::Func<double> **fns, Hermes::Hermes2D::Geom<double> *e, double* result)
     {
-        SceneLabel *label = Agros2D::scene()->labels->at(atoi(m_fieldInfo->initialMesh()->get_element_markers_conversion().get_user_marker(e->elem_marker).marker.c_str()));
-        SceneMaterial *material = label->marker(m_fieldInfo);
-
         double *x = e->x;
         double *y = e->y;
 
-        {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = material->valueNakedPtr(QLatin1String("{{MATERIAL_VARIABLE}}"));
+        int labelIndex = m_fieldInfo->hermesMarkerToAgrosLabel(e->elem_marker);
+        {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = m_material_{{MATERIAL_VARIABLE}} ? m_material_{{MATERIAL_VARIABLE}}[labelIndex] : NULL;
         {{/VARIABLE_MATERIAL}}
         // {{#SPECIAL_FUNCTION_SOURCE}}
         // QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}> {{SPECIAL_FUNCTION_NAME}};
@@ -64,9 +64,10 @@ public:
         //     {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));
         // {{/SPECIAL_FUNCTION_SOURCE}}
 
-        double **value = new double*[source_functions.size()];
-        double **dudx = new double*[source_functions.size()];
-        double **dudy = new double*[source_functions.size()];
+        // scratch on the stack, no allocation per element
+        QVarLengthArray<double *, 8> value(source_functions.size());
+        QVarLengthArray<double *, 8> dudx(source_functions.size());
+        QVarLengthArray<double *, 8> dudy(source_functions.size());
 
         for (int i = 0; i < source_functions.size(); i++)
         {
@@ -83,17 +84,13 @@ public:
                 result[{{POSITION}}] += wt[i] * ({{EXPRESSION}});
         }
         {{/VARIABLE_SOURCE_EGGSHELL}}
-
-        delete [] value;
-        delete [] dudx;
-        delete [] dudy;
     }
 
     virtual void order(Hermes::Hermes2D::Func<Hermes::Ord> **fns, Hermes::Ord* result)
     {
         {{#VARIABLE_SOURCE_EGGSHELL}}
         if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
-            result[{{POSITION}}] = Hermes::Ord(20);
+            result[{{POSITION}}] = {{EXPRESSION_ORDER}};
         {{/VARIABLE_SOURCE_EGGSHELL}}
     }
 
@@ -101,6 +98,16 @@ private:
     // field info
     const FieldInfo *m_fieldInfo;
 
+    // material values of the labels (tables of the field, indexed by the label)
+    {{#VARIABLE_MATERIAL}}const Value **m_material_{{MATERIAL_VARIABLE}};
+    {{/VARIABLE_MATERIAL}}
+
+    void initMarkerTables()
+    {
+        {{#VARIABLE_MATERIAL}}m_material_{{MATERIAL_VARIABLE}} = m_fieldInfo->hasValuePointerTable(QLatin1String("{{MATERIAL_VARIABLE}}")) ? m_fieldInfo->valuePointerTable(QLatin1String("{{MATERIAL_VARIABLE}}")) : NULL;
+        {{/VARIABLE_MATERIAL}}
+    }
+
     {{#SPECIAL_FUNCTION_SOURCE}}
     QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}> {{SPECIAL_FUNCTION_NAME}};{{/SPECIAL_FUNCTION_SOURCE}}
 };
@@ -108,40 +115,44 @@ private:
 class {{CLASS}}VolumetricIntegralCalculator : public Hermes::Hermes2D::PostProcessing::VolumetricIntegralCalculator<double>
 {
 public:
-    {{CLASS}}VolumetricIntegralCalculator(const FieldInfo *fieldInfo, Hermes::Hermes2D::MeshFunctionSharedPtr<double> source_function, int number_of_integrals)
-        : Hermes::Hermes2D::PostProcessing::VolumetricIntegralCalculator<double>(source_function, number_of_integrals), m_fieldInfo(fieldInfo)
+    {{CLASS}}VolumetricIntegralCalculator(const FieldInfo *fieldInfo, Hermes::Hermes2D::MeshFunctionSharedPtr<double> source_function, const QList<int> &labels)
+        : Hermes::Hermes2D::PostProcessing::VolumetricIntegralCalculator<double>(source_function, {{INTEGRAL_COUNT}} * labels.count()), m_fieldInfo(fieldInfo)
     {
+        initMarkerTables(labels);
         {{#SPECIAL_FUNCTION_SOURCE}}
         {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));{{/SPECIAL_FUNCTION_SOURCE}}
     }
 
-    {{CLASS}}VolumetricIntegralCalculator(const FieldInfo *fieldInfo, Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > source_functions, int number_of_integrals)
-        : Hermes::Hermes2D::PostProcessing::VolumetricIntegralCalculator<double>(source_functions, number_of_integrals), m_fieldInfo(fieldInfo)
+    {{CLASS}}VolumetricIntegralCalculator(const FieldInfo *fieldInfo, Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > source_functions, const QList<int> &labels)
+        : Hermes::Hermes2D::PostProcessing::VolumetricIntegralCalculator<double>(source_functions, {{INTEGRAL_COUNT}} * labels.count()), m_fieldInfo(fieldInfo)
     {
+        initMarkerTables(labels);
         {{#SPECIAL_FUNCTION_SOURCE}}
         {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));{{/SPECIAL_FUNCTION_SOURCE}}
     }
 
     virtual void integral(int n, double* wt, Hermes::Hermes2D::Func<double> **fns, Hermes::Hermes2D::Geom<double> *e, double* result)
     {
-        SceneLabel *label = Agros2D::scene()->labels->at(atoi(m_fieldInfo->initialMesh()->get_element_markers_conversion().get_user_marker(e->elem_marker).marker.c_str()));
-        SceneMaterial *material = label->marker(m_fieldInfo);
-
         double *x = e->x;
         double *y = e->y;
         int elementMarker = e->elem_marker;
 
-        {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = material->valueNakedPtr(QLatin1String("{{MATERIAL_VARIABLE}}"));
+        int labelIndex = m_fieldInfo->hermesMarkerToAgrosLabel(e->elem_marker);
+        {{#VARIABLE_MATERIAL}}const Value *material_{{MATERIAL_VARIABLE}} = m_material_{{MATERIAL_VARIABLE}} ? m_material_{{MATERIAL_VARIABLE}}[labelIndex] : NULL;
         {{/VARIABLE_MATERIAL}}
+        // partial sums of the label
+        double *labelResult = result + m_labelSlot[labelIndex] * {{INTEGRAL_COUNT}};
+
         // {{#SPECIAL_FUNCTION_SOURCE}}
         // QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}> {{SPECIAL_FUNCTION_NAME}};
         // if (isInCalculation_{{SPECIAL_FUNCTION_ID}})
         //     {{SPECIAL_FUNCTION_NAME}} = QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}>(new {{SPECIAL_EXT_FUNCTION_FULL_NAME}}(m_fieldInfo, 0));
         // {{/SPECIAL_FUNCTION_SOURCE}}
 
-        double **value = new double*[source_functions.size()];
-        double **dudx = new double*[source_functions.size()];
-        double **dudy = new double*[source_functions.size()];
+        // scratch on the stack, no allocation per element
+        QVarLengthArray<double *, 8> value(source_functions.size());
+        QVarLengthArray<double *, 8> dudx(source_functions.size());
+        QVarLengthArray<double *, 8> dudy(source_functions.size());
 
         for (int i = 0; i < source_functions.size(); i++)
         {
@@ -155,27 +166,47 @@ public:
         if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
         {
             for (int i = 0; i < n; i++)
-                result[{{POSITION}}] += wt[i] * ({{EXPRESSION}});
+                labelResult[{{POSITION}}] += wt[i] * ({{EXPRESSION}});
         }
         {{/VARIABLE_SOURCE}}
-
-        delete [] value;
-        delete [] dudx;
-        delete [] dudy;
     }
 
     virtual void order(Hermes::Hermes2D::Func<Hermes::Ord> **fns, Hermes::Ord* result)
     {
         {{#VARIABLE_SOURCE}}
         if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
-            result[{{POSITION}}] = Hermes::Ord(20);
+            result[{{POSITION}}] = {{EXPRESSION_ORDER}};
         {{/VARIABLE_SOURCE}}
+
+        // the order does not depend on the label
+        for (int slot = 1; slot < m_slotsCount; slot++)
+            for (int i = 0; i < {{INTEGRAL_COUNT}}; i++)
+                result[slot * {{INTEGRAL_COUNT}} + i] = result[i];
     }
 
 private:
     // field info
     const FieldInfo *m_fieldInfo;
 
+    // material values of the labels (tables of the field, indexed by the label)
+    {{#VARIABLE_MATERIAL}}const Value **m_material_{{MATERIAL_VARIABLE}};
+    {{/VARIABLE_MATERIAL}}
+
+    // integrals of every integrated label are stored separately (label -> slot, -1 if not integrated)
+    QVector<int> m_labelSlot;
+    int m_slotsCount;
+
+    void initMarkerTables(const QList<int> &labels)
+    {
+        m_labelSlot.fill(-1, Agros2D::scene()->labels->count());
+        m_slotsCount = labels.count();
+        for (int i = 0; i < labels.count(); i++)
+            m_labelSlot[labels[i]] = i;
+
+        {{#VARIABLE_MATERIAL}}m_material_{{MATERIAL_VARIABLE}} = m_fieldInfo->hasValuePointerTable(QLatin1String("{{MATERIAL_VARIABLE}}")) ? m_fieldInfo->valuePointerTable(QLatin1String("{{MATERIAL_VARIABLE}}")) : NULL;
+        {{/VARIABLE_MATERIAL}}
+    }
+
     {{#SPECIAL_FUNCTION_SOURCE}}
     QSharedPointer<{{SPECIAL_EXT_FUNCTION_FULL_NAME}}> {{SPECIAL_FUNCTION_NAME}};{{/SPECIAL_FUNCTION_SOURCE}}
 };
@@ -186,10 +217,33 @@ private:
     calculate();
 }
 
+{{CLASS}}VolumeIntegral::{{CLASS}}VolumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                                                 const QList<QList<int> > &regions)
+    : IntegralValue(fieldInfo, timeStep, adaptivityStep, solutionType)
+{
+    calculate(regions);
+}
+
 void {{CLASS}}VolumeIntegral::calculate()
 {
     m_values.clear();
 
+    // selected labels
+    QList<int> labels;
+    for (int i = 0; i < Agros2D::scene()->labels->count(); i++)
+        if (Agros2D::scene()->labels->at(i)->isSelected())
+            labels.append(i);
+
+    calculate(QList<QList<int> >() << labels);
+    m_values = m_regionValues.first();
+}
+
+void {{CLASS}}VolumeIntegral::calculate(const QList<QList<int> > &regions)
+{
+    m_regionValues.clear();
+    for (int i = 0; i < regions.size(); i++)
+        m_regionValues.append(QMap<QString, double>());
+
     FieldSolutionID fsid(m_fieldInfo, m_timeStep, m_adaptivityStep, m_solutionType);
     MultiArray<double> ma = Agros2D::solutionStore()->multiArray(fsid);
 
@@ -202,56 +256,89 @@ void {{CLASS}}VolumeIntegral::calculate()
             Module::updateTimeFunctions(timeLevels[m_timeStep]);
         }
 
+        int labelsCount = Agros2D::scene()->labels->count();
+
+        // labels of all regions are integrated in one pass
+        QSet<int> labelsSet;
+        foreach (QList<int> region, regions)
+            foreach (int label, region)
+                labelsSet.insert(label);
+
+        QList<int> labels = labelsSet.toList();
+        qSort(labels);
+
         Hermes::vector<std::string> markers;
-        for (int i = 0; i < Agros2D::scene()->labels->count(); i++)
-        {
-            SceneLabel *label = Agros2D::scene()->labels->at(i);
-            if (label->isSelected())
-                markers.push_back(QString::number(i).toStdString());
-        }
+        foreach (int label, labels)
+            markers.push_back(QString::number(label).toStdString());
 
         if (markers.size() > 0)
         {
-            {{CLASS}}VolumetricIntegralCalculator calc(m_fieldInfo, ma.solutions(), {{INTEGRAL_COUNT}});
+            // only the requested labels have their partial sums
+            {{CLASS}}VolumetricIntegralCalculator calc(m_fieldInfo, ma.solutions(), labels);
             double *values = calc.calculate(markers);
 
-            {{#VARIABLE_SOURCE}}
-            if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
-                m_values[QLatin1String("{{VARIABLE}}")] = values[{{POSITION}}];
-            {{/VARIABLE_SOURCE}}
+            // slots of the labels
+            QVector<int> labelSlot(labelsCount, -1);
+            for (int j = 0; j < labels.count(); j++)
+                labelSlot[labels[j]] = j;
+
+            // sum of the partial integrals of the labels
+            for (int i = 0; i < regions.size(); i++)
+            {
+                if (regions[i].isEmpty())
+                    continue;
+
+                QSet<int> regionLabels = regions[i].toSet();
+
+                {{#VARIABLE_SOURCE}}
+                if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
+                {
+                    double value = 0.0;
+                    foreach (int label, regionLabels)
+                        value += values[labelSlot[label] * {{INTEGRAL_COUNT}} + {{POSITION}}];
+                    m_regionValues[i][QLatin1String("{{VARIABLE}}")] = value;
+                }
+                {{/VARIABLE_SOURCE}}
+            }
 
             ::free(values);
         }
 
+        // eggshell is constructed around the region, one pass per region
         if ({{INTEGRAL_COUNT_EGGSHELL}} > 0)
         {
-            Hermes::vector<std::string> markersInverted;
-            for (int i = 0; i < Agros2D::scene()->labels->count(); i++)
-            {
-                SceneLabel *label = Agros2D::scene()->labels->at(i);
-                if (!label->isSelected())
-                    markersInverted.push_back(QString::number(i).toStdString());
-            }
-
-            if (markers.size() > 0 && markersInverted.size() > 0)
+            for (int i = 0; i < regions.size(); i++)
             {
-                Hermes::Hermes2D::MeshSharedPtr eggShellMesh = Hermes::Hermes2D::EggShell::get_egg_shell(ma.solutions().at(0)->get_mesh(), markers, 3);
-                Hermes::Hermes2D::MeshFunctionSharedPtr<double> eggShell(new Hermes::Hermes2D::ExactSolutionEggShell(eggShellMesh, 3));
-
-                Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > slns;
-                for (int i = 0; i < ma.solutions().size(); i++)
-                    slns.push_back(ma.solutions().at(i));
-                slns.push_back(eggShell);
-
-                {{CLASS}}VolumetricIntegralEggShellCalculator calcEggShell(m_fieldInfo, slns, {{INTEGRAL_COUNT_EGGSHELL}});
-                double *valuesEggShell = calcEggShell.calculate(markersInverted);
-
-                {{#VARIABLE_SOURCE_EGGSHELL}}
-                if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
-                    m_values[QLatin1String("{{VARIABLE}}")] = valuesEggShell[{{POSITION}}];
-                {{/VARIABLE_SOURCE_EGGSHELL}}
-
-                ::free(valuesEggShell);
+                Hermes::vector<std::string> markers;
+                Hermes::vector<std::string> markersInverted;
+                for (int j = 0; j < labelsCount; j++)
+                {
+                    if (regions[i].contains(j))
+                        markers.push_back(QString::number(j).toStdString());
+                    else
+                        markersInverted.push_back(QString::number(j).toStdString());
+                }
+
+                if (markers.size() > 0 && markersInverted.size() > 0)
+                {
+                    Hermes::Hermes2D::MeshSharedPtr eggShellMesh = Hermes::Hermes2D::EggShell::get_egg_shell(ma.solutions().at(0)->get_mesh(), markers, 3);
+                    Hermes::Hermes2D::MeshFunctionSharedPtr<double> eggShell(new Hermes::Hermes2D::ExactSolutionEggShell(eggShellMesh, 3));
+
+                    Hermes::vector<Hermes::Hermes2D::MeshFunctionSharedPtr<double> > slns;
+                    for (int j = 0; j < ma.solutions().size(); j++)
+                        slns.push_back(ma.solutions().at(j));
+                    slns.push_back(eggShell);
+
+                    {{CLASS}}VolumetricIntegralEggShellCalculator calcEggShell(m_fieldInfo, slns, {{INTEGRAL_COUNT_EGGSHELL}});
+                    double *valuesEggShell = calcEggShell.calculate(markersInverted);
+
+                    {{#VARIABLE_SOURCE_EGGSHELL}}
+                    if ((m_fieldInfo->analysisType() == {{ANALYSIS_TYPE}}) && (Agros2D::problem()->config()->coordinateType() == {{COORDINATE_TYPE}}))
+                        m_regionValues[i][QLatin1String("{{VARIABLE}}")] = valuesEggShell[{{POSITION}}];
+                    {{/VARIABLE_SOURCE_EGGSHELL}}
+
+                    ::free(valuesEggShell);
+                }
             }
         }
     }
@@ -32,9 +32,14 @@ class FieldInfo;
 class {{CLASS}}VolumeIntegral : public IntegralValue
 {
 public:
+    // integrals over the selected labels
     {{CLASS}}VolumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType);
+    // integrals over the regions (sets of labels)
+    {{CLASS}}VolumeIntegral(const FieldInfo *fieldInfo, int timeStep, int adaptivityStep, SolutionMode solutionType,
+                            const QList<QList<int> > &regions);
 
     void calculate();
+    void calculate(const QList<QList<int> > &regions);
 };
 
 #endif // {{CLASS}}_VOLUMEINTEGRAL_H
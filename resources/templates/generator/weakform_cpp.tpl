@@ -46,6 +46,15 @@ void {{EXT_FUNCTION_NAME}}::value (int n, Hermes::Hermes2D::Func<double>** u_ext
     int labelIndex = m_fieldInfo->hermesMarkerToAgrosLabel(e->elem_marker);
     const Value* value = {{QUANTITY_SHORTNAME}}[labelIndex];
 
+    // material parameter is evaluated once per element, all forms of the element share ext values
+    if (value->isUniform())
+    {
+        double number = value->{{VALUE_METHOD}}(0.0);
+        for (int i = 0; i < n; i++)
+            result->val[i] = number;
+        return;
+    }
+
     for(int i = 0; i < n; i++)
     {
         result->val[i] = value->{{VALUE_METHOD}}({{DEPENDENCE}});
@@ -151,6 +160,10 @@ template <typename Scalar>
 Scalar {{FUNCTION_NAME}}<Scalar>::value(int n, double *wt, Hermes::Hermes2D::Func<Scalar> *u_ext[], Hermes::Hermes2D::Func<double> *u, Hermes::Hermes2D::Func<double> *v,
                                            Hermes::Hermes2D::Geom<double> *e, Hermes::Hermes2D::Func<Scalar> **ext) const
 {
+    {{#POINT_VALUE}}
+    QVarLengthArray<double, 64> {{VARIABLE_SHORT}}_values(n);
+    {{VARIABLE_SHORT}}->{{POINT_VALUE_METHOD}}n, e->x, e->y, {{VARIABLE_SHORT}}_values.data());{{/POINT_VALUE}}
+
     Scalar result = 0;
     for (int i = 0; i < n; i++)
     {
@@ -163,6 +176,12 @@ template <typename Scalar>
 Hermes::Ord {{FUNCTION_NAME}}<Scalar>::ord(int n, double *wt, Hermes::Hermes2D::Func<Hermes::Ord> *u_ext[], Hermes::Hermes2D::Func<Hermes::Ord> *u, Hermes::Hermes2D::Func<Hermes::Ord> *v,
                                               Hermes::Hermes2D::Geom<Hermes::Ord> *e, Hermes::Hermes2D::Func<Hermes::Ord> **ext) const
 {
+    {{#POINT_VALUE}}
+    // coordinate dependent value is approximated as linear
+    QVarLengthArray<Hermes::Ord, 64> {{VARIABLE_SHORT}}_values(n);
+    for (int i = 0; i < n; i++)
+        {{VARIABLE_SHORT}}_values[i] = Hermes::Ord(1);{{/POINT_VALUE}}
+
     Hermes::Ord result(0);    
     for (int i = 0; i < n; i++)
     {
@@ -203,6 +222,10 @@ template <typename Scalar>
 Scalar {{FUNCTION_NAME}}<Scalar>::value(int n, double *wt, Hermes::Hermes2D::Func<Scalar> *u_ext[], Hermes::Hermes2D::Func<double> *v,
                                            Hermes::Hermes2D::Geom<double> *e, Hermes::Hermes2D::Func<Scalar> **ext) const
 {
+    {{#POINT_VALUE}}
+    QVarLengthArray<double, 64> {{VARIABLE_SHORT}}_values(n);
+    {{VARIABLE_SHORT}}->{{POINT_VALUE_METHOD}}n, e->x, e->y, {{VARIABLE_SHORT}}_values.data());{{/POINT_VALUE}}
+
     Scalar result = 0;
     for (int i = 0; i < n; i++)
     {
@@ -215,6 +238,12 @@ template <typename Scalar>
 Hermes::Ord {{FUNCTION_NAME}}<Scalar>::ord(int n, double *wt, Hermes::Hermes2D::Func<Hermes::Ord> *u_ext[], Hermes::Hermes2D::Func<Hermes::Ord> *v,
                                               Hermes::Hermes2D::Geom<Hermes::Ord> *e, Hermes::Hermes2D::Func<Hermes::Ord> **ext) const
 {
+    {{#POINT_VALUE}}
+    // coordinate dependent value is approximated as linear
+    QVarLengthArray<Hermes::Ord, 64> {{VARIABLE_SHORT}}_values(n);
+    for (int i = 0; i < n; i++)
+        {{VARIABLE_SHORT}}_values[i] = Hermes::Ord(1);{{/POINT_VALUE}}
+
     Hermes::Ord result(0);    
     for (int i = 0; i < n; i++)
     {
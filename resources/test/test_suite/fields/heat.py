@@ -60,6 +60,11 @@ class TestHeatPlanar(Agros2DTestCase):
         self.value_test("Heat flux - x", point["Fx"], -265.512857)
         self.value_test("Heat flux - y", point["Fy"], -536.94516)
 
+        # point values in more points in one pass
+        points = self.heat.local_values_points([[0.079734, 0.120078], [0.062926, 0.038129]])
+        self.value_test("Temperature (points)", points[0]["T"], 2.76619)
+        self.value_test("Temperature (points)", points[1]["T"], self.heat.local_values(0.062926, 0.038129)["T"])
+
         # volume integral
         volume = self.heat.volume_integrals([0])
         self.value_test("Temperature", volume["T"], 0.00335)
@@ -68,6 +73,15 @@ class TestHeatPlanar(Agros2DTestCase):
         surface = self.heat.surface_integrals([0, 6, 7])
         self.value_test("Heat flux", surface["f"], -85.821798)
 
+        # integrals on more regions in one pass (reference values do not depend on the other regions)
+        volumes = self.heat.volume_integrals_regions([[1], [0], [0, 1]])
+        self.value_test("Temperature (regions)", volumes[1]["T"], 0.00335)
+        self.value_test("Temperature (regions)", volumes[2]["T"], volumes[0]["T"] + volumes[1]["T"])
+
+        surfaces = self.heat.surface_integrals_regions([[2, 3], [0, 6, 7], [0], [6, 7]])
+        self.value_test("Heat flux (regions)", surfaces[1]["f"], -85.821798)
+        self.value_test("Heat flux (regions)", surfaces[2]["f"] + surfaces[3]["f"], -85.821798)
+
 class TestHeatAxisymmetric(Agros2DTestCase):
     def setUp(self):  
         # model
@@ -334,6 +348,10 @@ class TestHeatTransientAxisymmetric(Agros2DTestCase):
         
         agros2d.view.zoom_best_fit()
         
+        # probes recorded during the solve
+        self.point_probe = self.heat.add_local_values_probe(0.00503, 0.134283)
+        self.volume_probe = self.heat.add_volume_integrals_probe([3])
+        
         # solve problem
         problem.solve()
 
@@ -353,6 +371,13 @@ class TestHeatTransientAxisymmetric(Agros2DTestCase):
         surface = self.heat.surface_integrals([26])
         #self.value_test("Heat flux", surface["f"], 0.032866, error = 0.05)  #todo: jaky heat flux v comsolu pouzit?
         
+        # probes
+        point_series = self.heat.probe_series(self.point_probe)
+        self.value_test("Temperature (probe)", point_series["T"][-1], point["T"])
+        self.value_test("Temperature (probe, initial condition)", point_series["T"][0], 20)
+        volume_series = self.heat.probe_series(self.volume_probe)
+        self.value_test("Temperature (probe)", volume_series["T"][-1], volume["T"])
+        
 if __name__ == '__main__':        
     import unittest as ut
 
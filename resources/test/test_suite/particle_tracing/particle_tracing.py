@@ -82,6 +82,16 @@ class TestParticleTracingPlanar(Agros2DTestCase):
         
         self.value_test("Particle position", x[-1], 0.080043)
         self.value_test("Particle position", y[-1], 0.015374)
+        
+        # more particles computed concurrently, first particle starts in the initial position
+        tracing.number_of_particles = 3
+        tracing.particles_dispersion = 0.001
+        tracing.solve()
+        x, y, z = tracing.positions(0)
+        
+        self.value_test("Particle position (more particles)", x[-1], 0.080043)
+        self.value_test("Particle position (more particles)", y[-1], 0.015374)
+        self.assertTrue(len(tracing.times(2)) > 1)
 
 class TestParticleTracingAxisymmetric(Agros2DTestCase):
     def setUp(self): 
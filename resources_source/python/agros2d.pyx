@@ -113,12 +113,16 @@ cdef extern from "../../agros2d-library/pythonlab/pythonengine_agros.h":
     # memory
     int appTime()
     void memoryUsage(vector[int] &time, vector[int] &usage)
+    void cacheStatistics(map[string, double] &info)
 
     # PyOptions
     cdef cppclass PyOptions:
         int getNumberOfThreads()
         void setNumberOfThreads(int threads) except +
 
+        int getNumberOfParallelBlocks()
+        void setNumberOfParallelBlocks(int blocks) except +
+
         int getCacheSize()
         void setCacheSize(int size) except +
 
@@ -153,6 +157,19 @@ def memory_usage():
 
     return time, usage
 
+def cache_statistics():
+    """Return dictionary with solution cache statistics (hits, misses, evictions, count and size in MB)."""
+    info = dict()
+    cdef map[string, double] info_map
+
+    cacheStatistics(info_map)
+    it = info_map.begin()
+    while it != info_map.end():
+        info[deref(it).first.c_str()] = deref(it).second
+        incr(it)
+
+    return info
+
 cdef class __Options__:
     cdef PyOptions *thisptr
 
@@ -167,6 +184,12 @@ cdef class __Options__:
         def __set__(self, threads):
             self.thisptr.setNumberOfThreads(threads)
 
+    property number_of_parallel_blocks:
+        def __get__(self):
+            return self.thisptr.getNumberOfParallelBlocks()
+        def __set__(self, blocks):
+            self.thisptr.setNumberOfParallelBlocks(blocks)
+
     property cache_size:
         def __get__(self):
             return self.thisptr.getCacheSize()
@@ -75,10 +75,22 @@ cdef extern from "../../agros2d-library/pythonlab/pyfield.h":
 
         void localValues(double x, double y, int timeStep, int adaptivityStep,
                          string &solutionType, map[string, double] &results) except +
+        void localValues(vector[double] &x, vector[double] &y, int timeStep, int adaptivityStep,
+                         string &solutionType, vector[map[string, double]] &results) except +
         void surfaceIntegrals(vector[int], int timeStep, int adaptivityStep,
                               string &solutionType, map[string, double] &results) except +
         void volumeIntegrals(vector[int], int timeStep, int adaptivityStep,
                              string &solutionType, map[string, double] &results) except +
+        void surfaceIntegrals(vector[vector[int]], int timeStep, int adaptivityStep,
+                              string &solutionType, vector[map[string, double]] &results) except +
+        void volumeIntegrals(vector[vector[int]], int timeStep, int adaptivityStep,
+                             string &solutionType, vector[map[string, double]] &results) except +
+
+        int addLocalValuesProbe(double x, double y) except +
+        int addSurfaceIntegralsProbe(vector[int] &edges) except +
+        int addVolumeIntegralsProbe(vector[int] &labels) except +
+        void probeSeries(int id, vector[double] &times, map[string, vector[double]] &results) except +
+        void removeProbes() except +
 
         void initialMeshInfo(map[string , int] &info) except +
         void solutionMeshInfo(int timeStep, int adaptivityStep, string &solutionType, map[string , int] &info) except +
@@ -526,6 +538,42 @@ cdef class __Field__:
 
         return out
 
+    # local values in many points
+    def local_values_points(self, points, time_step = None, adaptivity_step = None, solution_type = "normal"):
+        """Compute local values in points in one pass and return list of dictionaries with results.
+
+        local_values_points(points, time_step = None, adaptivity_step = None, solution_type = "normal")
+
+        Keyword arguments:
+        points -- list of points [x, y] (dictionary is empty for points outside of the mesh)
+        time_step -- time step (default is None - use last time step)
+        adaptivity_step -- adaptivity step (default is None - use adaptive step)
+        solution_type -- solution type (default is "normal")
+        """
+        cdef vector[double] x_vector
+        cdef vector[double] y_vector
+        for point in points:
+            x_vector.push_back(point[0])
+            y_vector.push_back(point[1])
+
+        cdef vector[map[string, double]] results
+
+        self.thisptr.localValues(x_vector, y_vector,
+                                 int(-1 if time_step is None else time_step),
+                                 int(-1 if adaptivity_step is None else adaptivity_step),
+                                 string(solution_type), results)
+
+        out = list()
+        for i in range(results.size()):
+            values = dict()
+            it = results[i].begin()
+            while it != results[i].end():
+                values[deref(it).first.c_str()] = deref(it).second
+                incr(it)
+            out.append(values)
+
+        return out
+
     # surface integrals
     def surface_integrals(self, edges = [], time_step = None, adaptivity_step = None, solution_type = "normal"):
         """Compute surface integrals on edges and return dictionary with results.
@@ -586,6 +634,148 @@ cdef class __Field__:
 
         return out
 
+    # surface integrals on many sets of edges
+    def surface_integrals_regions(self, regions, time_step = None, adaptivity_step = None, solution_type = "normal"):
+        """Compute surface integrals on sets of edges in one pass and return list of dictionaries with results.
+
+        surface_integrals_regions(regions, time_step = None, adaptivity_step = None, solution_type = "normal")
+
+        Keyword arguments:
+        regions -- list of lists of edges
+        time_step -- time step (default is None - use last time step)
+        adaptivity_step -- adaptivity step (default is None - use adaptive step)
+        solution_type -- solution type (default is "normal")
+        """
+        cdef vector[vector[int]] regions_vector
+        cdef vector[int] edges_vector
+        for region in regions:
+            edges_vector.clear()
+            for i in region:
+                edges_vector.push_back(i)
+            regions_vector.push_back(edges_vector)
+
+        cdef vector[map[string, double]] results
+
+        self.thisptr.surfaceIntegrals(regions_vector,
+                                      int(-1 if time_step is None else time_step),
+                                      int(-1 if adaptivity_step is None else adaptivity_step),
+                                      string(solution_type), results)
+
+        out = list()
+        for i in range(results.size()):
+            values = dict()
+            it = results[i].begin()
+            while it != results[i].end():
+                values[deref(it).first.c_str()] = deref(it).second
+                incr(it)
+            out.append(values)
+
+        return out
+
+    # volume integrals on many sets of labels
+    def volume_integrals_regions(self, regions, time_step = None, adaptivity_step = None, solution_type = "normal"):
+        """Compute volume integrals on sets of labels in one pass and return list of dictionaries with results.
+
+        volume_integrals_regions(regions, time_step = None, adaptivity_step = None, solution_type = "normal")
+
+        Keyword arguments:
+        regions -- list of lists of labels
+        time_step -- time step (default is None - use last time step)
+        adaptivity_step -- adaptivity step (default is None - use adaptive step)
+        solution_type -- solution type (default is "normal")
+        """
+        cdef vector[vector[int]] regions_vector
+        cdef vector[int] labels_vector
+        for region in regions:
+            labels_vector.clear()
+            for i in region:
+                labels_vector.push_back(i)
+            regions_vector.push_back(labels_vector)
+
+        cdef vector[map[string, double]] results
+
+        self.thisptr.volumeIntegrals(regions_vector,
+                                     int(-1 if time_step is None else time_step),
+                                     int(-1 if adaptivity_step is None else adaptivity_step),
+                                     string(solution_type), results)
+
+        out = list()
+        for i in range(results.size()):
+            values = dict()
+            it = results[i].begin()
+            while it != results[i].end():
+                values[deref(it).first.c_str()] = deref(it).second
+                incr(it)
+            out.append(values)
+
+        return out
+
+    # probes
+    def add_local_values_probe(self, x, y):
+        """Register point, local values are recorded after each solved time step. Return id of the probe.
+
+        add_local_values_probe(x, y)
+
+        Keyword arguments:
+        x -- x or r coordinate of point
+        y -- y or z coordinate of point
+        """
+        return self.thisptr.addLocalValuesProbe(x, y)
+
+    def add_surface_integrals_probe(self, edges):
+        """Register edges, surface integrals are recorded after each solved time step. Return id of the probe.
+
+        add_surface_integrals_probe(edges)
+
+        Keyword arguments:
+        edges -- list of edges
+        """
+        cdef vector[int] edges_vector
+        for i in edges:
+            edges_vector.push_back(i)
+
+        return self.thisptr.addSurfaceIntegralsProbe(edges_vector)
+
+    def add_volume_integrals_probe(self, labels):
+        """Register labels, volume integrals are recorded after each solved time step. Return id of the probe.
+
+        add_volume_integrals_probe(labels)
+
+        Keyword arguments:
+        labels -- list of labels
+        """
+        cdef vector[int] labels_vector
+        for i in labels:
+            labels_vector.push_back(i)
+
+        return self.thisptr.addVolumeIntegralsProbe(labels_vector)
+
+    def probe_series(self, id):
+        """Return dictionary with recorded time levels ("t") and lists of values.
+
+        probe_series(id)
+
+        Keyword arguments:
+        id -- id of the probe (does not change when other probes are removed)
+        """
+        cdef vector[double] times
+        cdef map[string, vector[double]] results
+
+        self.thisptr.probeSeries(id, times, results)
+
+        out = dict()
+        out["t"] = [times[i] for i in range(times.size())]
+        it = results.begin()
+        while it != results.end():
+            out[deref(it).first.c_str()] = [deref(it).second[i] for i in range(deref(it).second.size())]
+            incr(it)
+
+        return out
+
+    def remove_probes(self):
+        """Remove all probes of the field."""
+        self.thisptr.removeProbes()
+
     # mesh info
     def initial_mesh_info(self):
         """Return dictionary with initial mesh info."""
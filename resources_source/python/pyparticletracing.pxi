@@ -60,10 +60,10 @@ cdef extern from "../../agros2d-library/pythonlab/pyparticletracing.h":
 
         void solve() except +
 
-        int length()
-        void positions(vector[double] &x, vector[double] &y, vector[double] &z)
-        void velocities(vector[double] &x, vector[double] &y, vector[double] &z)
-        void times(vector[double] &times)
+        int length(int particle) except +
+        void positions(vector[double] &x, vector[double] &y, vector[double] &z, int particle) except +
+        void velocities(vector[double] &x, vector[double] &y, vector[double] &z, int particle) except +
+        void times(vector[double] &times, int particle) except +
 
 cdef vector[double] list_to_double_vector(list):
     cdef vector[double] vector
@@ -84,23 +84,23 @@ cdef class __ParticleTracing__:
         self.thisptr.solve()
 
     """
-    def length(self):
-        return self.thisptr.length()
+    def length(self, particle = 0):
+        return self.thisptr.length(particle)
     """
 
-    def positions(self):
+    def positions(self, particle = 0):
         cdef vector[double] x, y, z
-        self.thisptr.positions(x, y, z)
+        self.thisptr.positions(x, y, z, particle)
         return double_vector_to_list(x), double_vector_to_list(y), double_vector_to_list(z)
 
-    def velocities(self):
+    def velocities(self, particle = 0):
         cdef vector[double] vx, vy, vz
-        self.thisptr.velocities(vx, vy, vz)
+        self.thisptr.velocities(vx, vy, vz, particle)
         return double_vector_to_list(vx), double_vector_to_list(vy), double_vector_to_list(vz)
 
-    def times(self):
+    def times(self, particle = 0):
         cdef vector[double] time
-        self.thisptr.times(time)
+        self.thisptr.times(time, particle)
         return double_vector_to_list(time)
 
     property number_of_particles:
@@ -40,6 +40,7 @@
 #include <cmath>
 #include <limits>
 #include <vector>
+#include <exception>
 
 #include <locale.h>
 #include <stdlib.h>